@@ -111,6 +111,7 @@ python $EMCC $CHATTY \
 	$VEROVIO_ROOT/src/clef.cpp \
 	$VEROVIO_ROOT/src/custos.cpp \
 	$VEROVIO_ROOT/src/devicecontext.cpp \
+	$VEROVIO_ROOT/src/displaylistdevicecontext.cpp \
 	$VEROVIO_ROOT/src/dir.cpp \
 	$VEROVIO_ROOT/src/doc.cpp \
 	$VEROVIO_ROOT/src/dot.cpp \
@@ -137,9 +138,11 @@ python $EMCC $CHATTY \
 	$VEROVIO_ROOT/src/note.cpp \
 	$VEROVIO_ROOT/src/object.cpp \
 	$VEROVIO_ROOT/src/page.cpp \
+	$VEROVIO_ROOT/src/pdfdevicecontext.cpp \
 	$VEROVIO_ROOT/src/pitchinterface.cpp \
 	$VEROVIO_ROOT/src/positioninterface.cpp \
 	$VEROVIO_ROOT/src/proport.cpp \
+	$VEROVIO_ROOT/src/rasterdevicecontext.cpp \
 	$VEROVIO_ROOT/src/rest.cpp \
 	$VEROVIO_ROOT/src/rpt.cpp \
 	$VEROVIO_ROOT/src/scoredef.cpp \
@@ -160,6 +163,7 @@ python $EMCC $CHATTY \
 	$VEROVIO_ROOT/src/timestamp.cpp \
 	$VEROVIO_ROOT/src/toolkit.cpp \
 	$VEROVIO_ROOT/src/tuplet.cpp \
+	$VEROVIO_ROOT/src/unzip.cpp \
 	$VEROVIO_ROOT/src/verse.cpp \
 	$VEROVIO_ROOT/src/view.cpp \
 	$VEROVIO_ROOT/src/view_beam.cpp \
@@ -200,10 +204,23 @@ python $EMCC $CHATTY \
 		'_vrvToolkit_redoLayout',\
 		'_vrvToolkit_renderData',\
 		'_vrvToolkit_renderPage',\
+		'_vrvToolkit_renderPageToCommands',\
+		'_vrvToolkit_getCommandsLength',\
+		'_vrvToolkit_renderGlyphSprite',\
 		'_vrvToolkit_renderToMidi',\
+		'_vrvToolkit_selectAppReadings',\
 		'_vrvToolkit_setOptions',\
 		'_vrvToolkit_edit',\
-		'_vrvToolkit_getElementAttr']" \
+		'_vrvToolkit_getElementAttr',\
+		'_vrvToolkit_getResultData',\
+		'_vrvToolkit_getResultLength',\
+		'_vrvToolkit_freeResult',\
+		'_vrvToolkit_getLogResult',\
+		'_vrvToolkit_getMEIResult',\
+		'_vrvToolkit_renderPageResult',\
+		'_vrvToolkit_renderToMidiResult',\
+		'_vrvToolkit_getElementsAtTimeResult',\
+		'_vrvToolkit_getElementAttrResult']" \
 	-o build/verovio.js
 
 if [ $? -eq 0 ]; then 
@@ -7,6 +7,7 @@
 
 #include <assert.h>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
 #include <iostream>
 #include <sstream>
@@ -77,7 +78,8 @@ double vrvToolkit_getTimeForElement(Toolkit *tk, const char *xmlId)
 bool vrvToolkit_loadData(Toolkit *tk, const char *data)
 {
     tk->ResetLogBuffer();
-    return tk->LoadString(data);
+    // The data is a copy made for the call and can be parsed in place instead of being copied into a std::string
+    return tk->LoadBuffer(const_cast<char *>(data), strlen(data));
 }
 
 const char *vrvToolkit_getMEI(Toolkit *tk, int page_no, bool score_based)
@@ -93,6 +95,25 @@ const char *vrvToolkit_renderPage(Toolkit *tk, int page_no, const char *c_option
     return tk->GetCString();
 }
 
+const char *vrvToolkit_renderPageToCommands(Toolkit *tk, int page_no, const char *c_options)
+{
+    tk->ResetLogBuffer();
+    // the buffer is read in place and is valid until the next call
+    return &tk->RenderToCommands(page_no)[0];
+}
+
+int vrvToolkit_getCommandsLength(Toolkit *tk)
+{
+    return (int)tk->GetCommands().size();
+}
+
+const char *vrvToolkit_renderGlyphSprite(Toolkit *tk)
+{
+    tk->ResetLogBuffer();
+    tk->SetCString(tk->RenderGlyphSprite());
+    return tk->GetCString();
+}
+
 const char *vrvToolkit_renderToMidi(Toolkit *tk, const char *c_options)
 {
     tk->ResetLogBuffer();
@@ -118,6 +139,11 @@ void vrvToolkit_redoLayout(Toolkit *tk)
     tk->RedoLayout();
 }
 
+bool vrvToolkit_selectAppReadings(Toolkit *tk, const char *xmlIds)
+{
+    return tk->SelectAppReadings(xmlIds);
+}
+
 const char *vrvToolkit_renderData(Toolkit *tk, const char *data, const char *options)
 {
     tk->ResetLogBuffer();
@@ -141,4 +167,56 @@ const char *vrvToolkit_getElementAttr(Toolkit *tk, const char *xmlId)
     tk->SetCString(tk->GetElementAttr(xmlId));
     return tk->GetCString();
 }
+
+/****************************************************************
+* Methods returning a result that js reads in place with its length.
+* The string produced by the toolkit is moved without being copied
+* and has to be released with vrvToolkit_freeResult.
+****************************************************************/
+const char *vrvToolkit_getResultData(std::string *result)
+{
+    return result->c_str();
+}
+
+int vrvToolkit_getResultLength(std::string *result)
+{
+    return (int)result->size();
+}
+
+void vrvToolkit_freeResult(std::string *result)
+{
+    delete result;
+}
+
+std::string *vrvToolkit_getLogResult(Toolkit *tk)
+{
+    return new std::string(tk->GetLogString());
+}
+
+std::string *vrvToolkit_getMEIResult(Toolkit *tk, int page_no, bool score_based)
+{
+    return new std::string(tk->GetMEI(page_no, score_based));
+}
+
+std::string *vrvToolkit_renderPageResult(Toolkit *tk, int page_no, const char *c_options)
+{
+    tk->ResetLogBuffer();
+    return new std::string(tk->RenderToSvg(page_no, false));
+}
+
+std::string *vrvToolkit_renderToMidiResult(Toolkit *tk, const char *c_options)
+{
+    tk->ResetLogBuffer();
+    return new std::string(tk->RenderToMidi());
+}
+
+std::string *vrvToolkit_getElementsAtTimeResult(Toolkit *tk, int millisec)
+{
+    return new std::string(tk->GetElementsAtTime(millisec));
+}
+
+std::string *vrvToolkit_getElementAttrResult(Toolkit *tk, const char *xmlId)
+{
+    return new std::string(tk->GetElementAttr(xmlId));
+}
 }
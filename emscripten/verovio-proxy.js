@@ -33,12 +33,24 @@ verovio.vrvToolkit.loadData = Module.cwrap('vrvToolkit_loadData', 'number', ['nu
 // void redoLayout(Toolkit *ic)
 verovio.vrvToolkit.redoLayout = Module.cwrap('vrvToolkit_redoLayout', null, ['number']);
 
+// bool selectAppReadings(Toolkit *ic, const char *xmlIds)
+verovio.vrvToolkit.selectAppReadings = Module.cwrap('vrvToolkit_selectAppReadings', 'number', ['number', 'string']);
+
 // char *renderData(Toolkit *ic, const char *data, const char *options )
 verovio.vrvToolkit.renderData = Module.cwrap('vrvToolkit_renderData', 'string', ['number', 'string', 'string']);
 
 // char *renderPage(Toolkit *ic, int pageNo, const char *rendering_options )
 verovio.vrvToolkit.renderPage = Module.cwrap('vrvToolkit_renderPage', 'string', ['number', 'number', 'string']);
 
+// char *renderPageToCommands(Toolkit *ic, int pageNo, const char *rendering_options )
+verovio.vrvToolkit.renderPageToCommands = Module.cwrap('vrvToolkit_renderPageToCommands', 'number', ['number', 'number', 'string']);
+
+// int getCommandsLength(Toolkit *ic)
+verovio.vrvToolkit.getCommandsLength = Module.cwrap('vrvToolkit_getCommandsLength', 'number', ['number']);
+
+// char *renderGlyphSprite(Toolkit *ic)
+verovio.vrvToolkit.renderGlyphSprite = Module.cwrap('vrvToolkit_renderGlyphSprite', 'string', ['number']);
+
 // char *renderToMidi(Toolkit *ic, const char *rendering_options )
 verovio.vrvToolkit.renderToMidi = Module.cwrap('vrvToolkit_renderToMidi', 'string', ['number', 'string']);
 
@@ -57,6 +69,40 @@ verovio.vrvToolkit.edit = Module.cwrap('vrvToolkit_edit', 'number', ['number', '
 // char *getElementAttr(Toolkit *ic, const char *xmlId )
 verovio.vrvToolkit.getElementAttr = Module.cwrap('vrvToolkit_getElementAttr', 'string', ['number', 'string']);
 
+// char *getResultData(std::string *result)
+verovio.vrvToolkit.getResultData = Module.cwrap('vrvToolkit_getResultData', 'number', ['number']);
+
+// int getResultLength(std::string *result)
+verovio.vrvToolkit.getResultLength = Module.cwrap('vrvToolkit_getResultLength', 'number', ['number']);
+
+// void freeResult(std::string *result)
+verovio.vrvToolkit.freeResult = Module.cwrap('vrvToolkit_freeResult', null, ['number']);
+
+// std::string *getLogResult(Toolkit *ic)
+verovio.vrvToolkit.getLogResult = Module.cwrap('vrvToolkit_getLogResult', 'number', ['number']);
+
+// std::string *getMEIResult(Toolkit *ic, int pageNo, bool scoreBased)
+verovio.vrvToolkit.getMEIResult = Module.cwrap('vrvToolkit_getMEIResult', 'number', ['number', 'number', 'number']);
+
+// std::string *renderPageResult(Toolkit *ic, int pageNo, const char *rendering_options)
+verovio.vrvToolkit.renderPageResult = Module.cwrap('vrvToolkit_renderPageResult', 'number', ['number', 'number', 'string']);
+
+// std::string *renderToMidiResult(Toolkit *ic, const char *rendering_options)
+verovio.vrvToolkit.renderToMidiResult = Module.cwrap('vrvToolkit_renderToMidiResult', 'number', ['number', 'string']);
+
+// std::string *getElementsAtTimeResult(Toolkit *ic, int time)
+verovio.vrvToolkit.getElementsAtTimeResult = Module.cwrap('vrvToolkit_getElementsAtTimeResult', 'number', ['number', 'number']);
+
+// std::string *getElementAttrResult(Toolkit *ic, const char *xmlId)
+verovio.vrvToolkit.getElementAttrResult = Module.cwrap('vrvToolkit_getElementAttrResult', 'number', ['number', 'string']);
+
+// Read a result with its length and release it
+verovio.vrvToolkit.readResult = function (result) {
+	var str = Module.Pointer_stringify(verovio.vrvToolkit.getResultData(result), verovio.vrvToolkit.getResultLength(result));
+	verovio.vrvToolkit.freeResult(result);
+	return str;
+};
+
 // A pointer to the object - only one instance can be created for now
 verovio.ptr = 0;
 
@@ -80,7 +126,7 @@ verovio.toolkit.prototype.destroy = function () {
 };
 
 verovio.toolkit.prototype.getLog = function () {
-  	return verovio.vrvToolkit.getLog(this.ptr);
+	return verovio.vrvToolkit.readResult(verovio.vrvToolkit.getLogResult(this.ptr));
 };
 
 verovio.toolkit.prototype.getVersion = function () {
@@ -103,20 +149,34 @@ verovio.toolkit.prototype.redoLayout = function () {
   	verovio.vrvToolkit.redoLayout(this.ptr);
 }
 
+verovio.toolkit.prototype.selectAppReadings = function (xmlIds) {
+	return verovio.vrvToolkit.selectAppReadings(this.ptr, xmlIds);
+};
+
 verovio.toolkit.prototype.renderData = function (data, options) {
   	return verovio.vrvToolkit.renderData(this.ptr, data, options);
 };
 
 verovio.toolkit.prototype.renderPage = function (pageNo, options) {
-  	return verovio.vrvToolkit.renderPage(this.ptr, pageNo, options);
+	return verovio.vrvToolkit.readResult(verovio.vrvToolkit.renderPageResult(this.ptr, pageNo, options));
+};
+
+// Returns a DataView of the commands in the module memory - it is valid until the next call
+verovio.toolkit.prototype.renderPageToCommands = function (pageNo, options) {
+	var ptr = verovio.vrvToolkit.renderPageToCommands(this.ptr, pageNo, options);
+	return new DataView(Module.HEAPU8.buffer, ptr, verovio.vrvToolkit.getCommandsLength(this.ptr));
+};
+
+verovio.toolkit.prototype.renderGlyphSprite = function () {
+  	return verovio.vrvToolkit.renderGlyphSprite(this.ptr);
 };
 
 verovio.toolkit.prototype.renderToMidi = function (options) {
-  	return verovio.vrvToolkit.renderToMidi(this.ptr, options);
+	return verovio.vrvToolkit.readResult(verovio.vrvToolkit.renderToMidiResult(this.ptr, options));
 };
 
 verovio.toolkit.prototype.getElementsAtTime = function (millisec) {
-  	return verovio.vrvToolkit.getElementsAtTime(this.ptr, millisec);
+	return verovio.vrvToolkit.readResult(verovio.vrvToolkit.getElementsAtTimeResult(this.ptr, millisec));
 };
 
 verovio.toolkit.prototype.getTimeForElement = function (xmlId) {
@@ -124,7 +184,7 @@ verovio.toolkit.prototype.getTimeForElement = function (xmlId) {
 };
 
 verovio.toolkit.prototype.getMEI = function (pageNo, scoreBased) {
-  	return verovio.vrvToolkit.getMEI(this.ptr, pageNo, scoreBased);
+	return verovio.vrvToolkit.readResult(verovio.vrvToolkit.getMEIResult(this.ptr, pageNo, scoreBased));
 };
 
 verovio.toolkit.prototype.setOptions = function (options) {
@@ -136,7 +196,7 @@ verovio.toolkit.prototype.edit = function (editorAction) {
 };
 
 verovio.toolkit.prototype.getElementAttr = function (xmlId) {
-  	return verovio.vrvToolkit.getElementAttr(this.ptr, xmlId);
+	return verovio.vrvToolkit.readResult(verovio.vrvToolkit.getElementAttrResult(this.ptr, xmlId));
 };
 
 /***************************************************************************************************************************/
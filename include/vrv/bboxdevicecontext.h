@@ -79,7 +79,7 @@ public:
     virtual void DrawRectangle(int x, int y, int width, int height);
     virtual void DrawRotatedText(const std::string &text, int x, int y, double angle);
     virtual void DrawRoundedRectangle(int x, int y, int width, int height, double radius);
-    virtual void DrawText(const std::string &text, const std::wstring wtext = L"");
+    virtual void DrawText(const std::string &text, const std::wstring &wtext = L"");
     virtual void DrawMusicText(const std::wstring &text, int x, int y);
     virtual void DrawSpline(int n, Point points[]);
     virtual void DrawBackgroundImage(int x = 0, int y = 0){};
@@ -107,7 +107,7 @@ public:
      * @name Method for starting and ending a graphic
      */
     ///@{
-    virtual void StartGraphic(Object *object, std::string gClass, std::string gId);
+    virtual void StartGraphic(Object *object, const std::string &gClass, const std::string &gId);
     virtual void EndGraphic(Object *object, View *view);
     ///@}
 
@@ -115,7 +115,7 @@ public:
      * @name Methods for re-starting and ending a graphic for objects drawn in separate steps
      */
     ///@{
-    virtual void ResumeGraphic(Object *object, std::string gId);
+    virtual void ResumeGraphic(Object *object, const std::string &gId);
     virtual void EndResumedGraphic(Object *object, View *view);
     ///@}
 
@@ -156,7 +156,16 @@ private:
 
     void UpdateBB(int x1, int y1, int x2, int y2);
 
-    void ApproximateBezierBoundingBox(Point bezier[], Point *pos, int *width, int *height);
+    /**
+     * Calculate the exact bounding box of a cubic bezier curve.
+     * The extrema are calculated analytically from the roots of the derivative.
+     */
+    static void CalcBezierBoundingBox(Point bezier[], Point *pos, int *width, int *height);
+
+    /**
+     * Calculate the extrema of a cubic bezier curve along one axis
+     */
+    static void CalcBezierExtrema(int p0, int p1, int p2, int p3, int *min, int *max);
 };
 
 } // namespace vrv
@@ -18,6 +18,41 @@ namespace vrv {
 
 enum { PARTIAL_NONE = 0, PARTIAL_THROUGH, PARTIAL_RIGHT, PARTIAL_LEFT };
 
+//----------------------------------------------------------------------------
+// BeamParams
+//----------------------------------------------------------------------------
+
+/**
+ * Class for storing drawing parameters when calculating beams.
+ * See View::DrawBeam and View::CalcBeam
+ */
+
+class BeamParams {
+public:
+    /**
+     * @name Constructors, destructors, and other standard methods
+     */
+    ///@{
+    BeamParams(){};
+    virtual ~BeamParams(){};
+
+    // values to be set before calling CalcBeam
+    bool m_changingDur;
+    bool m_beamHasChord;
+    bool m_hasMultipleStemDir;
+    bool m_cueSize;
+    int m_shortestDur;
+    data_STEMDIRECTION m_stemDir;
+
+    // values set by CalcBeam
+    int m_beamWidth;
+    int m_beamWidthBlack;
+    int m_beamWidthWhite;
+    double m_startingY; // the initial position of the beam
+    double m_beamSlope; // the slope of the beam
+    double m_verticalBoost; // extra height to ensure the beam clears all the noteheads
+};
+
 //----------------------------------------------------------------------------
 // Beam
 //----------------------------------------------------------------------------
@@ -58,6 +93,16 @@ public:
      */
     const ArrayOfBeamElementCoords *GetElementCoords() const { return &m_beamElementCoords; };
 
+    /**
+     * @name Get and set the drawing values calculated by View::CalcBeam.
+     * They are cached for the page layout revision given when setting them (see Page::GetLayoutRevision)
+     * and include the x position of the element coordinates (which are modified when drawing the beam).
+     */
+    ///@{
+    bool GetCachedDrawingParams(int layoutRevision, BeamParams *params, int *elementCount) const;
+    void SetCachedDrawingParams(int layoutRevision, const BeamParams *params, int elementCount);
+    ///@}
+
 protected:
     /**
      * Filter the list for a specific class.
@@ -91,6 +136,16 @@ private:
      * An array of coordinates for each element
      **/
     mutable ArrayOfBeamElementCoords m_beamElementCoords;
+
+    /**
+     * The cached drawing values and the page layout revision they were calculated for (-1 if none)
+     */
+    ///@{
+    int m_cachedRevision;
+    BeamParams m_cachedParams;
+    int m_cachedElementCount;
+    std::vector<int> m_cachedCoordXs;
+    ///@}
 };
 
 //----------------------------------------------------------------------------
@@ -117,41 +172,6 @@ public:
     LayerElement *m_element;
 };
 
-//----------------------------------------------------------------------------
-// BeamParams
-//----------------------------------------------------------------------------
-
-/**
- * Class for storing drawing parameters when calculating beams.
- * See View::DrawBeam and View::CalcBeam
- */
-
-class BeamParams {
-public:
-    /**
-     * @name Constructors, destructors, and other standard methods
-     */
-    ///@{
-    BeamParams(){};
-    virtual ~BeamParams(){};
-
-    // values to be set before calling CalcBeam
-    bool m_changingDur;
-    bool m_beamHasChord;
-    bool m_hasMultipleStemDir;
-    bool m_cueSize;
-    int m_shortestDur;
-    data_STEMDIRECTION m_stemDir;
-
-    // values set by CalcBeam
-    int m_beamWidth;
-    int m_beamWidthBlack;
-    int m_beamWidthWhite;
-    double m_startingY; // the initial position of the beam
-    double m_beamSlope; // the slope of the beam
-    double m_verticalBoost; // extra height to ensure the beam clears all the noteheads
-};
-
 } // namespace vrv
 
 #endif
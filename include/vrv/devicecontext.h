@@ -100,7 +100,7 @@ public:
     virtual void DrawRectangle(int x, int y, int width, int height) = 0;
     virtual void DrawRotatedText(const std::string &text, int x, int y, double angle) = 0;
     virtual void DrawRoundedRectangle(int x, int y, int width, int height, double radius) = 0;
-    virtual void DrawText(const std::string &text, const std::wstring wtext = L"") = 0;
+    virtual void DrawText(const std::string &text, const std::wstring &wtext = L"") = 0;
     virtual void DrawMusicText(const std::wstring &text, int x, int y) = 0;
     virtual void DrawSpline(int n, Point points[]) = 0;
     virtual void DrawBackgroundImage(int x = 0, int y = 0) = 0;
@@ -147,7 +147,7 @@ public:
      * For example, the method can be used for grouping shapes in <g></g> in SVG
      */
     ///@{
-    virtual void StartGraphic(Object *object, std::string gClass, std::string gId) = 0;
+    virtual void StartGraphic(Object *object, const std::string &gClass, const std::string &gId) = 0;
     virtual void EndGraphic(Object *object, View *view) = 0;
     ///@}
 
@@ -156,7 +156,7 @@ public:
      * The methods can be used to the output together, for example for a Beam
      */
     ///@{
-    virtual void ResumeGraphic(Object *object, std::string gId) = 0;
+    virtual void ResumeGraphic(Object *object, const std::string &gId) = 0;
     virtual void EndResumedGraphic(Object *object, View *view) = 0;
     ///@}
 
@@ -165,7 +165,7 @@ public:
      * For example, in SVG, a text graphic is a <tspan> (and not a <g>)
      */
     ///@{
-    virtual void StartTextGraphic(Object *object, std::string gClass, std::string gId)
+    virtual void StartTextGraphic(Object *object, const std::string &gClass, const std::string &gId)
     {
         StartGraphic(object, gClass, gId);
     }
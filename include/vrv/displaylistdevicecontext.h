@@ -0,0 +1,243 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        displaylistdevicecontext.h
+// Author:      agent
+// Created:     19/10/2026
+// Copyright (c) Authors and others. All rights reserved.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef __VRV_DISPLAY_LIST_DC_H__
+#define __VRV_DISPLAY_LIST_DC_H__
+
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------
+
+#include "devicecontext.h"
+
+namespace vrv {
+
+//----------------------------------------------------------------------------
+// DisplayListDeviceContext
+//----------------------------------------------------------------------------
+
+/**
+ * This class records the drawing operations of a page in a binary buffer instead of drawing them.
+ * The recording can be replayed to any other device context (SVG, bounding box) without drawing the page again.
+ * The pen, the brush, the font and the deactivation of the graphic are recorded only when they change.
+ * The objects and the view of the graphics are recorded as pointers and the recording is valid only as long as the
+ * document is not modified or laid out again.
+ */
+class DisplayListDeviceContext : public DeviceContext {
+public:
+    /**
+     * @name Constructors, destructors, and other standard methods
+     */
+    ///@{
+    DisplayListDeviceContext();
+    virtual ~DisplayListDeviceContext();
+    virtual ClassId Is() const { return DISPLAY_LIST_DEVICE_CONTEXT; };
+    void Reset();
+    ///@}
+
+    /**
+     * Replay the recorded operations to a device context.
+     * The device context has to be reset by the caller and its pen, brush and font stacks are left unchanged.
+     */
+    void Replay(DeviceContext *dc) const;
+
+    /**
+     * The operation codes - each one is followed by its arguments in the buffer.
+     * They are also the ones of the exported commands and their values must not be changed.
+     */
+    enum DisplayListOp {
+        OP_SET_PEN = 0,
+        OP_SET_BRUSH,
+        OP_SET_FONT,
+        OP_SET_ACTIVATION,
+        OP_SET_BACKGROUND,
+        OP_SET_BACKGROUND_MODE,
+        OP_SET_TEXT_BACKGROUND,
+        OP_SET_LOGICAL_ORIGIN,
+        OP_COMPLEX_BEZIER_PATH,
+        OP_CIRCLE,
+        OP_ELLIPSE,
+        OP_ELLIPTIC_ARC,
+        OP_LINE,
+        OP_POLYGON,
+        OP_RECTANGLE,
+        OP_ROTATED_TEXT,
+        OP_ROUNDED_RECTANGLE,
+        OP_TEXT,
+        OP_MUSIC_TEXT,
+        OP_SPLINE,
+        OP_BACKGROUND_IMAGE,
+        OP_PLACEHOLDER,
+        OP_START_TEXT,
+        OP_END_TEXT,
+        OP_MOVE_TEXT_TO,
+        OP_START_GRAPHIC,
+        OP_END_GRAPHIC,
+        OP_RESUME_GRAPHIC,
+        OP_END_RESUMED_GRAPHIC,
+        OP_START_TEXT_GRAPHIC,
+        OP_END_TEXT_GRAPHIC,
+        OP_START_PAGE,
+        OP_END_PAGE
+    };
+
+    /**
+     * Append the recorded operations to a buffer in a form that can be read outside of the toolkit,
+     * for example by a JavaScript canvas renderer reading it in place from the WebAssembly memory.
+     * The operation codes are written as one byte followed by their arguments as in the display list, with 32-bit
+     * integers and 64-bit doubles in the native (little-endian) byte order and without padding. The differences are:
+     * - the strings are written in UTF-8 after their length in bytes, and the texts as a single string;
+     * - OP_SET_FONT is followed by the point size (0 without font), the style, the weight, and the face name;
+     * - the objects and the views of the graphics are omitted.
+     */
+    void Export(std::vector<char> &buffer) const;
+
+    /**
+     * Append the music texts recorded with the point size of their font.
+     * This is used for collecting the glyphs used in a page without replaying it.
+     */
+    void GetMusicTexts(std::vector<std::pair<std::wstring, int> > &texts) const;
+
+    /**
+     * Return true if nothing has been recorded
+     */
+    bool IsEmpty() const { return m_ops.empty(); };
+
+    /**
+     * @name Setters
+     */
+    ///@{
+    virtual void SetBackground(int colour, int style = AxSOLID);
+    virtual void SetBackgroundImage(void *image, double opacity = 1.0){};
+    virtual void SetBackgroundMode(int mode);
+    virtual void SetTextForeground(int colour);
+    virtual void SetTextBackground(int colour);
+    virtual void SetLogicalOrigin(int x, int y);
+    ///@}
+
+    /**
+     * @name Getters
+     */
+    ///@{
+    virtual Point GetLogicalOrigin();
+    ///@}
+
+    /**
+     * @name Drawing methods
+     */
+    ///@{
+    virtual void DrawComplexBezierPath(Point bezier1[4], Point bezier2[4]);
+    virtual void DrawCircle(int x, int y, int radius);
+    virtual void DrawEllipse(int x, int y, int width, int height);
+    virtual void DrawEllipticArc(int x, int y, int width, int height, double start, double end);
+    virtual void DrawLine(int x1, int y1, int x2, int y2);
+    virtual void DrawPolygon(int n, Point points[], int xoffset, int yoffset, int fill_style = AxODDEVEN_RULE);
+    virtual void DrawRectangle(int x, int y, int width, int height);
+    virtual void DrawRotatedText(const std::string &text, int x, int y, double angle);
+    virtual void DrawRoundedRectangle(int x, int y, int width, int height, double radius);
+    virtual void DrawText(const std::string &text, const std::wstring &wtext = L"");
+    virtual void DrawMusicText(const std::wstring &text, int x, int y);
+    virtual void DrawSpline(int n, Point points[]);
+    virtual void DrawBackgroundImage(int x = 0, int y = 0);
+    ///@}
+
+    /**
+     * Special method for forcing bounding boxes to be updated
+     */
+    virtual void DrawPlaceholder(int x, int y);
+
+    /**
+     * @name Method for starting and ending a text
+     */
+    ///@{
+    virtual void StartText(int x, int y, char alignement = LEFT);
+    virtual void EndText();
+
+    /**
+     * Move a text to the specified position, for example when starting a new line.
+     */
+    virtual void MoveTextTo(int x, int y);
+
+    /**
+     * @name Method for starting and ending a graphic
+     */
+    ///@{
+    virtual void StartGraphic(Object *object, const std::string &gClass, const std::string &gId);
+    virtual void EndGraphic(Object *object, View *view);
+    ///@}
+
+    /**
+     * @name Methods for re-starting and ending a graphic for objects drawn in separate steps
+     */
+    ///@{
+    virtual void ResumeGraphic(Object *object, const std::string &gId);
+    virtual void EndResumedGraphic(Object *object, View *view);
+    ///@}
+
+    /**
+     * @name Method for starting and ending a text graphic
+     */
+    ///@{
+    virtual void StartTextGraphic(Object *object, const std::string &gClass, const std::string &gId);
+    virtual void EndTextGraphic(Object *object, View *view);
+    ///@}
+
+    /**
+     * @name Method for starting and ending page
+     */
+    ///@{
+    virtual void StartPage();
+    virtual void EndPage();
+    ///@}
+
+private:
+    /**
+     * @name Append an operation code or an argument to the buffer
+     */
+    ///@{
+    void AddOp(DisplayListOp op);
+    void AddInt(int value);
+    void AddDouble(double value);
+    void AddPointer(const void *pointer);
+    void AddPoints(int n, const Point points[]);
+    void AddString(const std::string &string);
+    void AddWString(const std::wstring &wstring);
+    ///@}
+
+    /**
+     * Record the pen, the brush, the font and the deactivation of the graphic if they changed since the last operation
+     */
+    void AddState();
+
+    /**
+     * Return the index of the font in the font table, adding it if necessary
+     */
+    int GetFontIndex(FontInfo *font);
+
+private:
+    Point m_origin;
+
+    // the buffer of operation codes and arguments
+    std::vector<char> m_ops;
+    // the strings referred to by index in the buffer
+    std::vector<std::string> m_strings;
+    std::vector<std::wstring> m_wstrings;
+    // the fonts are copied because the ones on the stack are not always kept by the view
+    std::vector<FontInfo> m_fonts;
+
+    // the state as recorded last
+    Pen m_recordedPen;
+    Brush m_recordedBrush;
+    int m_recordedFont;
+    bool m_recordedDeactivatedX;
+    bool m_recordedDeactivatedY;
+};
+
+} // namespace vrv
+
+#endif // __VRV_DISPLAY_LIST_DC_H__
@@ -8,6 +8,10 @@
 #ifndef __VRV_DOC_H__
 #define __VRV_DOC_H__
 
+#include <atomic>
+
+//----------------------------------------------------------------------------
+
 #include "devicecontextbase.h"
 #include "scoredef.h"
 #include "style.h"
@@ -207,8 +211,22 @@ public:
     /**
      * Casts off the entire document.
      * Starting from a single system, create and fill pages and systems.
+     * With lazy, only the first page is cast off. The remaining content is kept in the
+     * last page of the document until it is requested with Doc::CastOffUntilPage.
+     */
+    void CastOff(bool lazy = false);
+
+    /**
+     * Continue a lazy cast off until the page pageIdx is complete.
+     * Passing -1 casts off the rest of the document. Does nothing if no cast off is pending.
      */
-    void CastOff();
+    void CastOffUntilPage(int pageIdx);
+
+    /**
+     * Return true if a lazy cast off has not been completed yet.
+     * In that case, the last page(s) of the document hold content that is not cast off.
+     */
+    bool IsCastOffPending() const { return m_castOffPending; };
 
     /**
      * Undo the cast off of the entire document.
@@ -216,6 +234,23 @@ public:
      */
     void UnCastOff();
 
+    /**
+     * @name Progress of the preparation and cast off of the document and cooperative cancellation.
+     * These are the only methods that can be called from another thread while the document is being laid out.
+     * The cancellation is checked between the passes of Doc::PrepareDrawing and between the chunks
+     * of Doc::CastOffUntilPage, which both return early once it has been requested.
+     * The request has to be cleared when the load is finished for the lazy cast off to be able to continue.
+     */
+    ///@{
+    void ResetProgress();
+    void RequestCancel() { m_cancelRequested = true; };
+    void ClearCancelRequest() { m_cancelRequested = false; };
+    bool IsCancelRequested() const { return m_cancelRequested; };
+    int GetProgressMeasureCount() const { return m_progressMeasureCount; };
+    int GetProgressMeasuresDone() const { return m_progressMeasuresDone; };
+    int GetProgressSystemsDone() const { return m_progressSystemsDone; };
+    ///@}
+
     /**
      * To be implemented.
      */
@@ -271,11 +306,19 @@ private:
      */
     int CalcMusicFontSize();
 
+    /**
+     * Cast off the measureCount first children of the remaining content.
+     * Pages are final only once the following system did not fit in them. The last page and the
+     * last system of the chunk are carried over to the next call when some content remains.
+     */
+    void CastOffChunk(int measureCount);
+
 public:
     /**
-     * A copy of the header tree stored as pugi::xml_document
+     * The header tree serialized as a string.
+     * It is parsed again only when the document is written to MEI.
      */
-    pugi::xml_document m_header;
+    std::string m_header;
 
     /**
      * Holds the top scoreDef.
@@ -378,6 +421,31 @@ private:
      */
     bool m_midiExportDone;
 
+    /**
+     * The state of a lazy cast off.
+     * m_castOffScoreDefWidth is the scoreDef width for the first system of the next chunk and
+     * m_castOffChunkSize the number of measures cast off at once when a page is requested.
+     * m_castOffLongestDur is the longest duration of the entire content used for the spacing and
+     * m_castOffMeasureXRel the position of the first measure of the next chunk in the entire content.
+     * When m_castOffCarriedPage is true, the page before the last one holds systems waiting for
+     * the next chunk to be cast off into pages.
+     */
+    bool m_castOffPending;
+    bool m_castOffCarriedPage;
+    int m_castOffScoreDefWidth;
+    int m_castOffChunkSize;
+    int m_castOffLongestDur;
+    int m_castOffMeasureXRel;
+
+    /**
+     * The progress of the cast off and the cancellation flag.
+     * They are atomic because they are read and set from the thread driving a background layout.
+     */
+    std::atomic<bool> m_cancelRequested;
+    std::atomic<int> m_progressMeasureCount;
+    std::atomic<int> m_progressMeasuresDone;
+    std::atomic<int> m_progressSystemsDone;
+
     /** Page width (MEI scoredef@page.width) - currently not saved */
     int m_pageWidth;
     /** Page height (MEI scoredef@page.height) - currently not saved */
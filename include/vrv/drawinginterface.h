@@ -66,6 +66,8 @@ public:
 private:
     /** The list of object for which drawing is postponed */
     ListOfObjects m_drawingList;
+    /** Indicates if m_drawingList is sorted and without duplicates */
+    bool m_drawingListSorted;
 };
 
 //----------------------------------------------------------------------------
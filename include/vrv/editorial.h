@@ -195,6 +195,12 @@ public:
      */
     void AddLemOrRdg(EditorialElement *lemOrRdg);
 
+    /**
+     * Make the <lem> or <rdg> visible and hide all the others.
+     * Return false if it is not a child of the apparatus.
+     */
+    bool SelectLemOrRdg(EditorialElement *lemOrRdg);
+
 protected:
     /** We store the level of the <app> for integrity check */
     EditorialLevel m_level;
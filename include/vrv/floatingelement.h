@@ -116,6 +116,16 @@ public:
 
     void UpdateSlurPosition(const Point points[4], float angle, int thickness, curvature_CURVEDIR curveDir);
 
+    /**
+     * @name Get and set the slur curve calculated by View::AdjustSlur for the page layout revision.
+     * The cached curve is valid only for the same end points and curve direction before adjustment.
+     */
+    ///@{
+    bool GetCachedSlurCurve(int layoutRevision, curvature_CURVEDIR curveDir, Point points[4], float *angle) const;
+    void SetCachedSlurCurve(
+        int layoutRevision, curvature_CURVEDIR curveDir, const Point ends[2], const Point points[4], float angle);
+    ///@}
+
     /**
      * @name Get and set the Y drawing relative position
      */
@@ -139,6 +149,17 @@ protected:
     float m_slurAngle;
     int m_slurThickness;
     curvature_CURVEDIR m_slurDir;
+
+    /**
+     * The cached slur curve with the page layout revision and the end points it was calculated for
+     */
+    ///@{
+    int m_cachedSlurRevision;
+    curvature_CURVEDIR m_cachedSlurDir;
+    Point m_cachedSlurEnds[2];
+    Point m_cachedSlurPoints[4];
+    float m_cachedSlurAngle;
+    ///@}
 };
 
 } // namespace vrv
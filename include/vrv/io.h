@@ -9,6 +9,8 @@
 #define __VRV_IO_H__
 
 #include <fstream>
+#include <string>
+#include <vector>
 
 namespace vrv {
 
@@ -71,7 +73,19 @@ public:
 
     // read
     virtual bool ImportFile() { return true; }
-    virtual bool ImportString(std::string data) { return true; }
+    virtual bool ImportString(const std::string &data) { return true; }
+
+    /**
+     * Import data from a mutable buffer owned by the caller.
+     * Inputs that can parse it in place override it. By default, the data is passed to ImportString.
+     */
+    virtual bool ImportBuffer(char *data, size_t length) { return ImportString(std::string(data, length)); }
+
+    /**
+     * Setter for the flag telling that the buffer passed to ImportBuffer is a private mapping of the file.
+     * Only the pages of such a buffer can be discarded once read (see DiscardBuffer).
+     */
+    void SetBufferFileMapping() { m_bufferFileMapping = true; };
 
     /**
      * Setter for the layoutInformation ignore flag
@@ -95,12 +109,49 @@ public:
      */
     virtual void SetAppXPathQuery(std::string xPathQuery){};
 
+    /**
+     * @name Restrict the import to an <mdiv>, a measure range and / or a set of staves (MEI only)
+     */
+    ///@{
+    virtual void SetMdivSelection(std::string mdiv){};
+    virtual void SetMeasureRange(std::string range, bool byIndex){};
+    virtual void SetStaffSelection(std::string staves){};
+    ///@}
+
+    /**
+     * Set the number of threads for building the objects (MEI only)
+     */
+    virtual void SetThreadCount(int threadCount){};
+
 private:
     /**
      * Init values (called by the constructors)
      */
     void Init();
 
+protected:
+    /**
+     * @name Methods for reading XML data element by element.
+     * SplitXmlElements copies the data into a skeleton in which the content of each element with the name
+     * is replaced by the index of its fragment (position and length in the data). Only the skeleton is parsed
+     * at once and the fragment of an element is parsed when it is read, so the DOM of the entire data never
+     * exists. Returns false if the data could not be scanned, in which case it has to be parsed at once.
+     * FindString returns the position of the string in the data from pos, or length if not found.
+     */
+    ///@{
+    static bool SplitXmlElements(const char *data, size_t length, const char *name, std::string &skeleton,
+        std::vector<std::pair<size_t, size_t> > &fragments);
+    static size_t FindString(const char *data, size_t length, size_t pos, const char *str);
+    ///@}
+
+    /**
+     * Return the memory pages of a buffer between begin and end to the system once they have been read.
+     * Only the pages entirely within the range are discarded and their content is undefined afterwards.
+     * Returns the position up to which the buffer was discarded, which is begin if nothing was.
+     * Nothing is discarded if the buffer is not a private mapping of the file, with Emscripten and on Windows.
+     */
+    size_t DiscardBuffer(char *data, size_t begin, size_t end);
+
 public:
     //
 protected:
@@ -125,6 +176,13 @@ protected:
      * one single system.
      */
     bool m_ignoreLayoutInformation;
+
+    /**
+     * Set to true if the buffer imported is a private mapping of the file. Its pages
+     * can then be discarded and are reloaded from the file if accessed again. Any other
+     * buffer, owned by the caller or decompressed in memory, would lose its content.
+     */
+    bool m_bufferFileMapping;
 };
 
 } // namespace vrv
@@ -8,6 +8,7 @@
 #ifndef __VRV_IOMEI_H__
 #define __VRV_IOMEI_H__
 
+#include <set>
 #include <sstream>
 
 //----------------------------------------------------------------------------
@@ -86,6 +87,22 @@ class Tuplet;
 class Unclear;
 class Verse;
 
+//----------------------------------------------------------------------------
+// MeiStringWriter
+//----------------------------------------------------------------------------
+
+/**
+ * This class is a pugi writer appending the output to a string.
+ */
+class MeiStringWriter : public pugi::xml_writer {
+public:
+    MeiStringWriter(std::string &output) : m_output(output) {}
+    virtual void write(const void *data, size_t size) { m_output.append(static_cast<const char *>(data), size); }
+
+private:
+    std::string &m_output;
+};
+
 //----------------------------------------------------------------------------
 // MeiOutput
 //----------------------------------------------------------------------------
@@ -108,6 +125,12 @@ public:
      */
     virtual bool ExportFile();
 
+    /**
+     * Export the MEI to a pugi writer (file, buffer or callback).
+     * The MEI is written while the document is saved and only the elements not completed are kept in memory.
+     */
+    bool Export(pugi::xml_writer &writer);
+
     /**
      * The main method for write objects.
      */
@@ -119,7 +142,7 @@ public:
     virtual bool WriteObjectEnd(Object *object);
 
     /**
-     * Return the output as a string by writing it to the stringstream member.
+     * Return the output as a string by writing it directly to it.
      */
     std::string GetOutput(int page = -1);
 
@@ -136,6 +159,18 @@ private:
      */
     void WriteXmlId(pugi::xml_node currentNode, Object *object);
 
+    /**
+     * @name Methods for streaming the output.
+     * The start tags of the containers are written when a child is appended to them and
+     * the elements are written and removed from the tree as soon as they are completed.
+     */
+    ///@{
+    bool IsStreamed(pugi::xml_node node);
+    void WriteStartTags(pugi::xml_node node);
+    void WriteEndTag(pugi::xml_node node);
+    void WriteChildren(pugi::xml_node node, pugi::xml_node until, int depth);
+    ///@}
+
     /**
      * @name Methods for writing MEI containers (measures, staff, etc) scoreDef and related.
      */
@@ -269,8 +304,9 @@ public:
     //
 private:
     std::string m_filename;
-    std::ostringstream m_streamStringOutput;
-    bool m_writeToStreamString;
+    /** The writer when exporting and the elements with their start tag written */
+    pugi::xml_writer *m_writer;
+    std::vector<pugi::xml_node> m_openNodes;
     int m_page;
     bool m_scoreBasedMEI;
     pugi::xml_node m_mei;
@@ -283,6 +319,12 @@ private:
 // MeiInput
 //----------------------------------------------------------------------------
 
+/**
+ * The position of the measure being read relatively to the selected measure range
+ */
+enum MeasureRangePosition { RANGE_BEFORE = 0, RANGE_WITHIN, RANGE_AFTER };
+
+
 /**
  * This class is a file input stream for reading MEI files.
  * It uses the libmei C++ library.
@@ -295,20 +337,94 @@ public:
     virtual ~MeiInput();
 
     virtual bool ImportFile();
-    virtual bool ImportString(std::string mei);
+    virtual bool ImportString(const std::string &mei);
+    virtual bool ImportBuffer(char *data, size_t length);
 
     /**
      * Set an xPath query for selecting specific <rdg>.
      * By default, the first <lem> or <rdg> is loaded.
      * If a query is provided, the element retrieved by the specified xPath
      * query will be selected (if any, otherwise the first one will be used).
+     * The query is compiled once for the entire import.
+     */
+    virtual void SetAppXPathQuery(std::string appXPathQuery);
+
+    /**
+     * Select the <mdiv> to read by its @n or its @xml:id.
+     * By default, the first <mdiv> of the <body> is read.
+     */
+    virtual void SetMdivSelection(std::string mdiv) { m_mdivSelection = mdiv; };
+
+    /**
+     * Restrict the import of score-based MEI to a range of measures given as "start-end".
+     * Measures are identified by their @n or, with byIndex, by their position (from 1) in the <mdiv>.
+     * The start or the end can be omitted ("-8" or "3-") and a single value selects one measure.
+     * Measures before the range are not read but the scoreDef, clef and key changes they contain
+     * are applied to the initial scoreDef. The reading stops once the end of the range is reached.
+     */
+    virtual void SetMeasureRange(std::string range, bool byIndex);
+
+    /**
+     * Restrict the import to the staves with the @n values given as a list ("1,3").
+     * Other <staffDef> and <staff> elements, the <staffGrp> left empty and the control events
+     * with a @staff not in the list are not read.
      */
-    virtual void SetAppXPathQuery(std::string appXPathQuery) { m_appXPathQuery = appXPathQuery; };
+    virtual void SetStaffSelection(std::string staves);
+
+    /**
+     * Build the measures of score-based MEI with several threads (0 for one per core).
+     * The measures are built in chunks before the data is read, each thread generating the uuids
+     * and buffering the log messages of a chunk on its own, and the reading then attaches them in order.
+     * This is possible only when the data is read measure by measure and without a measure range.
+     */
+    virtual void SetThreadCount(int threadCount) { m_threadCount = threadCount; };
 
 private:
+    /**
+     * Import the data for ImportString and ImportBuffer.
+     * With inPlace, the data is parsed in place and has to be mutable.
+     */
+    bool ImportData(const char *data, size_t length, bool inPlace);
+
     bool ReadMei(pugi::xml_node root);
     bool ReadMeiHeader(pugi::xml_node meihead);
 
+    /**
+     * @name Methods for reading the data measure by measure.
+     * The <measure> elements are split with FileInputStream::SplitXmlElements into m_measureFragments
+     * and the fragment of a measure is parsed when the measure is read.
+     * When the data is parsed in place, DiscardMeasureData discards it up to the end of the fragment once
+     * the measure has been read, since everything else is in the skeleton.
+     */
+    ///@{
+    bool ParseMeasureFragment(pugi::xml_node measure, pugi::xml_document &fragment);
+    bool GetMeasureFragment(pugi::xml_node measure, const char *&data, size_t &length);
+    void DiscardMeasureData(pugi::xml_node measure);
+    ///@}
+
+    /**
+     * @name Methods for building the measures in parallel (see SetThreadCount).
+     * CollectMeasures follows the order in which ReadScoreBasedMei reads the measures.
+     */
+    ///@{
+    bool ReadMeiMeasuresInParallel(pugi::xml_node mdiv);
+    void CollectMeasures(pugi::xml_node element, std::vector<pugi::xml_node> &measures);
+    void ClearParallelMeasures();
+    ///@}
+
+    /**
+     * @name Methods for the selective import (see SetMeasureRange and SetStaffSelection).
+     * IsMeasureSelected updates m_measureRangePosition and has to be called once for each measure.
+     * The ReadSkipped methods apply the changes in a skipped <scoreDef> or <measure> to the doc scoreDef.
+     */
+    ///@{
+    bool IsMeasureSelected(pugi::xml_node measure);
+    bool IsStaffSelected(pugi::xml_node element);
+    bool HasSelectedStaffDef(pugi::xml_node staffGrp);
+    void ReadSkippedScoreDef(pugi::xml_node scoreDef);
+    void ReadSkippedMeasure(pugi::xml_node measure);
+    ///@}
+
     /**
      * @name Methods for reading  MEI containers (measures, staff, etc) scoreDef and related.
      * For each container (page, system, measure, staff and layer) there is one method for
@@ -328,6 +444,7 @@ private:
     bool ReadMeiStaffGrpChildren(Object *parent, pugi::xml_node parentNode);
     bool ReadMeiStaffDef(Object *parent, pugi::xml_node staffDef);
     bool ReadMeiMeasure(Object *parent, pugi::xml_node measure);
+    bool ReadMeiMeasureContent(Measure *vrvMeasure, pugi::xml_node measure);
     bool ReadMeiMeasureChildren(Object *parent, pugi::xml_node parentNode);
     bool ReadMeiStaff(Object *parent, pugi::xml_node staff);
     bool ReadMeiStaffChildren(Object *parent, pugi::xml_node parentNode);
@@ -336,8 +453,12 @@ private:
     bool ReadMeiTextChildren(Object *parent, pugi::xml_node parentNode, Object *filter = NULL);
     ///@}
 
+    /** The signature of the methods for reading MEI layer elements */
+    typedef bool (MeiInput::*LayerElementReader)(Object *parent, pugi::xml_node element);
+
     /**
      * @name Methods for reading MEI layer elements
+     * They all have the LayerElementReader signature and are dispatched by name in ReadMeiLayerChildren.
      */
     ///@{
     bool ReadMeiAccid(Object *parent, pugi::xml_node accid);
@@ -459,7 +580,7 @@ private:
     /**
      * Returns true if the element is name is an editorial element (e.g., "app", "supplied", etc.)
      */
-    bool IsEditorialElementName(std::string elementName);
+    bool IsEditorialElementName(const std::string &elementName);
 
     /**
      * Read score-based MEI
@@ -489,19 +610,59 @@ private:
     System *m_system;
 
     /**
-     *
+     * The xPath query for selecting the <lem> or <rdg> of the <app> and its compiled version.
+     * m_appXPath is NULL if no query is given or if it cannot be compiled.
      */
     std::string m_appXPathQuery;
+    pugi::xpath_query *m_appXPath;
 
     /**
      * This is used when reading a standard MEI file to specify if a scoreDef has already been read or not.
      */
     bool m_hasScoreDef;
 
+    /**
+     * The data being read and the position and length of the <measure> fragments in it.
+     * They are set only while the data is read measure by measure.
+     * With m_meiInPlace, the fragments are parsed in place and the data is discarded up to m_meiDiscarded.
+     */
+    const char *m_meiData;
+    bool m_meiInPlace;
+    size_t m_meiDiscarded;
+    std::vector<std::pair<size_t, size_t> > m_measureFragments;
+
+    /**
+     * @name The selection for the selective import.
+     * An empty m_measureRangeStart or m_measureRangeEnd leaves the range open at that end.
+     */
+    ///@{
+    std::string m_mdivSelection;
+    bool m_hasMeasureRange;
+    std::string m_measureRangeStart;
+    std::string m_measureRangeEnd;
+    bool m_measureRangeByIndex;
+    std::set<int> m_staffSelection;
+    ///@}
+
+    /**
+     * The index of the last measure read and its position relatively to the measure range.
+     */
+    int m_measureIndex;
+    MeasureRangePosition m_measureRangePosition;
+
+    /**
+     * The number of threads and the measures built in parallel with their <measure> node.
+     * m_parallelMeasureIndex is the next one to be attached by ReadMeiMeasure.
+     */
+    int m_threadCount;
+    std::vector<pugi::xml_node> m_parallelMeasureNodes;
+    std::vector<Measure *> m_parallelMeasures;
+    size_t m_parallelMeasureIndex;
+
     /**
      * Check if an element is allowed within a given parent
      */
-    bool IsAllowed(std::string element, Object *filterParent);
+    bool IsAllowed(const std::string &element, Object *filterParent);
 
     /**
      * A static array for storing the implemented editorial elements
@@ -82,14 +82,27 @@ public:
     virtual ~MusicXmlInput();
 
     virtual bool ImportFile();
-    virtual bool ImportString(std::string musicxml);
+    virtual bool ImportString(const std::string &musicxml);
+    virtual bool ImportBuffer(char *data, size_t length);
 
 private:
     /**
-     * Top level method called from ImportFile or ImportString
+     * Import the data for ImportString and ImportBuffer.
+     * With inPlace, the data is parsed in place and has to be mutable.
+     */
+    bool ImportData(const char *data, size_t length, bool inPlace);
+
+    /**
+     * Top level method called from ImportFile, ImportString or ImportBuffer
      */
     bool ReadMusicXml(pugi::xml_node root);
 
+    /**
+     * Parse the fragment of a <part> when the data is read part by part.
+     * Returns false if the part is not a placeholder, in which case it is already parsed.
+     */
+    bool ParsePartFragment(pugi::xml_node part, pugi::xml_document &fragment);
+
     /**
      * @name Top level methods for reading MusicXml part and measure elements.
      */
@@ -115,13 +128,6 @@ private:
     void ReadMusicXmlNote(pugi::xml_node, Measure *measure, int measureNb);
     ///@}
 
-    /**
-     * Add a Measure to the system.
-     * If the measure already exists it will move all its content.
-     * The measure can contain only staves. Other elements must be stacked on m_floatingElements.
-     */
-    void AddMeasure(System *system, Measure *measure, int i);
-
     /**
      * Add a Layer element to the layer or to the LayerElement at the top of m_elementStack.
      */
@@ -129,6 +135,7 @@ private:
 
     /**
      * Returns the appropriate layer for a node looking at its MusicXml staff and voice elements.
+     * The staff number is relative to the part being read (see m_staffOffset).
      */
     Layer *SelectLayer(pugi::xml_node node, Measure *measure);
 
@@ -195,6 +202,17 @@ private:
 private:
     /** The filename */
     std::string m_filename;
+
+    /**
+     * The data being read and the position and length of the <part> fragments in it.
+     * They are set only while the data is read part by part.
+     * With m_xmlInPlace, the fragments are parsed in place.
+     */
+    const char *m_xmlData;
+    bool m_xmlInPlace;
+    std::vector<std::pair<size_t, size_t> > m_partFragments;
+    /** The number of staves of the parts before the one being read in the current measure */
+    int m_staffOffset;
     /** The stack for piling open LayerElements (beams, tuplets, chords, etc.)  */
     std::vector<LayerElement *> m_elementStack;
     /** The stack for open slurs */
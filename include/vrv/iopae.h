@@ -214,6 +214,91 @@ namespace pae {
         int wholerest; // number of whole rests to process
     };
 
+    //----------------------------------------------------------------------------
+    // Token
+    //----------------------------------------------------------------------------
+
+    enum TokenType {
+        TOKEN_OCTAVE = 0,
+        TOKEN_DURATIONS,
+        TOKEN_ACCIDENTAL,
+        TOKEN_BEAM_START,
+        TOKEN_BEAM_END,
+        TOKEN_TUPLET_START,
+        TOKEN_FERMATA_START,
+        TOKEN_TUPLET_FERMATA_END,
+        TOKEN_ACCIACCATURA,
+        TOKEN_APPOGGIATURA,
+        TOKEN_APPOGGIATURA_END,
+        TOKEN_NOTE,
+        TOKEN_WHOLE_REST,
+        TOKEN_ABBREVIATION,
+        TOKEN_MEASURE_REPEAT,
+        TOKEN_BARLINE,
+        TOKEN_CLEF,
+        TOKEN_TIMESIG,
+        TOKEN_KEYSIG
+    };
+
+    /**
+     * A token of the incipit, with its position and its length in the data.
+     * The value depends on the type (octave, accidental, number of notes, bar line, etc.).
+     * For clefs, time and key signatures, the text of the value follows the first character.
+     */
+    struct Token {
+        TokenType type;
+        size_t position;
+        size_t length;
+        int value;
+        // flags of a note given by the characters between it and the next one
+        bool trill;
+        bool tie;
+        bool chord;
+    };
+
+    //----------------------------------------------------------------------------
+    // Lexer
+    //----------------------------------------------------------------------------
+
+    /**
+     * This class reads the tokens of an incipit in a single pass over the data.
+     * The data is not copied and has to remain valid as long as the lexer is used.
+     */
+    class Lexer {
+    public:
+        Lexer(const char *data, size_t length);
+
+        /**
+         * Read the next token. Returns false at the end of the data.
+         * Unexpected characters are skipped with a warning giving their position.
+         */
+        bool Next(Token &token);
+
+        /**
+         * @name Return the length of the time or key signature at the beginning of the data.
+         * Used for the header values too.
+         */
+        ///@{
+        static size_t GetTimeSigLength(const char *data, size_t length);
+        static size_t GetKeySigLength(const char *data, size_t length);
+        ///@}
+
+    private:
+        bool StartsWith(size_t pos, const char *str) const;
+        int GetTupletNotes(size_t pos) const;
+        void ReadNoteFlags(size_t pos, Token &token);
+
+    private:
+        const char *m_data;
+        size_t m_length;
+        size_t m_pos;
+        /** The end of the span read for the note flags and the last flag positions in it */
+        size_t m_flagsEnd;
+        size_t m_lastTrill;
+        size_t m_lastTie;
+        size_t m_lastChord;
+    };
+
 } // namespace pae
 
 //----------------------------------------------------------------------------
@@ -227,7 +312,13 @@ public:
     virtual ~PaeInput();
 
     virtual bool ImportFile();
-    virtual bool ImportString(std::string pae);
+    virtual bool ImportString(const std::string &pae);
+
+    /**
+     * Import the next @start...@end record of a stream with a series of incipits.
+     * The same input can be used for all of them. Returns false if there is no record left.
+     */
+    bool ImportNextRecord(std::istream &input);
 
 #ifndef NO_PAE_SUPPORT
 
@@ -237,20 +328,12 @@ private:
     void parsePlainAndEasy(std::istream &infile);
 
     // parsing functions
-    int getKeyInfo(const char *incipit, KeySig *key, int index = 0);
-    int getTimeInfo(const char *incipit, MeterSig *meter, int index = 0);
-    int getClefInfo(const char *incipit, Clef *mus_clef, int index = 0);
-    int getBarLine(const char *incipit, data_BARRENDITION *output, int index);
-    int getAccidental(const char *incipit, data_ACCIDENTAL_EXPLICIT *accident, int index = 0);
-    int getOctave(const char *incipit, char *octave, int index = 0);
-    int getDurations(const char *incipit, pae::Measure *measure, int index = 0);
-    int getDuration(const char *incipit, data_DURATION *duration, int *dot, int index);
-    int getTupletFermata(const char *incipit, pae::Note *note, int index = 0);
-    int getTupletFermataEnd(const char *incipit, pae::Note *note, int index = 0);
-    int getGraceNote(const char *incipit, pae::Note *note, int index = 0);
-    int getWholeRest(const char *incipit, int *wholerest, int index);
-    int getAbbreviation(const char *incipit, pae::Measure *measure, int index = 0);
-    int getNote(const char *incipit, pae::Note *note, pae::Measure *measure, int index = 0);
+    void getKeyInfo(const char *data, size_t length, KeySig *key);
+    void getTimeInfo(const char *data, size_t length, MeterSig *meter);
+    void getClefInfo(const char *data, size_t length, Clef *mus_clef);
+    void getDurations(const char *data, size_t length, pae::Measure *measure);
+    void getAbbreviation(int repeats, pae::Measure *measure);
+    void getNote(const pae::Token &token, char c_note, pae::Note *note, pae::Measure *measure);
 
     data_PITCHNAME getPitch(char c_note);
 
@@ -262,7 +345,7 @@ private:
     void pushContainer(LayerElement *container);
 
     // input functions
-    void getAtRecordKeyValue(char *key, char *value, const char *input);
+    void getAtRecordKeyValue(const std::string &line, std::string &key, std::string &value);
 
 #endif // NO_PAE_SUPPORT
 
@@ -230,6 +230,12 @@ public:
     void SetUuid(std::string uuid);
     void ResetUuid();
 
+    /**
+     * Generate the uuids of the objects created by the calling thread with a generator of its own
+     * seeded with the value. A seed of 0 restores the use of std::rand, which is shared by all threads.
+     */
+    static void SeedThreadUuids(unsigned int seed);
+
     /**
      * @name Children count, with or without a ClassId.
      * Used for classes with several types of children.
@@ -8,6 +8,10 @@
 #ifndef __VRV_PAGE_H__
 #define __VRV_PAGE_H__
 
+#include <atomic>
+
+//----------------------------------------------------------------------------
+
 #include "object.h"
 #include "scoredef.h"
 
@@ -67,9 +71,26 @@ public:
     void LayOut(bool force = false);
 
     /**
-     * Lay out the content of the page (measures and their content) horizontally
+     * Mark the layout as to be done again the next time the page is drawn.
+     * This is necessary when the content of the page changed, for example with another <rdg> made visible.
+     */
+    void ResetLayout() { m_layoutDone = false; };
+
+    /**
+     * Return the longest actual duration (DUR_*) in the page.
+     * DUR_4 is returned if the page has no element with a duration.
+     */
+    int GetLongestActualDur();
+
+    /**
+     * Lay out the content of the page (measures and their content) horizontally.
+     * The spacing is based on the longest duration in the page unless one is given,
+     * which is the case when the page holds only a part of the content to be cast off.
      */
+    ///@{
     void LayOutHorizontally();
+    void LayOutHorizontally(int longestActualDur);
+    ///@}
 
     /**
      * Justifiy the content of the page (measures and their content) horizontally
@@ -86,6 +107,16 @@ public:
      */
     void JustifyVertically();
 
+    /**
+     * @name Get the layout revision and mark the layout as modified.
+     * Drawing values cached by the View (e.g., beams or slurs) are valid only for the revision they were computed for.
+     * A new revision is given by each layout step and has to be given after any editing operation.
+     */
+    ///@{
+    int GetLayoutRevision() const { return m_layoutRevision; };
+    void ModifyLayout();
+    ///@}
+
     /**
      * Return the height of the content by looking at the last system of the page.
      * This is used for adjusting the page height when this is the expected behaviour,
@@ -139,6 +170,12 @@ private:
      * the force parameter is set.
      */
     bool m_layoutDone;
+
+    /** The current layout revision of the page */
+    int m_layoutRevision;
+
+    /** The last revision given - revisions are unique accross pages and documents */
+    static std::atomic<int> s_layoutRevision;
 };
 
 } // namespace vrv
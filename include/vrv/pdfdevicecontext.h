@@ -0,0 +1,260 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        pdfdevicecontext.h
+// Author:      agent
+// Created:     19/10/2026
+// Copyright (c) Authors and others. All rights reserved.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef __VRV_PDF_DC_H__
+#define __VRV_PDF_DC_H__
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+//----------------------------------------------------------------------------
+
+#include "devicecontext.h"
+
+namespace vrv {
+
+//----------------------------------------------------------------------------
+// PdfDeviceContext
+//----------------------------------------------------------------------------
+
+/**
+ * This class implements a drawing context that writes the pages as vector PDF to a stream.
+ * Each page is written when it is ended, so several pages can be drawn one after the other with the same device context
+ * for a single document, which is completed by Finish().
+ * The music glyphs are written once for the whole document as form XObjects read from the ./data/[fontname]/[glyph].xml
+ * files. Text is written with the standard Times fonts, which are not embedded.
+ */
+class PdfDeviceContext : public DeviceContext {
+public:
+    /**
+     * @name Constructors, destructors, and other standard methods
+     */
+    ///@{
+    PdfDeviceContext(std::ostream &output);
+    virtual ~PdfDeviceContext();
+    virtual ClassId Is() const { return PDF_DEVICE_CONTEXT; };
+    ///@}
+
+    /**
+     * Prepare the device context for drawing the next page with the specified size
+     */
+    void Reset(int width, int height);
+
+    /**
+     * Write the glyphs, the fonts and the page tree to complete the document.
+     * No page can be added afterwards.
+     */
+    void Finish();
+
+    /**
+     * @name Setters
+     */
+    ///@{
+    virtual void SetBackground(int colour, int style = AxSOLID);
+    virtual void SetBackgroundImage(void *image, double opacity = 1.0){};
+    virtual void SetBackgroundMode(int mode);
+    virtual void SetTextForeground(int colour);
+    virtual void SetTextBackground(int colour);
+    virtual void SetLogicalOrigin(int x, int y);
+    virtual void SetUserScale(double xScale, double yScale);
+    ///@}
+
+    /**
+     * @name Getters
+     */
+    ///@{
+    virtual Point GetLogicalOrigin();
+    int GetPageCount() const { return (int)m_pageObjects.size(); };
+    ///@}
+
+    /**
+     * @name Drawing methods
+     */
+    ///@{
+    virtual void DrawComplexBezierPath(Point bezier1[4], Point bezier2[4]);
+    virtual void DrawCircle(int x, int y, int radius);
+    virtual void DrawEllipse(int x, int y, int width, int height);
+    virtual void DrawEllipticArc(int x, int y, int width, int height, double start, double end);
+    virtual void DrawLine(int x1, int y1, int x2, int y2);
+    virtual void DrawPolygon(int n, Point points[], int xoffset, int yoffset, int fill_style = AxODDEVEN_RULE);
+    virtual void DrawRectangle(int x, int y, int width, int height);
+    virtual void DrawRotatedText(const std::string &text, int x, int y, double angle);
+    virtual void DrawRoundedRectangle(int x, int y, int width, int height, double radius);
+    virtual void DrawText(const std::string &text, const std::wstring &wtext = L"");
+    virtual void DrawMusicText(const std::wstring &text, int x, int y);
+    virtual void DrawSpline(int n, Point points[]);
+    virtual void DrawBackgroundImage(int x = 0, int y = 0){};
+    ///@}
+
+    /**
+     * @name Method for starting and ending a text
+     */
+    ///@{
+    virtual void StartText(int x, int y, char alignement = LEFT);
+    virtual void EndText();
+
+    /**
+     * Move a text to the specified position, for example when starting a new line.
+     */
+    virtual void MoveTextTo(int x, int y);
+
+    /**
+     * @name Method for starting and ending a graphic
+     */
+    ///@{
+    virtual void StartGraphic(Object *object, const std::string &gClass, const std::string &gId){};
+    virtual void EndGraphic(Object *object, View *view){};
+    ///@}
+
+    /**
+     * @name Methods for re-starting and ending a graphic for objects drawn in separate steps
+     */
+    ///@{
+    virtual void ResumeGraphic(Object *object, const std::string &gId){};
+    virtual void EndResumedGraphic(Object *object, View *view){};
+    ///@}
+
+    /**
+     * @name Method for starting and ending page
+     */
+    ///@{
+    virtual void StartPage();
+    virtual void EndPage();
+    ///@}
+
+private:
+    /**
+     * A run of text with the same font within a line
+     */
+    struct PdfTextRun {
+        std::wstring m_text;
+        FontInfo m_font;
+        int m_colour;
+        int m_width;
+    };
+
+    /**
+     * A line of text with its position - the runs are written when the text is ended for the line to be aligned
+     */
+    struct PdfTextLine {
+        int m_x, m_y;
+        std::vector<PdfTextRun> m_runs;
+    };
+
+    /**
+     * @name Write to the output
+     * The content of the pages is buffered and flushed by chunks.
+     */
+    ///@{
+    void Write(const std::string &data);
+    void Flush();
+    ///@}
+
+    /**
+     * Reserve the number of a new object, which can be written later
+     */
+    int AddObject();
+
+    /**
+     * Start writing an object, keeping its offset for the cross-reference table
+     */
+    void StartObject(int object);
+
+    /**
+     * Append a number with at most four decimals
+     */
+    static void AppendNumber(std::string &output, double value);
+
+    /**
+     * Append the point converted with the logical origin
+     */
+    void AppendPoint(double x, double y);
+
+    /**
+     * Append the text as a PDF string in the WinAnsi encoding of the standard fonts
+     */
+    void AppendTextString(const std::wstring &text);
+
+    /**
+     * Set the fill colour, the stroke colour and the line width when they differ from the current ones
+     */
+    void SetFillColour(int colour);
+    void SetStrokeColour(int colour);
+    void SetLineWidth(int width);
+
+    /**
+     * Set the state for filling and / or stroking a path according to the brush and the pen.
+     * It has to be done before the path is started.
+     */
+    void SetPaint(bool &fill, bool &stroke);
+
+    /**
+     * Fill and / or stroke the current path
+     */
+    void PaintPath(bool close, bool fill, bool stroke);
+
+    /**
+     * Append a cubic bezier approximation of an elliptic arc, from start to end angle (in radians)
+     */
+    void AppendArc(double xc, double yc, double rx, double ry, double start, double end);
+
+    /**
+     * Draw the music glyphs at the position with the point size
+     */
+    void DrawGlyphs(const std::wstring &text, int x, int y, int pointSize);
+
+    /**
+     * Get the index of the Times font matching the style and the weight, reserving its object the first time
+     */
+    int GetFontIndex(const FontInfo &font);
+
+    /**
+     * Write a glyph as a form XObject converting its SVG path
+     */
+    void WriteGlyph(const std::string &path, int object);
+
+private:
+    std::ostream &m_output;
+    // the number of bytes written so far
+    size_t m_offset;
+    // the page content waiting to be flushed
+    std::string m_buffer;
+
+    int m_width, m_height;
+    int m_originX, m_originY;
+    double m_userScaleX, m_userScaleY;
+
+    // the offsets of the objects, which are numbered from 1
+    std::vector<size_t> m_objectOffsets;
+    std::vector<int> m_pageObjects;
+    // the object of the current page content and of its length
+    int m_contentObject;
+    int m_contentLengthObject;
+    size_t m_contentStart;
+
+    // the current graphic state of the page
+    int m_fillColour;
+    int m_strokeColour;
+    int m_lineWidth;
+
+    // the text being drawn
+    std::vector<PdfTextLine> m_textLines;
+    char m_textAlignment;
+
+    // the glyphs used in the document with their object
+    std::map<std::string, int> m_glyphIndexes;
+    std::vector<std::pair<std::string, int> > m_glyphs;
+    // the objects of the Times fonts, regular, italic, bold and bold italic, 0 when not used
+    int m_fontObjects[4];
+    bool m_finished;
+};
+
+} // namespace vrv
+
+#endif // __VRV_PDF_DC_H__
@@ -0,0 +1,250 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        rasterdevicecontext.h
+// Author:      agent
+// Created:     19/10/2026
+// Copyright (c) Authors and others. All rights reserved.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef __VRV_RASTER_DC_H__
+#define __VRV_RASTER_DC_H__
+
+#include <map>
+#include <string>
+#include <vector>
+
+#ifndef USE_EMSCRIPTEN
+#include <mutex>
+#endif
+
+//----------------------------------------------------------------------------
+
+#include "devicecontext.h"
+
+namespace vrv {
+
+class Glyph;
+
+//----------------------------------------------------------------------------
+// RasterPoint
+//----------------------------------------------------------------------------
+
+/**
+ * Simple class for representing points with sub-pixel precision
+ */
+class RasterPoint {
+public:
+    RasterPoint() : x(0.0), y(0.0) {}
+    RasterPoint(double x_, double y_) : x(x_), y(y_) {}
+
+    double x, y;
+};
+
+/** A closed contour of a shape, flattened to line segments */
+typedef std::vector<RasterPoint> RasterContour;
+
+//----------------------------------------------------------------------------
+// RasterOutline
+//----------------------------------------------------------------------------
+
+/**
+ * This class stores the outline of a glyph flattened to line segments, in the units of its viewBox.
+ */
+class RasterOutline {
+public:
+    RasterOutline() : m_size(1000.0) {}
+
+    /** The width of the viewBox of the glyph */
+    double m_size;
+    std::vector<RasterContour> m_contours;
+};
+
+//----------------------------------------------------------------------------
+// RasterDeviceContext
+//----------------------------------------------------------------------------
+
+/**
+ * This class implements a drawing context that draws directly into an anti-aliased pixel buffer.
+ * The buffer is RGBA with a transparent background, or grayscale with a white background, and can be encoded as PNG.
+ * The shapes are flattened to polygons and their coverage is accumulated for each pixel. The music glyphs are read
+ * from the ./data/[fontname]/[glyph].xml files once and kept flattened for all the device contexts.
+ * Text is not drawn because only the bounding boxes of the text font are available.
+ */
+class RasterDeviceContext : public DeviceContext {
+public:
+    /**
+     * @name Constructors, destructors, and other standard methods
+     */
+    ///@{
+    RasterDeviceContext(int width, int height);
+    virtual ~RasterDeviceContext();
+    virtual ClassId Is() const { return RASTER_DEVICE_CONTEXT; };
+    ///@}
+
+    /**
+     * Clear the buffer for drawing a new page with the specified size.
+     * The buffer is allocated with the user scale when the page is started.
+     */
+    void Reset(int width, int height);
+
+    /**
+     * Draw in grayscale on a white background instead of RGBA.
+     * It is kept when the device context is reset.
+     */
+    void SetGrayscale(bool grayscale) { m_grayscale = grayscale; };
+
+    /**
+     * @name Setters
+     */
+    ///@{
+    virtual void SetBackground(int colour, int style = AxSOLID);
+    virtual void SetBackgroundImage(void *image, double opacity = 1.0){};
+    virtual void SetBackgroundMode(int mode);
+    virtual void SetTextForeground(int colour);
+    virtual void SetTextBackground(int colour);
+    virtual void SetLogicalOrigin(int x, int y);
+    virtual void SetUserScale(double xScale, double yScale);
+    ///@}
+
+    /**
+     * @name Getters
+     */
+    ///@{
+    virtual Point GetLogicalOrigin();
+    int GetPixelWidth() const { return m_pixelWidth; };
+    int GetPixelHeight() const { return m_pixelHeight; };
+    /** One byte per pixel in grayscale, four otherwise */
+    const std::vector<unsigned char> &GetPixels() const { return m_pixels; };
+    ///@}
+
+    /**
+     * Encode the buffer as PNG into a string.
+     */
+    std::string GetPNG();
+
+    /**
+     * @name Drawing methods
+     */
+    ///@{
+    virtual void DrawComplexBezierPath(Point bezier1[4], Point bezier2[4]);
+    virtual void DrawCircle(int x, int y, int radius);
+    virtual void DrawEllipse(int x, int y, int width, int height);
+    virtual void DrawEllipticArc(int x, int y, int width, int height, double start, double end);
+    virtual void DrawLine(int x1, int y1, int x2, int y2);
+    virtual void DrawPolygon(int n, Point points[], int xoffset, int yoffset, int fill_style = AxODDEVEN_RULE);
+    virtual void DrawRectangle(int x, int y, int width, int height);
+    virtual void DrawRotatedText(const std::string &text, int x, int y, double angle);
+    virtual void DrawRoundedRectangle(int x, int y, int width, int height, double radius);
+    virtual void DrawText(const std::string &text, const std::wstring &wtext = L"");
+    virtual void DrawMusicText(const std::wstring &text, int x, int y);
+    virtual void DrawSpline(int n, Point points[]);
+    virtual void DrawBackgroundImage(int x = 0, int y = 0){};
+    ///@}
+
+    /**
+     * @name Method for starting and ending a text
+     */
+    ///@{
+    virtual void StartText(int x, int y, char alignement = LEFT);
+    virtual void EndText();
+
+    /**
+     * Move a text to the specified position, for example when starting a new line.
+     */
+    virtual void MoveTextTo(int x, int y);
+
+    /**
+     * @name Method for starting and ending a graphic
+     */
+    ///@{
+    virtual void StartGraphic(Object *object, const std::string &gClass, const std::string &gId){};
+    virtual void EndGraphic(Object *object, View *view){};
+    ///@}
+
+    /**
+     * @name Methods for re-starting and ending a graphic for objects drawn in separate steps
+     */
+    ///@{
+    virtual void ResumeGraphic(Object *object, const std::string &gId){};
+    virtual void EndResumedGraphic(Object *object, View *view){};
+    ///@}
+
+    /**
+     * @name Method for starting and ending page
+     */
+    ///@{
+    virtual void StartPage();
+    virtual void EndPage(){};
+    ///@}
+
+private:
+    /**
+     * Convert logical coordinates to pixels
+     */
+    RasterPoint ToPixel(double x, double y) const;
+
+    /**
+     * Fill the contours with the nonzero rule and blend them in the buffer with the colour
+     */
+    void FillContours(const std::vector<RasterContour> &contours, int colour);
+
+    /**
+     * Stroke a contour with the width (in pixels).
+     * The segments have butt ends and the joins are rounded when requested.
+     */
+    void StrokeContour(const RasterContour &contour, bool closed, double width, bool roundJoins, int colour);
+
+    /**
+     * Accumulate the signed area covered by a line segment in the coverage buffer
+     */
+    void AccumulateLine(double x0, double y0, double x1, double y1);
+
+    /**
+     * Append a flattened cubic bezier curve (without its first point) to a contour.
+     * The number of segments is given by the length of the control polygon divided by the tolerance.
+     */
+    static void FlattenCubic(RasterContour &contour, const RasterPoint &p0, const RasterPoint &p1,
+        const RasterPoint &p2, const RasterPoint &p3, double tolerance);
+
+    /**
+     * Append an ellipse to the contours, clockwise or not
+     */
+    static void AddEllipse(std::vector<RasterContour> &contours, double cx, double cy, double rx, double ry, bool cw);
+
+    /**
+     * Get the flattened outline of a glyph, loading it the first time
+     */
+    static const RasterOutline &GetOutline(Glyph *glyph);
+
+    /**
+     * Parse the SVG path data of a glyph and append its flattened contours
+     */
+    static void ParsePath(const char *data, std::vector<RasterContour> &contours);
+
+    /**
+     * Allocate the buffer if necessary
+     */
+    void AllocatePixels();
+
+private:
+    int m_width, m_height;
+    int m_originX, m_originY;
+    double m_userScaleX, m_userScaleY;
+    bool m_grayscale;
+
+    int m_pixelWidth, m_pixelHeight;
+    std::vector<unsigned char> m_pixels;
+
+    // the coverage of the shape being filled and its area in the buffer
+    std::vector<float> m_coverage;
+    int m_coverageX, m_coverageY, m_coverageWidth, m_coverageHeight;
+
+    // the outlines of the glyphs loaded so far for all the device contexts
+    static std::map<std::string, RasterOutline> m_outlines;
+#ifndef USE_EMSCRIPTEN
+    static std::mutex m_outlinesMutex;
+#endif
+};
+
+} // namespace vrv
+
+#endif // __VRV_RASTER_DC_H__
@@ -11,6 +11,7 @@
 #include <fstream>
 #include <iostream>
 #include <list>
+#include <map>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -19,20 +20,52 @@
 
 #include "devicecontext.h"
 
-//----------------------------------------------------------------------------
+namespace vrv {
 
-#include "pugixml.hpp"
+class Glyph;
 
-namespace vrv {
+//----------------------------------------------------------------------------
+// SvgElement
+//----------------------------------------------------------------------------
+
+/**
+ * This class stores the position in the SVG output of an element being written or of a <g> that can be resumed.
+ * The offsets are the ones in the output buffer.
+ */
+class SvgElement {
+public:
+    SvgElement(const char *name, int depth, size_t tagEnd);
+
+    const char *m_name;
+    std::string m_id;
+    int m_depth;
+    // the '>' of the start tag (or the " />" when closed without children)
+    size_t m_tagEnd;
+    // the first <g> child (std::string::npos if none)
+    size_t m_firstG;
+    // where the children are added
+    size_t m_end;
+    bool m_hasChildren;
+    // the end tag is already written (for resumed graphics)
+    bool m_hasEndTag;
+    // the index in the resumable graphic list (-1 if not resumed)
+    int m_graphic;
+    // a copy of the current element pushed when the graphic to resume is not found
+    bool m_isCopy;
+    // the first edit of the output not applied to the offsets (for the resumable graphics)
+    size_t m_edit;
+};
 
 //----------------------------------------------------------------------------
-// BBoxDeviceContext
+// SvgDeviceContext
 //----------------------------------------------------------------------------
 
 /**
  * This class implements a drawing context for generating SVG files.
  * The music font is embedded by incorporating ./data/[fontname]/[glyph].xml glyphs within
  * the SVG file.
+ * The SVG is written directly to a buffer. The elements still open and the <g> that can be resumed keep their
+ * offsets in the buffer, which are updated when something is inserted before them.
  */
 class SvgDeviceContext : public DeviceContext {
 public:
@@ -45,6 +78,12 @@ public:
     virtual ClassId Is() const { return SVG_DEVICE_CONTEXT; };
     ///@}
 
+    /**
+     * Clear the SVG for drawing a new one with the specified size.
+     * The glyph definitions already loaded are kept, which makes it cheaper than creating a new device context.
+     */
+    void Reset(int width, int height);
+
     /**
      * @name Setters
      */
@@ -65,12 +104,45 @@ public:
     virtual Point GetLogicalOrigin();
     ///}
 
+    /**
+     * @name Setters for the compact output
+     * The compact output has no indentation and the glyphs are defined once for each size used, which makes the
+     * sizing of each <use> unnecessary. The ids of the elements can also be omitted.
+     * They are kept when the device context is reset.
+     */
+    ///@{
+    void SetCompact(bool compact) { m_compact = compact; };
+    void SetRemoveIds(bool removeIds) { m_removeIds = removeIds; };
+    ///@}
+
+    /**
+     * Reference the glyphs in a sprite shared by all the pages instead of the <defs> of each page.
+     * The href is the URL of the sprite file and is prepended to the glyph references.
+     * It has to be empty when the sprite is inlined in the same HTML document as the pages.
+     */
+    void SetGlyphSprite(bool glyphSprite, const std::string &href = "")
+    {
+        m_glyphSprite = glyphSprite;
+        m_glyphHref = href;
+    };
+
+    /**
+     * Add the glyphs of a music text drawn with the given point size without drawing it.
+     * This is used for building the sprite from the glyphs of all the pages.
+     */
+    void AddGlyphs(const std::wstring &text, int pointSize);
+
     /**
      * Get the SVG into a string.
      * Add the xml tag if necessary.
      */
     std::string GetStringSVG(bool xml_declaration = false);
 
+    /**
+     * Write the SVG to a stream without copying it into a string first.
+     */
+    void WriteSVG(std::ostream &output, bool xml_declaration = false);
+
     /**
      * @name Drawing methods
      */
@@ -84,7 +156,7 @@ public:
     virtual void DrawRectangle(int x, int y, int width, int height);
     virtual void DrawRotatedText(const std::string &text, int x, int y, double angle);
     virtual void DrawRoundedRectangle(int x, int y, int width, int height, double radius);
-    virtual void DrawText(const std::string &text, const std::wstring wtext = L"");
+    virtual void DrawText(const std::string &text, const std::wstring &wtext = L"");
     virtual void DrawMusicText(const std::wstring &text, int x, int y);
     virtual void DrawSpline(int n, Point points[]);
     virtual void DrawBackgroundImage(int x = 0, int y = 0);
@@ -106,7 +178,7 @@ public:
      * @name Method for starting and ending a graphic
      */
     ///@{
-    virtual void StartGraphic(Object *object, std::string gClass, std::string gId);
+    virtual void StartGraphic(Object *object, const std::string &gClass, const std::string &gId);
     virtual void EndGraphic(Object *object, View *view);
     ///@}
 
@@ -114,7 +186,7 @@ public:
      * @name Methods for re-starting and ending a graphic for objects drawn in separate steps
      */
     ///@{
-    virtual void ResumeGraphic(Object *object, std::string gId);
+    virtual void ResumeGraphic(Object *object, const std::string &gId);
     virtual void EndResumedGraphic(Object *object, View *view);
     ///@}
 
@@ -122,7 +194,7 @@ public:
      * @name Method for starting and ending a text (<tspan>) text graphic.
      */
     ///@{
-    virtual void StartTextGraphic(Object *object, std::string gClass, std::string gId);
+    virtual void StartTextGraphic(Object *object, const std::string &gClass, const std::string &gId);
     virtual void EndTextGraphic(Object *object, View *view);
     ///@}
 
@@ -135,12 +207,6 @@ public:
     ///@}
 
 private:
-    /**
-     * Copy the content of a file to the output stream.
-     * This is used for copying <defs> items.
-     */
-    bool CopyFileToStream(const std::string &filename, std::ostream &dest);
-
     /**
      * Internal method for drawing debug SVG bounding box
      */
@@ -152,16 +218,53 @@ private:
     void VrvTextFont() { m_vrvTextFont = true; };
 
     /**
-     * Flush the data to the internal buffer.
-     * Adds the xml tag if necessary and the <defs> from m_smufl_glyphs
+     * Add a glyph to the ones to write in the <defs> (with its size in compact mode)
      */
-    void Commit(bool xml_declaration);
+    void AddGlyph(Glyph *glyph, int pointSize);
 
-    void WriteLine(std::string);
+    /**
+     * Write the xml tag if necessary, the <svg> start tag, the <defs> from m_smufl_glyphs and the woff font.
+     * Return false if the <svg> is empty and has no end tag to write.
+     */
+    bool WriteHead(std::string &head, bool xml_declaration);
+
+    /**
+     * Write the <defs> of the compact output with a <g> scaled to the size for each glyph and size used.
+     */
+    void WriteCompactDefs(std::string &head);
 
     std::string GetColour(int colour);
 
-    pugi::xml_node AppendChild(std::string name);
+    /**
+     * @name Methods for building the current tag in m_tag.
+     * The attribute values are escaped.
+     */
+    ///@{
+    void StartTag(const char *name);
+    void AddAttribute(const char *name, const std::string &value);
+    void AddAttribute(const char *name, int value);
+    void AddStrokeWidth(int width);
+    ///@}
+
+    /**
+     * @name Methods for writing the tag in m_tag to the output.
+     * With beforeG, the element is inserted before the first <g> of the current element, as AppendChild was doing.
+     */
+    ///@{
+    void WriteEmptyElement(bool beforeG);
+    void WriteStartElement(const char *name, bool beforeG, const std::string &gId = "");
+    void WriteEndElement();
+    size_t WriteChild(bool beforeG, bool isG);
+    ///@}
+
+    /**
+     * @name Methods for modifying the output and updating the offsets after the position.
+     */
+    ///@{
+    void Insert(size_t pos, const std::string &data);
+    void Erase(size_t pos, size_t length);
+    void ApplyEdits(SvgElement &element);
+    ///@}
 
 public:
     //
@@ -173,13 +276,6 @@ private:
      */
     bool m_vrvTextFont;
 
-    // we use a std::stringstream because we want to prepend the <defs> which will know only when we reach the end of
-    // the page
-    // some viewer seem to support to have the <defs> at the end, but some do not (pdf2svg, for example)
-    // for this reason, the full svg is finally written a string from the destructor or when Flush() is called
-    std::ostringstream m_outdata;
-
-    bool m_committed; // did we flushed the file?
     int m_width, m_height;
     int m_originX, m_originY;
     double m_userScaleX, m_userScaleY;
@@ -187,12 +283,34 @@ private:
     // holds the list of glyphs from the smufl font used so far
     // they will be added at the end of the file as <defs>
     std::vector<std::string> m_smufl_glyphs;
-
-    // pugixml data
-    pugi::xml_document m_svgDoc;
-    pugi::xml_node m_svgNode;
-    pugi::xml_node m_currentNode;
-    std::list<pugi::xml_node> m_svgNodeStack;
+    // the glyphs with the size used so far in the compact output
+    std::vector<std::pair<Glyph *, int> > m_smuflGlyphSizes;
+
+    // the output options
+    bool m_compact;
+    bool m_removeIds;
+    bool m_glyphSprite;
+    std::string m_glyphHref;
+
+    // the glyph definitions and the woff font loaded so far and already formatted for the <defs>
+    // they are kept when the device context is reset
+    std::map<std::string, std::string> m_glyphDefs;
+    std::string m_woffDef;
+    // the content of the glyph <symbol> without formatting and the width of its viewBox for the compact output
+    std::map<std::string, std::pair<int, std::string> > m_compactGlyphDefs;
+    std::string m_compactWoffDef;
+
+    // the content of the root <svg> - the <defs> are added before it only when the SVG is output
+    std::string m_body;
+    // the tag being built
+    std::string m_tag;
+    // the elements being written, starting with the root <svg>
+    std::vector<SvgElement> m_elementStack;
+    // the <g> already written with their id for resuming them
+    std::vector<SvgElement> m_graphics;
+    std::map<std::string, int> m_graphicIds;
+    // the insertions (positive) and deletions (negative) made before the end of the output
+    std::vector<std::pair<size_t, int> > m_edits;
 };
 
 } // namespace vrv
@@ -10,8 +10,15 @@
 
 #include <string>
 
+#ifndef USE_EMSCRIPTEN
+#include <atomic>
+#include <mutex>
+#include <thread>
+#endif
+
 //----------------------------------------------------------------------------
 
+#include "displaylistdevicecontext.h"
 #include "doc.h"
 #include "view.h"
 
@@ -26,6 +33,10 @@
 
 namespace vrv {
 
+class FileInputStream;
+class RasterDeviceContext;
+class SvgDeviceContext;
+
 typedef enum { MEI = 0, PAE, DARMS, MUSICXML } FileFormat;
 
 //----------------------------------------------------------------------------
@@ -51,14 +62,45 @@ public:
 
     /**
      * Load a file with the specified type.
+     * The file is memory-mapped (when available) and parsed in place.
+     * Gzip-compressed files and compressed MusicXML (.mxl) files are decompressed in memory.
      */
     bool LoadFile(const std::string &filename);
 
     /**
      * Load a string data with the specified type.
+     * Compressed data is decompressed as with LoadFile.
      */
     bool LoadString(const std::string &data);
 
+    /**
+     * Load data with the specified type from a mutable buffer owned by the caller.
+     * The buffer is parsed in place without being copied and its content is undefined afterwards.
+     */
+    bool LoadBuffer(char *data, size_t length);
+
+#ifndef USE_EMSCRIPTEN
+    /**
+     * @name Load a string data with the specified type in a background thread.
+     * LoadStringAsync returns immediately and the import, the preparation and the cast off of the
+     * document are done by a worker thread. Until WaitLoad has returned, only the methods of this group
+     * can be called. WaitLoad returns the result of the loading, which is false if it was cancelled.
+     * The cancellation is cooperative and becomes effective at the end of the current layout pass.
+     * CancelLoad does nothing once the load is done.
+     * The measure count is known once the cast off has started and is 0 before.
+     * Not available for Emscripten-based compiles
+     */
+    ///@{
+    void LoadStringAsync(const std::string &data);
+    bool IsLoadDone() const { return m_loadDone; };
+    bool WaitLoad();
+    void CancelLoad();
+    int GetLoadMeasureCount() const { return m_doc.GetProgressMeasureCount(); };
+    int GetLoadMeasuresDone() const { return m_doc.GetProgressMeasuresDone(); };
+    int GetLoadSystemsDone() const { return m_doc.GetProgressSystemsDone(); };
+    ///@}
+#endif
+
     /**
      * Save an MEI file.
      */
@@ -107,6 +149,63 @@ public:
      */
     bool RenderToSvgFile(const std::string &filename, int pageNo = 1);
 
+    /**
+     * Render the page as a binary buffer of drawing commands to be read in place, for example from JavaScript.
+     * The buffer starts with the width and the height of the page as 32-bit integers followed by the commands
+     * exported from the display list (see DisplayListDeviceContext::Export).
+     * The buffer is kept until the next call.
+     * Page number is 1-based
+     */
+    const std::vector<char> &RenderToCommands(int pageNo = 1);
+    const std::vector<char> &GetCommands() const { return m_commands; };
+
+    /**
+     * Render the page in PNG and returns it as a (binary) string.
+     * The size of the image in pixels is given by the page size and the scale.
+     * Page number is 1-based
+     */
+    std::string RenderToPng(int pageNo = 1);
+
+    /**
+     * Render the page in PNG and save it to the file.
+     * Page number is 1-based.
+     */
+    bool RenderToPngFile(const std::string &filename, int pageNo = 1);
+
+    /**
+     * Render the page in PDF and returns it as a (binary) string.
+     * All the pages are rendered in a single document with pageNo 0.
+     * Page number is 1-based
+     */
+    std::string RenderToPdf(int pageNo = 0);
+
+    /**
+     * Render the page in PDF and save it to the file, written as the pages are drawn.
+     * All the pages are rendered in a single document with pageNo 0.
+     * Page number is 1-based.
+     */
+    bool RenderToPdfFile(const std::string &filename, int pageNo = 0);
+
+    /**
+     * Render the glyphs used in all the pages of the document in a single SVG sprite and return it as a string.
+     * The pages rendered in SVG with the glyph sprite option reference it, whatever the pages rendered before.
+     */
+    std::string RenderGlyphSprite();
+
+    /**
+     * @name Render a batch of Plain and Easie incipits given as a series of @start...@end records.
+     * The incipits are loaded and rendered one after the other with the same document, view, importer and SVG
+     * device context, so that the setup that does not depend on the incipit is done only once for the batch.
+     * Up to maxCount incipits (all if 0) are read from the stream, which can be read further by another call.
+     * Malformed incipits are not rejected and are rendered with what could be read from them, so there is one
+     * SVG for each record read.
+     * The current document is replaced by the last incipit.
+     */
+    ///@{
+    std::vector<std::string> RenderPaeBatchToSvg(std::istream &input, int maxCount = 0);
+    std::vector<std::string> RenderPaeBatchToSvg(const std::string &data);
+    ///@}
+
     /**
      * Creates a midi file, opens it, and writes to it.
      * currently generates a dummy midi file.
@@ -141,6 +240,14 @@ public:
      */
     void RedoLayout();
 
+    /**
+     * Select the readings to be displayed for a set of <app> without reloading the data.
+     * The @xml:id of the <lem> or <rdg> to make visible are given as a space-separated list.
+     * Only the pages with one of the <app> are laid out again, without changing the system breaks.
+     * Returns false if one of the ids is not a <lem> or a <rdg>.
+     */
+    bool SelectAppReadings(const std::string &xmlIds);
+
     /**
      * Return the page on which the element is the ID (xml:id) is rendered.
      * This takes into account the current layout options.
@@ -207,6 +314,41 @@ public:
     int GetSpacingSystem() { return m_spacingSystem; };
     ///@}
 
+    /**
+     * @name Write a compact SVG without indentation and with the glyphs defined for each size
+     */
+    ///@{
+    void SetSvgCompact(bool c) { m_svgCompact = c; };
+    int GetSvgCompact() { return m_svgCompact; };
+    ///@}
+
+    /**
+     * @name Omit the ids of the elements in the SVG
+     */
+    ///@{
+    void SetSvgRemoveIds(bool r) { m_svgRemoveIds = r; };
+    int GetSvgRemoveIds() { return m_svgRemoveIds; };
+    ///@}
+
+    /**
+     * @name Reference the glyphs in a sprite shared by all the pages and given by its URL
+     * The URL is empty when the sprite is inlined in the same HTML document as the pages.
+     */
+    ///@{
+    void SetSvgGlyphSprite(bool g) { m_svgGlyphSprite = g; };
+    int GetSvgGlyphSprite() { return m_svgGlyphSprite; };
+    void SetSvgGlyphHref(std::string const &svgGlyphHref) { m_svgGlyphHref = svgGlyphHref; };
+    std::string GetSvgGlyphHref() { return m_svgGlyphHref; };
+    ///@}
+
+    /**
+     * @name Render the PNG in grayscale on a white background instead of RGBA
+     */
+    ///@{
+    void SetPngGrayscale(bool g) { m_pngGrayscale = g; };
+    int GetPngGrayscale() { return m_pngGrayscale; };
+    ///@}
+
     /**
      * @name Space notes equally and close together (normally for mensural notation)
      */
@@ -241,6 +383,16 @@ public:
     int GetIgnoreLayout() { return m_ignoreLayout; };
     ///@}
 
+    /**
+     * @name Cast off the pages only when they are requested
+     * The first page is available once the file is loaded and the following ones are
+     * laid out on demand. Getting the page count casts off the entire document.
+     */
+    ///@{
+    void SetLazyLayout(bool l) { m_lazyLayout = l; };
+    int GetLazyLayout() { return m_lazyLayout; };
+    ///@}
+
     /**
      * @name Crop the page height to the height of the content
      */
@@ -291,6 +443,32 @@ public:
     std::string GetAppXPathQuery() { return m_appXPathQuery; };
     ///@}
 
+    /**
+     * @name Set and get the selection for importing only a part of the data (MEI only)
+     * The mdiv is given by its @n or its @xml:id, the measure range as "start-end" with
+     * the @n of the measures (or their position with SetMeasureRangeByIndex) and the
+     * staves as a list of @n ("1,3"). An empty value selects everything.
+     */
+    ///@{
+    void SetMdiv(std::string const &mdiv) { m_mdiv = mdiv; };
+    std::string GetMdiv() { return m_mdiv; };
+    void SetMeasureRange(std::string const &measureRange) { m_measureRange = measureRange; };
+    std::string GetMeasureRange() { return m_measureRange; };
+    void SetMeasureRangeByIndex(bool byIndex) { m_measureRangeByIndex = byIndex; };
+    int GetMeasureRangeByIndex() { return m_measureRangeByIndex; };
+    void SetStaves(std::string const &staves) { m_staves = staves; };
+    std::string GetStaves() { return m_staves; };
+    ///@}
+
+    /**
+     * @name Set and get the number of threads building the objects when loading (MEI only)
+     * The default is 1 and 0 uses one thread per core.
+     */
+    ///@{
+    void SetImportThreads(int importThreads) { m_importThreads = importThreads; };
+    int GetImportThreads() { return m_importThreads; };
+    ///@}
+
     /**
      * @name Set and get the xPath query for selecting <app> (if any)
      */
@@ -324,8 +502,77 @@ public:
     ///@}
 
 private:
-    bool IsUTF16(const std::string &filename);
-    bool LoadUTF16File(const std::string &filename);
+    bool IsUTF16(const char *data, size_t length);
+    /**
+     * Load the content of a file, which is decompressed and converted to UTF-8 first if necessary.
+     * With fileMapping, the data is a private mapping of the file that the input can discard once read.
+     */
+    bool LoadFileBuffer(char *data, size_t length, bool fileMapping);
+    bool LoadBuffer(char *data, size_t length, bool fileMapping);
+    /**
+     * Decompress gzip data or the root file of a compressed MusicXML (.mxl) archive.
+     * The root file is the first one listed in META-INF/container.xml.
+     */
+    bool Decompress(const char *data, size_t length, std::string &content);
+
+    /**
+     * Create the input for the format with the options set.
+     */
+    FileInputStream *CreateInput();
+
+    /**
+     * Prepare and lay out the document once the input has imported the data. The input is deleted.
+     * With progressive, the cast off is done by chunks for the progress to be updated.
+     */
+    bool LoadInput(FileInputStream *input, bool progressive);
+
+    /**
+     * Prepare and lay out the document as in LoadInput but without deleting the input.
+     */
+    bool LayOutInput(FileInputStream *input, bool progressive);
+
+    /**
+     * Render the page with the device context, which is reset first.
+     */
+    std::string RenderToSvg(SvgDeviceContext *svg, int pageNo, bool xml_declaration);
+
+    /**
+     * Render the page with the device context without getting the SVG.
+     */
+    void RenderToSvgDeviceContext(SvgDeviceContext *svg, int pageNo);
+
+    /**
+     * Render the page in the pixel buffer of the device context, which is reset first.
+     */
+    void RenderToRasterDeviceContext(RasterDeviceContext *raster, int pageNo);
+
+    /**
+     * Render the page, or all the pages with pageNo 0, as a PDF document written to the stream.
+     */
+    void RenderToPdfStream(std::ostream &output, int pageNo);
+
+    /**
+     * Cast off and set the page for drawing and get its size according to the options.
+     * Page number is 0-based.
+     */
+    void SetDrawingPage(int pageNo, int &width, int &height);
+
+    /**
+     * Record the page set for drawing in the display list unless it is already recorded.
+     * Page number is 0-based.
+     */
+    void RecordPage(int pageNo);
+
+    /**
+     * Draw the page set for drawing with the device context, replaying the recorded page when possible.
+     * Page number is 0-based.
+     */
+    void DrawPage(DeviceContext *dc, int pageNo);
+
+    /**
+     * Discard the recorded page - to be called whenever the document or its layout changes.
+     */
+    void ResetDisplayList() { m_displayListPage = -1; };
 
 protected:
 #ifdef USE_EMSCRIPTEN
@@ -357,8 +604,19 @@ private:
 
     bool m_noLayout;
     bool m_ignoreLayout;
+    bool m_lazyLayout;
     bool m_adjustPageHeight;
+    bool m_svgCompact;
+    bool m_svgRemoveIds;
+    bool m_svgGlyphSprite;
+    std::string m_svgGlyphHref;
+    bool m_pngGrayscale;
     std::string m_appXPathQuery;
+    std::string m_mdiv;
+    std::string m_measureRange;
+    bool m_measureRangeByIndex;
+    std::string m_staves;
+    int m_importThreads;
     bool m_scoreBasedMei;
     bool m_evenNoteSpacing;
     float m_spacingLinear;
@@ -368,6 +626,25 @@ private:
     bool m_showBoundingBoxes;
 
     char *m_cString;
+
+    /**
+     * The drawing of the page rendered last, replayed when the same page is rendered again
+     * The number of pages in the document is kept for detecting when the layout has progressed
+     */
+    DisplayListDeviceContext m_displayList;
+    int m_displayListPage;
+    int m_displayListPageCount;
+    /** The commands exported from the display list by RenderToCommands */
+    std::vector<char> m_commands;
+
+#ifndef USE_EMSCRIPTEN
+    /** The worker thread of LoadStringAsync and its result */
+    std::thread m_loadThread;
+    std::atomic<bool> m_loadDone;
+    bool m_loadResult;
+    /** For a cancellation not to be requested after the load is done */
+    std::mutex m_loadMutex;
+#endif
 };
 
 } // namespace vrv
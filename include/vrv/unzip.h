@@ -0,0 +1,61 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        unzip.h
+// Author:      agent
+// Created:     19/10/2026
+// Copyright (c) Authors and others. All rights reserved.
+/////////////////////////////////////////////////////////////////////////////
+
+#ifndef __VRV_UNZIP_H__
+#define __VRV_UNZIP_H__
+
+#include <string>
+
+namespace vrv {
+
+//----------------------------------------------------------------------------
+// Unzip
+//----------------------------------------------------------------------------
+
+/**
+ * This class decompresses gzip data and the entries of zip archives in memory.
+ * Only stored and deflated data is supported, which covers compressed MEI and MusicXML (.mxl) files.
+ * The output is inflated directly into a buffer of the uncompressed size when it is known.
+ */
+class Unzip {
+public:
+    /**
+     * @name Check the signature of the data
+     */
+    ///@{
+    static bool IsGzip(const char *data, size_t length);
+    static bool IsZip(const char *data, size_t length);
+    ///@}
+
+    /**
+     * Decompress gzip data (possibly with several members).
+     * Returns false if the data is not valid.
+     */
+    static bool Gunzip(const char *data, size_t length, std::string &output);
+
+    /**
+     * Decompress the entry with the given name in a zip archive.
+     * Returns false if the entry cannot be found or is not valid.
+     */
+    static bool ReadZipEntry(const char *data, size_t length, const std::string &name, std::string &output);
+
+    /**
+     * Calculate the CRC-32 of the data, as used by gzip, zip and PNG.
+     */
+    static unsigned int Crc32(const char *data, size_t length);
+
+private:
+    /**
+     * Inflate raw deflate data and append it to the output.
+     * The number of bytes read is set in consumed.
+     */
+    static bool Inflate(const unsigned char *data, size_t length, std::string &output, size_t &consumed);
+};
+
+} // namespace vrv
+
+#endif // __VRV_UNZIP_H__
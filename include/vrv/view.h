@@ -400,6 +400,8 @@ private:
         Point *p1, Point *p2, Point *c1, Point *c2, curvature_CURVEDIR curveDir, int height, int staffSize);
     void GetSpanningPointPositions(ArrayOfLayerElementPointPairs *spanningPoints, Point p1, float angle,
         curvature_CURVEDIR curveDir, int staffSize);
+    static void CalcSpanningPointsOnCurve(
+        Point bezier[], ArrayOfLayerElementPointPairs *spanningPoints, std::vector<int> *curveYs);
     ///@}
 
     /**
@@ -429,10 +431,17 @@ private:
     static Point CalcPositionAfterRotation(Point point, float rot_alpha, Point center);
 
     /**
-     * Calculate the position of a point after a rotation of rot_alpha around the center
+     * Calculate the y position of a bezier curve at the x position
      */
     static int CalcBezierAtPosition(Point bezier[], int x);
 
+    /**
+     * Calculate the y positions of a bezier curve for count x positions.
+     * The positions are passed as structure of arrays (xs and ys) so they can be processed in batch
+     * (with SSE2 when available). The results are identical to CalcBezierAtPosition.
+     */
+    static void CalcBezierAtPositions(Point bezier[], const int *xs, int *ys, int count);
+
     /**
      * Swap values passed as reference.
      * This is useful for example when switching to the device context world.
@@ -479,9 +488,6 @@ protected:
     ScoreDef m_drawingScoreDef;
 
 private:
-    /** buffer for De-Casteljau algorithm */
-    static int s_deCasteljau[4][4];
-
     /** @name Internal values for storing temporary values for ligatures */
     ///@{
     static int s_drawingLigX[2], s_drawingLigY[2];
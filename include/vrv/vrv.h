@@ -32,6 +32,14 @@ void LogMessage(const char *fmt, ...);
 void LogWarning(const char *fmt, ...);
 void DisableLog();
 
+/**
+ * Capture the log messages of the calling thread in a buffer instead of printing them.
+ * This is used by worker threads, whose messages are then printed in order with PrintLogBuffer.
+ * Passing NULL restores the printing for the thread.
+ */
+void SetThreadLogBuffer(std::vector<std::string> *buffer);
+void PrintLogBuffer(const std::vector<std::string> &buffer);
+
 /**
  * Member and functions specific to emscripten loging that uses a vector of string to buffer the logs.
  */
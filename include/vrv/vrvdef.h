@@ -135,6 +135,9 @@ enum ClassId {
     TEXT_ELEMENT_max,
     //
     BBOX_DEVICE_CONTEXT,
+    DISPLAY_LIST_DEVICE_CONTEXT,
+    PDF_DEVICE_CONTEXT,
+    RASTER_DEVICE_CONTEXT,
     SVG_DEVICE_CONTEXT,
     //
     UNSPECIFIED
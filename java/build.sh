@@ -20,6 +20,7 @@ FILES="../src/accid.cpp \
              ../src/clef.cpp \
              ../src/custos.cpp \
              ../src/devicecontext.cpp \
+             ../src/displaylistdevicecontext.cpp \
              ../src/dir.cpp \
              ../src/doc.cpp \
              ../src/dot.cpp \
@@ -46,9 +47,11 @@ FILES="../src/accid.cpp \
              ../src/note.cpp \
              ../src/object.cpp \
              ../src/page.cpp \
+             ../src/pdfdevicecontext.cpp \
              ../src/pitchinterface.cpp \
              ../src/positioninterface.cpp \
              ../src/proport.cpp \
+             ../src/rasterdevicecontext.cpp \
              ../src/rest.cpp \
              ../src/rpt.cpp \
              ../src/scoredef.cpp \
@@ -69,6 +72,7 @@ FILES="../src/accid.cpp \
              ../src/timestamp.cpp \
              ../src/toolkit.cpp \
              ../src/tuplet.cpp \
+             ../src/unzip.cpp \
              ../src/verse.cpp \
              ../src/view.cpp \
              ../src/view_beam.cpp \
@@ -94,7 +98,7 @@ FILES="../src/accid.cpp \
              ../libmei/atts_pagebased.cpp \
              ../libmei/atts_shared.cpp"
 
-CXXOPTS="-g -fpic -std=c++11 -I../include -I../include/vrv -I../include/midi -I../include/pugi -I../include/utf8 -I../libmei -I/opt/local/include/ -I/System/Library/Frameworks/JavaVM.framework/Headers/"
+CXXOPTS="-g -fpic -pthread -std=c++11 -I../include -I../include/vrv -I../include/midi -I../include/pugi -I../include/utf8 -I../libmei -I/opt/local/include/ -I/System/Library/Frameworks/JavaVM.framework/Headers/"
 g++ -shared -o target/libverovio.jnilib $CXXOPTS $FILES verovio_wrap.cxx
 cp target/libverovio.jnilib target/classes/META-INF/lib
 
@@ -24,6 +24,7 @@ verovio_module = Extension('_verovio',
              '../src/clef.cpp',
              '../src/custos.cpp',
              '../src/devicecontext.cpp',
+             '../src/displaylistdevicecontext.cpp',
              '../src/dir.cpp',
              '../src/doc.cpp', 
              '../src/dot.cpp',
@@ -50,9 +51,11 @@ verovio_module = Extension('_verovio',
              '../src/note.cpp',
              '../src/object.cpp',
              '../src/page.cpp',
+             '../src/pdfdevicecontext.cpp',
              '../src/pitchinterface.cpp',
              '../src/positioninterface.cpp',
              '../src/proport.cpp',
+             '../src/rasterdevicecontext.cpp',
              '../src/rest.cpp',
              '../src/rpt.cpp',
              '../src/scoredef.cpp',
@@ -73,6 +76,7 @@ verovio_module = Extension('_verovio',
              '../src/timestamp.cpp',
              '../src/toolkit.cpp',
              '../src/tuplet.cpp',
+             '../src/unzip.cpp',
              '../src/verse.cpp',
              '../src/view.cpp',
              '../src/view_beam.cpp',
@@ -100,7 +104,8 @@ verovio_module = Extension('_verovio',
              'verovio.i'],
                 swig_opts=['-c++'],
                 include_dirs=['/usr/local/include', '../include', '../include/vrv', '../include/midi', '../include/pugi', '../include/utf8', '../libmei'],
-                extra_compile_args=['-std=c++11', '-Wno-write-strings', '-Wno-overloaded-virtual', '-Wno-unused-private-field'])
+                extra_compile_args=['-std=c++11', '-Wno-write-strings', '-Wno-overloaded-virtual', '-Wno-unused-private-field'],
+                extra_link_args=['-pthread'])
 
 setup (name = 'verovio',
        version = '0.9.9',
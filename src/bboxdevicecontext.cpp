@@ -54,14 +54,14 @@ BBoxDeviceContext::~BBoxDeviceContext()
 {
 }
 
-void BBoxDeviceContext::StartGraphic(Object *object, std::string gClass, std::string gId)
+void BBoxDeviceContext::StartGraphic(Object *object, const std::string &gClass, const std::string &gId)
 {
     // add the object object
     object->BoundingBox::ResetBoundingBox();
     m_objects.push_back(object);
 }
 
-void BBoxDeviceContext::ResumeGraphic(Object *object, std::string gId)
+void BBoxDeviceContext::ResumeGraphic(Object *object, const std::string &gId)
 {
     // I am not sure we actually have to reset the bounding box here...
     object->BoundingBox::ResetBoundingBox();
@@ -125,16 +125,15 @@ Point BBoxDeviceContext::GetLogicalOrigin()
     return Point(0, 0);
 }
 
-// calculated better
 void BBoxDeviceContext::DrawComplexBezierPath(Point bezier1[4], Point bezier2[4])
 {
     Point pos;
     int width, height;
 
-    ApproximateBezierBoundingBox(bezier1, &pos, &width, &height);
+    CalcBezierBoundingBox(bezier1, &pos, &width, &height);
     // LogDebug("x %d, y %d, width %d, height %d", pos.x, pos.y, width, height);
     UpdateBB(pos.x, pos.y, pos.x + width, pos.y + height);
-    ApproximateBezierBoundingBox(bezier2, &pos, &width, &height);
+    CalcBezierBoundingBox(bezier2, &pos, &width, &height);
     // LogDebug("x %d, y %d, width %d, height %d", pos.x, pos.y, width, height);
     UpdateBB(pos.x, pos.y, pos.x + width, pos.y + height);
 }
@@ -313,7 +312,7 @@ void BBoxDeviceContext::MoveTextTo(int x, int y)
     m_textY = y;
 }
 
-void BBoxDeviceContext::DrawText(const std::string &text, const std::wstring wtext)
+void BBoxDeviceContext::DrawText(const std::string &text, const std::wstring &wtext)
 {
     assert(m_fontStack.top());
 
@@ -392,63 +391,56 @@ void BBoxDeviceContext::UpdateBB(int x1, int y1, int x2, int y2)
     }
 }
 
-void BBoxDeviceContext::ApproximateBezierBoundingBox(Point bezier[], Point *pos, int *width, int *height)
+void BBoxDeviceContext::CalcBezierBoundingBox(Point bezier[], Point *pos, int *width, int *height)
 {
-    int ax = bezier[0].x;
-    int ay = bezier[0].y;
-    int bx = bezier[1].x;
-    int by = bezier[1].y;
-    int cx = bezier[2].x;
-    int cy = bezier[2].y;
-    int dx = bezier[3].x;
-    int dy = bezier[3].y;
+    int minx, miny, maxx, maxy;
+    CalcBezierExtrema(bezier[0].x, bezier[1].x, bezier[2].x, bezier[3].x, &minx, &maxx);
+    CalcBezierExtrema(bezier[0].y, bezier[1].y, bezier[2].y, bezier[3].y, &miny, &maxy);
 
-    double px, py, qx, qy, rx, ry, sx, sy, tx, ty, tobx, toby, tocx, tocy, todx, tody, toqx, toqy, torx, tory, totx,
-        toty;
-    int x, y, minx, miny, maxx, maxy;
-
-    minx = miny = -VRV_UNSET;
-    maxx = maxy = VRV_UNSET;
-
-    tobx = bx - ax;
-    toby = by - ay; // directions
-    tocx = cx - bx;
-    tocy = cy - by;
-    todx = dx - cx;
-    tody = dy - cy;
-    double step = 1.0 / 40.0; // precision
-    int i;
-    for (i = 0; i < 41; i++) {
-        double d = i * step;
-        px = ax + d * tobx;
-        py = ay + d * toby;
-        qx = bx + d * tocx;
-        qy = by + d * tocy;
-        rx = cx + d * todx;
-        ry = cy + d * tody;
-        toqx = qx - px;
-        toqy = qy - py;
-        torx = rx - qx;
-        tory = ry - qy;
-
-        sx = px + d * toqx;
-        sy = py + d * toqy;
-        tx = qx + d * torx;
-        ty = qy + d * tory;
-        totx = tx - sx;
-        toty = ty - sy;
-
-        x = sx + d * totx;
-        y = sy + d * toty;
-        minx = std::min(minx, x);
-        miny = std::min(miny, y);
-        maxx = std::max(maxx, x);
-        maxy = std::max(maxy, y);
-    }
     pos->x = minx;
     pos->y = miny;
     (*width) = maxx - minx;
     (*height) = maxy - miny;
 }
 
+void BBoxDeviceContext::CalcBezierExtrema(int p0, int p1, int p2, int p3, int *min, int *max)
+{
+    // The end points are always on the curve
+    double minValue = std::min(p0, p3);
+    double maxValue = std::max(p0, p3);
+
+    // The extrema in-between are at the roots of the derivative, i.e., of a * t^2 + b * t + c (divided by 3)
+    double a = -p0 + 3.0 * p1 - 3.0 * p2 + p3;
+    double b = 2.0 * (p0 - 2.0 * p1 + p2);
+    double c = p1 - p0;
+
+    double roots[2];
+    int rootCount = 0;
+    if (fabs(a) < 1e-9) {
+        // The derivative is linear (or constant)
+        if (fabs(b) > 1e-9) roots[rootCount++] = -c / b;
+    }
+    else {
+        double delta = b * b - 4.0 * a * c;
+        if (delta >= 0.0) {
+            double sqrtDelta = sqrt(delta);
+            roots[rootCount++] = (-b + sqrtDelta) / (2.0 * a);
+            roots[rootCount++] = (-b - sqrtDelta) / (2.0 * a);
+        }
+    }
+
+    int i;
+    for (i = 0; i < rootCount; i++) {
+        double t = roots[i];
+        if ((t <= 0.0) || (t >= 1.0)) continue;
+        double u = 1.0 - t;
+        double value = u * u * u * p0 + 3.0 * u * u * t * p1 + 3.0 * u * t * t * p2 + t * t * t * p3;
+        minValue = std::min(minValue, value);
+        maxValue = std::max(maxValue, value);
+    }
+
+    (*min) = (int)floor(minValue);
+    (*max) = (int)ceil(maxValue);
+}
+
 } // namespace vrv
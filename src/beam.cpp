@@ -34,6 +34,8 @@ Beam::~Beam()
 void Beam::Reset()
 {
     LayerElement::Reset();
+
+    m_cachedRevision = -1;
 }
 
 void Beam::AddLayerElement(LayerElement *element)
@@ -135,6 +137,8 @@ bool Beam::IsLastInBeam(LayerElement *element)
 void Beam::InitCoords(ListOfObjects *childList)
 {
     ClearCoords();
+    // The coordinates are new and the cached values are no longer valid
+    m_cachedRevision = -1;
     m_beamElementCoords.reserve(childList->size());
     int i;
     for (i = 0; i < childList->size(); i++) {
@@ -142,6 +146,38 @@ void Beam::InitCoords(ListOfObjects *childList)
     }
 }
 
+bool Beam::GetCachedDrawingParams(int layoutRevision, BeamParams *params, int *elementCount) const
+{
+    assert(params);
+    assert(elementCount);
+
+    if (m_cachedRevision != layoutRevision) return false;
+    assert(m_cachedElementCount <= (int)m_beamElementCoords.size());
+
+    *params = m_cachedParams;
+    *elementCount = m_cachedElementCount;
+    int i;
+    for (i = 0; i < m_cachedElementCount; i++) {
+        m_beamElementCoords.at(i)->m_x = m_cachedCoordXs.at(i);
+    }
+    return true;
+}
+
+void Beam::SetCachedDrawingParams(int layoutRevision, const BeamParams *params, int elementCount)
+{
+    assert(params);
+    assert(elementCount <= (int)m_beamElementCoords.size());
+
+    m_cachedRevision = layoutRevision;
+    m_cachedParams = *params;
+    m_cachedElementCount = elementCount;
+    m_cachedCoordXs.resize(elementCount);
+    int i;
+    for (i = 0; i < elementCount; i++) {
+        m_cachedCoordXs.at(i) = m_beamElementCoords.at(i)->m_x;
+    }
+}
+
 void Beam::ClearCoords()
 {
     ArrayOfBeamElementCoords::iterator iter;
@@ -0,0 +1,851 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        displaylistdevicecontext.cpp
+// Author:      agent
+// Created:     19/10/2026
+// Copyright (c) Authors and others. All rights reserved.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "displaylistdevicecontext.h"
+
+//----------------------------------------------------------------------------
+
+#include <assert.h>
+#include <string.h>
+
+//----------------------------------------------------------------------------
+
+#include "vrv.h"
+
+namespace vrv {
+
+static bool IsSameFont(FontInfo &font1, FontInfo &font2)
+{
+    return (font1.GetPointSize() == font2.GetPointSize()) && (font1.GetFamily() == font2.GetFamily())
+        && (font1.GetStyle() == font2.GetStyle()) && (font1.GetWeight() == font2.GetWeight())
+        && (font1.GetUnderlined() == font2.GetUnderlined()) && (font1.GetEncoding() == font2.GetEncoding())
+        && (font1.faceName == font2.faceName);
+}
+
+/**
+ * The arguments of each operation, in the order of DisplayListOp, for exporting them:
+ * i: int; d: double; p: points; s: string; w: wstring; t: string and wstring; f: font; o: pointer
+ */
+static const char *displayListArgs[] = { "iii", "ii", "f", "ii", "ii", "i", "i", "ii", "p", "iii", "iiii", "iiiidd",
+    "iiii", "piii", "iiii", "siid", "iiiid", "t", "wii", "p", "ii", "ii", "iii", "", "ii", "oss", "oo", "os", "oo", "oss",
+    "oo", "", "" };
+
+//----------------------------------------------------------------------------
+// DisplayListReader
+//----------------------------------------------------------------------------
+
+/**
+ * This class reads the operation codes and the arguments from the buffer of a display list.
+ */
+class DisplayListReader {
+public:
+    DisplayListReader(const std::vector<char> &ops) : m_ops(ops), m_pos(0) {}
+
+    bool HasOp() const { return (m_pos < m_ops.size()); }
+    char GetOp() { return m_ops[m_pos++]; }
+
+    int GetInt()
+    {
+        int value;
+        memcpy(&value, &m_ops[m_pos], sizeof(int));
+        m_pos += sizeof(int);
+        return value;
+    }
+
+    double GetDouble()
+    {
+        double value;
+        memcpy(&value, &m_ops[m_pos], sizeof(double));
+        m_pos += sizeof(double);
+        return value;
+    }
+
+    void *GetPointer()
+    {
+        void *pointer;
+        memcpy(&pointer, &m_ops[m_pos], sizeof(void *));
+        m_pos += sizeof(void *);
+        return pointer;
+    }
+
+    void GetPoints(std::vector<Point> &points)
+    {
+        int n = this->GetInt();
+        points.resize(n);
+        for (int i = 0; i < n; i++) {
+            points[i].x = this->GetInt();
+            points[i].y = this->GetInt();
+        }
+    }
+
+private:
+    const std::vector<char> &m_ops;
+    size_t m_pos;
+};
+
+//----------------------------------------------------------------------------
+// DisplayListWriter
+//----------------------------------------------------------------------------
+
+/**
+ * This class appends the exported operation codes and arguments to a buffer.
+ */
+class DisplayListWriter {
+public:
+    DisplayListWriter(std::vector<char> &buffer) : m_buffer(buffer) {}
+
+    void AddChar(char value) { m_buffer.push_back(value); }
+
+    void AddInt(int value) { this->AddBytes(&value, sizeof(int)); }
+
+    void AddDouble(double value) { this->AddBytes(&value, sizeof(double)); }
+
+    void AddString(const std::string &string)
+    {
+        this->AddInt((int)string.size());
+        m_buffer.insert(m_buffer.end(), string.begin(), string.end());
+    }
+
+private:
+    void AddBytes(const void *data, size_t size)
+    {
+        size_t pos = m_buffer.size();
+        m_buffer.resize(pos + size);
+        memcpy(&m_buffer[pos], data, size);
+    }
+
+    std::vector<char> &m_buffer;
+};
+
+//----------------------------------------------------------------------------
+// DisplayListDeviceContext
+//----------------------------------------------------------------------------
+
+DisplayListDeviceContext::DisplayListDeviceContext() : DeviceContext()
+{
+    this->Reset();
+}
+
+DisplayListDeviceContext::~DisplayListDeviceContext()
+{
+}
+
+void DisplayListDeviceContext::Reset()
+{
+    m_origin = Point(0, 0);
+
+    m_penStack = std::stack<Pen>();
+    m_brushStack = std::stack<Brush>();
+    m_fontStack = std::stack<FontInfo *>();
+    SetBrush(AxBLACK, AxSOLID);
+    SetPen(AxBLACK, 1, AxSOLID);
+
+    m_isDeactivatedX = false;
+    m_isDeactivatedY = false;
+
+    // the buffers keep their capacity for the next page
+    m_ops.clear();
+    m_strings.clear();
+    m_wstrings.clear();
+    m_fonts.clear();
+
+    // invalid values for the pen and the brush to be recorded with the first operation - there is no font yet
+    m_recordedPen = Pen(-1, -1, 1.0);
+    m_recordedBrush = Brush(-1, 1.0);
+    m_recordedFont = -1;
+    m_recordedDeactivatedX = false;
+    m_recordedDeactivatedY = false;
+}
+
+void DisplayListDeviceContext::Replay(DeviceContext *dc) const
+{
+    assert(dc);
+
+    // the fonts pushed to the device context have to be kept until the end
+    std::vector<FontInfo> fonts = m_fonts;
+    bool penSet = false;
+    bool brushSet = false;
+    bool fontSet = false;
+    bool deactivated = false;
+
+    std::vector<Point> points;
+    DisplayListReader reader(m_ops);
+    while (reader.HasOp()) {
+        char op = reader.GetOp();
+        switch (op) {
+            case (OP_SET_PEN): {
+                int colour = reader.GetInt();
+                int width = reader.GetInt();
+                int opacity = reader.GetInt();
+                if (penSet) dc->ResetPen();
+                dc->SetPen(colour, width, opacity);
+                penSet = true;
+                break;
+            }
+            case (OP_SET_BRUSH): {
+                int colour = reader.GetInt();
+                int opacity = reader.GetInt();
+                if (brushSet) dc->ResetBrush();
+                dc->SetBrush(colour, opacity);
+                brushSet = true;
+                break;
+            }
+            case (OP_SET_FONT): {
+                int font = reader.GetInt();
+                if (fontSet) dc->ResetFont();
+                fontSet = (font >= 0);
+                if (fontSet) dc->SetFont(&fonts.at(font));
+                break;
+            }
+            case (OP_SET_ACTIVATION): {
+                int deactivatedX = reader.GetInt();
+                int deactivatedY = reader.GetInt();
+                if (deactivated) dc->ReactivateGraphic();
+                if (deactivatedX && deactivatedY)
+                    dc->DeactivateGraphic();
+                else if (deactivatedX)
+                    dc->DeactivateGraphicX();
+                else if (deactivatedY)
+                    dc->DeactivateGraphicY();
+                deactivated = (deactivatedX || deactivatedY);
+                break;
+            }
+            case (OP_SET_BACKGROUND): {
+                int colour = reader.GetInt();
+                int style = reader.GetInt();
+                dc->SetBackground(colour, style);
+                break;
+            }
+            case (OP_SET_BACKGROUND_MODE): dc->SetBackgroundMode(reader.GetInt()); break;
+            case (OP_SET_TEXT_BACKGROUND): dc->SetTextBackground(reader.GetInt()); break;
+            case (OP_SET_LOGICAL_ORIGIN): {
+                int x = reader.GetInt();
+                int y = reader.GetInt();
+                dc->SetLogicalOrigin(x, y);
+                break;
+            }
+            case (OP_COMPLEX_BEZIER_PATH): {
+                reader.GetPoints(points);
+                assert(points.size() == 8);
+                dc->DrawComplexBezierPath(&points[0], &points[4]);
+                break;
+            }
+            case (OP_CIRCLE): {
+                int x = reader.GetInt();
+                int y = reader.GetInt();
+                int radius = reader.GetInt();
+                dc->DrawCircle(x, y, radius);
+                break;
+            }
+            case (OP_ELLIPSE): {
+                int x = reader.GetInt();
+                int y = reader.GetInt();
+                int width = reader.GetInt();
+                int height = reader.GetInt();
+                dc->DrawEllipse(x, y, width, height);
+                break;
+            }
+            case (OP_ELLIPTIC_ARC): {
+                int x = reader.GetInt();
+                int y = reader.GetInt();
+                int width = reader.GetInt();
+                int height = reader.GetInt();
+                double start = reader.GetDouble();
+                double end = reader.GetDouble();
+                dc->DrawEllipticArc(x, y, width, height, start, end);
+                break;
+            }
+            case (OP_LINE): {
+                int x1 = reader.GetInt();
+                int y1 = reader.GetInt();
+                int x2 = reader.GetInt();
+                int y2 = reader.GetInt();
+                dc->DrawLine(x1, y1, x2, y2);
+                break;
+            }
+            case (OP_POLYGON): {
+                reader.GetPoints(points);
+                int xoffset = reader.GetInt();
+                int yoffset = reader.GetInt();
+                int fillStyle = reader.GetInt();
+                dc->DrawPolygon((int)points.size(), points.empty() ? NULL : &points[0], xoffset, yoffset, fillStyle);
+                break;
+            }
+            case (OP_RECTANGLE): {
+                int x = reader.GetInt();
+                int y = reader.GetInt();
+                int width = reader.GetInt();
+                int height = reader.GetInt();
+                dc->DrawRectangle(x, y, width, height);
+                break;
+            }
+            case (OP_ROTATED_TEXT): {
+                const std::string &text = m_strings.at(reader.GetInt());
+                int x = reader.GetInt();
+                int y = reader.GetInt();
+                double angle = reader.GetDouble();
+                dc->DrawRotatedText(text, x, y, angle);
+                break;
+            }
+            case (OP_ROUNDED_RECTANGLE): {
+                int x = reader.GetInt();
+                int y = reader.GetInt();
+                int width = reader.GetInt();
+                int height = reader.GetInt();
+                double radius = reader.GetDouble();
+                dc->DrawRoundedRectangle(x, y, width, height, radius);
+                break;
+            }
+            case (OP_TEXT): {
+                const std::string &text = m_strings.at(reader.GetInt());
+                const std::wstring &wtext = m_wstrings.at(reader.GetInt());
+                dc->DrawText(text, wtext);
+                break;
+            }
+            case (OP_MUSIC_TEXT): {
+                const std::wstring &text = m_wstrings.at(reader.GetInt());
+                int x = reader.GetInt();
+                int y = reader.GetInt();
+                dc->DrawMusicText(text, x, y);
+                break;
+            }
+            case (OP_SPLINE): {
+                reader.GetPoints(points);
+                dc->DrawSpline((int)points.size(), points.empty() ? NULL : &points[0]);
+                break;
+            }
+            case (OP_BACKGROUND_IMAGE): {
+                int x = reader.GetInt();
+                int y = reader.GetInt();
+                dc->DrawBackgroundImage(x, y);
+                break;
+            }
+            case (OP_PLACEHOLDER): {
+                int x = reader.GetInt();
+                int y = reader.GetInt();
+                dc->DrawPlaceholder(x, y);
+                break;
+            }
+            case (OP_START_TEXT): {
+                int x = reader.GetInt();
+                int y = reader.GetInt();
+                char alignment = (char)reader.GetInt();
+                dc->StartText(x, y, alignment);
+                break;
+            }
+            case (OP_END_TEXT): dc->EndText(); break;
+            case (OP_MOVE_TEXT_TO): {
+                int x = reader.GetInt();
+                int y = reader.GetInt();
+                dc->MoveTextTo(x, y);
+                break;
+            }
+            case (OP_START_GRAPHIC): {
+                Object *object = static_cast<Object *>(reader.GetPointer());
+                const std::string &gClass = m_strings.at(reader.GetInt());
+                const std::string &gId = m_strings.at(reader.GetInt());
+                dc->StartGraphic(object, gClass, gId);
+                break;
+            }
+            case (OP_END_GRAPHIC): {
+                Object *object = static_cast<Object *>(reader.GetPointer());
+                View *view = static_cast<View *>(reader.GetPointer());
+                dc->EndGraphic(object, view);
+                break;
+            }
+            case (OP_RESUME_GRAPHIC): {
+                Object *object = static_cast<Object *>(reader.GetPointer());
+                const std::string &gId = m_strings.at(reader.GetInt());
+                dc->ResumeGraphic(object, gId);
+                break;
+            }
+            case (OP_END_RESUMED_GRAPHIC): {
+                Object *object = static_cast<Object *>(reader.GetPointer());
+                View *view = static_cast<View *>(reader.GetPointer());
+                dc->EndResumedGraphic(object, view);
+                break;
+            }
+            case (OP_START_TEXT_GRAPHIC): {
+                Object *object = static_cast<Object *>(reader.GetPointer());
+                const std::string &gClass = m_strings.at(reader.GetInt());
+                const std::string &gId = m_strings.at(reader.GetInt());
+                dc->StartTextGraphic(object, gClass, gId);
+                break;
+            }
+            case (OP_END_TEXT_GRAPHIC): {
+                Object *object = static_cast<Object *>(reader.GetPointer());
+                View *view = static_cast<View *>(reader.GetPointer());
+                dc->EndTextGraphic(object, view);
+                break;
+            }
+            case (OP_START_PAGE): dc->StartPage(); break;
+            case (OP_END_PAGE): dc->EndPage(); break;
+            default: LogError("Unknown display list operation %d", op); return;
+        }
+    }
+
+    // leave the stacks of the device context as they were
+    if (penSet) dc->ResetPen();
+    if (brushSet) dc->ResetBrush();
+    if (fontSet) dc->ResetFont();
+    if (deactivated) dc->ReactivateGraphic();
+}
+
+void DisplayListDeviceContext::Export(std::vector<char> &buffer) const
+{
+    DisplayListWriter writer(buffer);
+    DisplayListReader reader(m_ops);
+    std::vector<Point> points;
+    while (reader.HasOp()) {
+        char op = reader.GetOp();
+        if ((op < OP_SET_PEN) || (op > OP_END_PAGE)) {
+            LogError("Unknown display list operation %d", op);
+            return;
+        }
+        writer.AddChar(op);
+        for (const char *arg = displayListArgs[(int)op]; *arg; arg++) {
+            switch (*arg) {
+                case 'i': writer.AddInt(reader.GetInt()); break;
+                case 'd': writer.AddDouble(reader.GetDouble()); break;
+                case 'p': {
+                    reader.GetPoints(points);
+                    writer.AddInt((int)points.size());
+                    std::vector<Point>::iterator it;
+                    for (it = points.begin(); it != points.end(); ++it) {
+                        writer.AddInt(it->x);
+                        writer.AddInt(it->y);
+                    }
+                    break;
+                }
+                case 's': writer.AddString(m_strings.at(reader.GetInt())); break;
+                case 'w': writer.AddString(UTF16to8(m_wstrings.at(reader.GetInt()))); break;
+                case 't': {
+                    const std::string &text = m_strings.at(reader.GetInt());
+                    const std::wstring &wtext = m_wstrings.at(reader.GetInt());
+                    writer.AddString(text.empty() ? UTF16to8(wtext) : text);
+                    break;
+                }
+                case 'f': {
+                    int font = reader.GetInt();
+                    if (font < 0) {
+                        writer.AddInt(0);
+                        writer.AddInt(FONTSTYLE_NONE);
+                        writer.AddInt(FONTWEIGHT_NONE);
+                        writer.AddString("");
+                        break;
+                    }
+                    FontInfo fontInfo = m_fonts.at(font);
+                    writer.AddInt(fontInfo.GetPointSize());
+                    writer.AddInt(fontInfo.GetStyle());
+                    writer.AddInt(fontInfo.GetWeight());
+                    writer.AddString(fontInfo.GetFaceName());
+                    break;
+                }
+                case 'o': reader.GetPointer(); break;
+            }
+        }
+    }
+}
+
+void DisplayListDeviceContext::GetMusicTexts(std::vector<std::pair<std::wstring, int> > &texts) const
+{
+    DisplayListReader reader(m_ops);
+    std::vector<Point> points;
+    int pointSize = 0;
+    while (reader.HasOp()) {
+        char op = reader.GetOp();
+        if ((op < OP_SET_PEN) || (op > OP_END_PAGE)) {
+            LogError("Unknown display list operation %d", op);
+            return;
+        }
+        // the arguments of the other operations are skipped
+        for (const char *arg = displayListArgs[(int)op]; *arg; arg++) {
+            switch (*arg) {
+                case 'i': reader.GetInt(); break;
+                case 'd': reader.GetDouble(); break;
+                case 'p': reader.GetPoints(points); break;
+                case 's': reader.GetInt(); break;
+                case 'w': {
+                    const std::wstring &text = m_wstrings.at(reader.GetInt());
+                    if (op == OP_MUSIC_TEXT) texts.push_back(std::make_pair(text, pointSize));
+                    break;
+                }
+                case 't':
+                    reader.GetInt();
+                    reader.GetInt();
+                    break;
+                case 'f': {
+                    int font = reader.GetInt();
+                    pointSize = 0;
+                    if (font >= 0) {
+                        FontInfo fontInfo = m_fonts.at(font);
+                        pointSize = fontInfo.GetPointSize();
+                    }
+                    break;
+                }
+                case 'o': reader.GetPointer(); break;
+            }
+        }
+    }
+}
+
+void DisplayListDeviceContext::AddOp(DisplayListOp op)
+{
+    m_ops.push_back((char)op);
+}
+
+void DisplayListDeviceContext::AddInt(int value)
+{
+    size_t pos = m_ops.size();
+    m_ops.resize(pos + sizeof(int));
+    memcpy(&m_ops[pos], &value, sizeof(int));
+}
+
+void DisplayListDeviceContext::AddDouble(double value)
+{
+    size_t pos = m_ops.size();
+    m_ops.resize(pos + sizeof(double));
+    memcpy(&m_ops[pos], &value, sizeof(double));
+}
+
+void DisplayListDeviceContext::AddPointer(const void *pointer)
+{
+    size_t pos = m_ops.size();
+    m_ops.resize(pos + sizeof(void *));
+    memcpy(&m_ops[pos], &pointer, sizeof(void *));
+}
+
+void DisplayListDeviceContext::AddPoints(int n, const Point points[])
+{
+    this->AddInt(n);
+    for (int i = 0; i < n; i++) {
+        this->AddInt(points[i].x);
+        this->AddInt(points[i].y);
+    }
+}
+
+void DisplayListDeviceContext::AddString(const std::string &string)
+{
+    this->AddInt((int)m_strings.size());
+    m_strings.push_back(string);
+}
+
+void DisplayListDeviceContext::AddWString(const std::wstring &wstring)
+{
+    this->AddInt((int)m_wstrings.size());
+    m_wstrings.push_back(wstring);
+}
+
+int DisplayListDeviceContext::GetFontIndex(FontInfo *font)
+{
+    // most of the time this is the font recorded last
+    if ((m_recordedFont >= 0) && IsSameFont(m_fonts.at(m_recordedFont), *font)) return m_recordedFont;
+
+    int i;
+    for (i = 0; i < (int)m_fonts.size(); i++) {
+        if (IsSameFont(m_fonts.at(i), *font)) return i;
+    }
+    m_fonts.push_back(*font);
+    return i;
+}
+
+void DisplayListDeviceContext::AddState()
+{
+    const Pen &pen = m_penStack.top();
+    if ((pen.GetColour() != m_recordedPen.GetColour()) || (pen.GetWidth() != m_recordedPen.GetWidth())
+        || (pen.GetOpacity() != m_recordedPen.GetOpacity())) {
+        this->AddOp(OP_SET_PEN);
+        this->AddInt(pen.GetColour());
+        this->AddInt(pen.GetWidth());
+        this->AddInt((pen.GetOpacity() == 0.0) ? AxTRANSPARENT : AxSOLID);
+        m_recordedPen = pen;
+    }
+
+    const Brush &brush = m_brushStack.top();
+    if ((brush.GetColour() != m_recordedBrush.GetColour()) || (brush.GetOpacity() != m_recordedBrush.GetOpacity())) {
+        this->AddOp(OP_SET_BRUSH);
+        this->AddInt(brush.GetColour());
+        this->AddInt((brush.GetOpacity() == 0.0) ? AxTRANSPARENT : AxSOLID);
+        m_recordedBrush = brush;
+    }
+
+    int font = (m_fontStack.empty()) ? -1 : this->GetFontIndex(m_fontStack.top());
+    if (font != m_recordedFont) {
+        this->AddOp(OP_SET_FONT);
+        this->AddInt(font);
+        m_recordedFont = font;
+    }
+
+    if ((m_isDeactivatedX != m_recordedDeactivatedX) || (m_isDeactivatedY != m_recordedDeactivatedY)) {
+        this->AddOp(OP_SET_ACTIVATION);
+        this->AddInt(m_isDeactivatedX);
+        this->AddInt(m_isDeactivatedY);
+        m_recordedDeactivatedX = m_isDeactivatedX;
+        m_recordedDeactivatedY = m_isDeactivatedY;
+    }
+}
+
+void DisplayListDeviceContext::SetBackground(int colour, int style)
+{
+    this->AddOp(OP_SET_BACKGROUND);
+    this->AddInt(colour);
+    this->AddInt(style);
+}
+
+void DisplayListDeviceContext::SetBackgroundMode(int mode)
+{
+    this->AddOp(OP_SET_BACKGROUND_MODE);
+    this->AddInt(mode);
+}
+
+void DisplayListDeviceContext::SetTextForeground(int colour)
+{
+    // like in the SVG, the brush colour is used for text - it is recorded with the next operation
+    m_brushStack.top().SetColour(colour);
+}
+
+void DisplayListDeviceContext::SetTextBackground(int colour)
+{
+    this->AddOp(OP_SET_TEXT_BACKGROUND);
+    this->AddInt(colour);
+}
+
+void DisplayListDeviceContext::SetLogicalOrigin(int x, int y)
+{
+    m_origin = Point(x, y);
+    this->AddOp(OP_SET_LOGICAL_ORIGIN);
+    this->AddInt(x);
+    this->AddInt(y);
+}
+
+Point DisplayListDeviceContext::GetLogicalOrigin()
+{
+    return m_origin;
+}
+
+void DisplayListDeviceContext::DrawComplexBezierPath(Point bezier1[4], Point bezier2[4])
+{
+    this->AddState();
+    this->AddOp(OP_COMPLEX_BEZIER_PATH);
+    this->AddInt(8);
+    for (int i = 0; i < 4; i++) {
+        this->AddInt(bezier1[i].x);
+        this->AddInt(bezier1[i].y);
+    }
+    for (int i = 0; i < 4; i++) {
+        this->AddInt(bezier2[i].x);
+        this->AddInt(bezier2[i].y);
+    }
+}
+
+void DisplayListDeviceContext::DrawCircle(int x, int y, int radius)
+{
+    this->AddState();
+    this->AddOp(OP_CIRCLE);
+    this->AddInt(x);
+    this->AddInt(y);
+    this->AddInt(radius);
+}
+
+void DisplayListDeviceContext::DrawEllipse(int x, int y, int width, int height)
+{
+    this->AddState();
+    this->AddOp(OP_ELLIPSE);
+    this->AddInt(x);
+    this->AddInt(y);
+    this->AddInt(width);
+    this->AddInt(height);
+}
+
+void DisplayListDeviceContext::DrawEllipticArc(int x, int y, int width, int height, double start, double end)
+{
+    this->AddState();
+    this->AddOp(OP_ELLIPTIC_ARC);
+    this->AddInt(x);
+    this->AddInt(y);
+    this->AddInt(width);
+    this->AddInt(height);
+    this->AddDouble(start);
+    this->AddDouble(end);
+}
+
+void DisplayListDeviceContext::DrawLine(int x1, int y1, int x2, int y2)
+{
+    this->AddState();
+    this->AddOp(OP_LINE);
+    this->AddInt(x1);
+    this->AddInt(y1);
+    this->AddInt(x2);
+    this->AddInt(y2);
+}
+
+void DisplayListDeviceContext::DrawPolygon(int n, Point points[], int xoffset, int yoffset, int fill_style)
+{
+    this->AddState();
+    this->AddOp(OP_POLYGON);
+    this->AddPoints(n, points);
+    this->AddInt(xoffset);
+    this->AddInt(yoffset);
+    this->AddInt(fill_style);
+}
+
+void DisplayListDeviceContext::DrawRectangle(int x, int y, int width, int height)
+{
+    this->AddState();
+    this->AddOp(OP_RECTANGLE);
+    this->AddInt(x);
+    this->AddInt(y);
+    this->AddInt(width);
+    this->AddInt(height);
+}
+
+void DisplayListDeviceContext::DrawRotatedText(const std::string &text, int x, int y, double angle)
+{
+    this->AddState();
+    this->AddOp(OP_ROTATED_TEXT);
+    this->AddString(text);
+    this->AddInt(x);
+    this->AddInt(y);
+    this->AddDouble(angle);
+}
+
+void DisplayListDeviceContext::DrawRoundedRectangle(int x, int y, int width, int height, double radius)
+{
+    this->AddState();
+    this->AddOp(OP_ROUNDED_RECTANGLE);
+    this->AddInt(x);
+    this->AddInt(y);
+    this->AddInt(width);
+    this->AddInt(height);
+    this->AddDouble(radius);
+}
+
+void DisplayListDeviceContext::DrawText(const std::string &text, const std::wstring &wtext)
+{
+    this->AddState();
+    this->AddOp(OP_TEXT);
+    this->AddString(text);
+    this->AddWString(wtext);
+}
+
+void DisplayListDeviceContext::DrawMusicText(const std::wstring &text, int x, int y)
+{
+    this->AddState();
+    this->AddOp(OP_MUSIC_TEXT);
+    this->AddWString(text);
+    this->AddInt(x);
+    this->AddInt(y);
+}
+
+void DisplayListDeviceContext::DrawSpline(int n, Point points[])
+{
+    this->AddState();
+    this->AddOp(OP_SPLINE);
+    this->AddPoints(n, points);
+}
+
+void DisplayListDeviceContext::DrawBackgroundImage(int x, int y)
+{
+    this->AddOp(OP_BACKGROUND_IMAGE);
+    this->AddInt(x);
+    this->AddInt(y);
+}
+
+void DisplayListDeviceContext::DrawPlaceholder(int x, int y)
+{
+    this->AddState();
+    this->AddOp(OP_PLACEHOLDER);
+    this->AddInt(x);
+    this->AddInt(y);
+}
+
+void DisplayListDeviceContext::StartText(int x, int y, char alignement)
+{
+    this->AddState();
+    this->AddOp(OP_START_TEXT);
+    this->AddInt(x);
+    this->AddInt(y);
+    this->AddInt(alignement);
+}
+
+void DisplayListDeviceContext::EndText()
+{
+    this->AddState();
+    this->AddOp(OP_END_TEXT);
+}
+
+void DisplayListDeviceContext::MoveTextTo(int x, int y)
+{
+    this->AddState();
+    this->AddOp(OP_MOVE_TEXT_TO);
+    this->AddInt(x);
+    this->AddInt(y);
+}
+
+void DisplayListDeviceContext::StartGraphic(Object *object, const std::string &gClass, const std::string &gId)
+{
+    this->AddState();
+    this->AddOp(OP_START_GRAPHIC);
+    this->AddPointer(object);
+    this->AddString(gClass);
+    this->AddString(gId);
+}
+
+void DisplayListDeviceContext::EndGraphic(Object *object, View *view)
+{
+    this->AddState();
+    this->AddOp(OP_END_GRAPHIC);
+    this->AddPointer(object);
+    this->AddPointer(view);
+}
+
+void DisplayListDeviceContext::ResumeGraphic(Object *object, const std::string &gId)
+{
+    this->AddState();
+    this->AddOp(OP_RESUME_GRAPHIC);
+    this->AddPointer(object);
+    this->AddString(gId);
+}
+
+void DisplayListDeviceContext::EndResumedGraphic(Object *object, View *view)
+{
+    this->AddState();
+    this->AddOp(OP_END_RESUMED_GRAPHIC);
+    this->AddPointer(object);
+    this->AddPointer(view);
+}
+
+void DisplayListDeviceContext::StartTextGraphic(Object *object, const std::string &gClass, const std::string &gId)
+{
+    this->AddState();
+    this->AddOp(OP_START_TEXT_GRAPHIC);
+    this->AddPointer(object);
+    this->AddString(gClass);
+    this->AddString(gId);
+}
+
+void DisplayListDeviceContext::EndTextGraphic(Object *object, View *view)
+{
+    this->AddState();
+    this->AddOp(OP_END_TEXT_GRAPHIC);
+    this->AddPointer(object);
+    this->AddPointer(view);
+}
+
+void DisplayListDeviceContext::StartPage()
+{
+    this->AddState();
+    this->AddOp(OP_START_PAGE);
+}
+
+void DisplayListDeviceContext::EndPage()
+{
+    this->AddState();
+    this->AddOp(OP_END_PAGE);
+}
+
+} // namespace vrv
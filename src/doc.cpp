@@ -20,6 +20,7 @@
 #include "glyph.h"
 #include "keysig.h"
 #include "layer.h"
+#include "measure.h"
 #include "mensur.h"
 #include "metersig.h"
 #include "mrest.h"
@@ -49,6 +50,8 @@ Doc::Doc() : Object("doc-")
 {
     m_style = new Style();
     Reset(Raw);
+    // Not done in Reset because the import resets the document while a load can be cancelled
+    ResetProgress();
 }
 
 Doc::~Doc()
@@ -79,6 +82,12 @@ void Doc::Reset(DocType type)
     m_currentScoreDefDone = false;
     m_drawingPreparationDone = false;
     m_midiExportDone = false;
+    m_castOffPending = false;
+    m_castOffCarriedPage = false;
+    m_castOffScoreDefWidth = 0;
+    m_castOffChunkSize = 0;
+    m_castOffLongestDur = DUR_4;
+    m_castOffMeasureXRel = 0;
 
     m_scoreDef.Reset();
 
@@ -87,6 +96,14 @@ void Doc::Reset(DocType type)
     m_drawingLyricFont.SetFaceName("Times");
 }
 
+void Doc::ResetProgress()
+{
+    m_cancelRequested = false;
+    m_progressMeasureCount = 0;
+    m_progressMeasuresDone = 0;
+    m_progressSystemsDone = 0;
+}
+
 void Doc::AddPage(Page *page)
 {
     page->SetParent(this);
@@ -204,6 +221,7 @@ void Doc::PrepareDrawing()
         fillList = false;
         this->Process(&prepareTimeSpanning, &params);
     }
+    if (m_cancelRequested) return;
 
     // Now try to match the @tstamp and @tstamp2 attributes.
     params.clear();
@@ -234,6 +252,7 @@ void Doc::PrepareDrawing()
     // LogElapsedTimeStart();
     Functor prepareProcessingLists(&Object::PrepareProcessingLists);
     this->Process(&prepareProcessingLists, &params);
+    if (m_cancelRequested) return;
 
     // The tree is used to process each staff/layer/verse separately
     // For this, we use an array of AttCommmonNComparison that looks for each object if it is of the type
@@ -277,6 +296,7 @@ void Doc::PrepareDrawing()
             }
         }
     }
+    if (m_cancelRequested) return;
 
     Note *currentNote = NULL;
     for (staves = layerTree.child.begin(); staves != layerTree.child.end(); ++staves) {
@@ -328,6 +348,8 @@ void Doc::PrepareDrawing()
         }
     }
 
+    if (m_cancelRequested) return;
+
     // Once <slur>, <ties> and @ties are matched but also syl connectors, we need to set them as running
     // TimeSpanningInterface to each staff they are extended. This does not need to be done staff by staff because we
     // can just check the staff->GetN to see where we are (see Staff::FillStaffCurrentTimeSpanning)
@@ -425,56 +447,229 @@ void Doc::SetCurrentScoreDef(bool force)
     m_currentScoreDefDone = true;
 }
 
-void Doc::CastOff()
+void Doc::CastOff(bool lazy)
 {
     this->SetCurrentScoreDef();
 
-    Page *contentPage = this->SetDrawingPage(0);
+    // The content page stays the last page of the document until everything is cast off
+    assert(this->GetChildCount() == 1);
+
+    m_castOffPending = true;
+    m_castOffCarriedPage = false;
+    m_castOffScoreDefWidth = 0;
+    m_castOffChunkSize = 16;
+    m_castOffMeasureXRel = 0;
+    // The spacing of every chunk has to be based on the longest duration of the entire content
+    Page *contentPage = dynamic_cast<Page *>(this->GetChild(0));
     assert(contentPage);
-    contentPage->LayOutHorizontally();
+    m_castOffLongestDur = contentPage->GetLongestActualDur();
+    System *contentSystem = dynamic_cast<System *>(contentPage->GetChild(0));
+    assert(contentSystem);
+    m_progressMeasureCount = contentSystem->GetChildCount(MEASURE);
+    m_progressMeasuresDone = 0;
+    m_progressSystemsDone = 0;
+
+    if (lazy) {
+        this->CastOffUntilPage(0);
+    }
+    else {
+        this->CastOffUntilPage(-1);
+    }
+}
 
-    System *contentSystem = dynamic_cast<System *>(contentPage->DetachChild(0));
+void Doc::CastOffUntilPage(int pageIdx)
+{
+    while (m_castOffPending && !m_cancelRequested) {
+        // The pages before the carried page and the content page are final
+        int finalPages = this->GetChildCount() - (m_castOffCarriedPage ? 2 : 1);
+        if ((pageIdx >= 0) && (finalPages > pageIdx)) break;
+        if (pageIdx < 0) {
+            this->CastOffChunk(-1);
+            continue;
+        }
+        this->CastOffChunk(m_castOffChunkSize);
+        // Each chunk resets the scoreDef of the entire document, so take more at once next time
+        // for the cumulated time to remain proportional to the size of the document
+        m_castOffChunkSize *= 2;
+    }
+}
+
+void Doc::CastOffChunk(int measureCount)
+{
+    assert(m_castOffPending);
+
+    // Detach the content page and the carried page (if any)
+    Page *contentPage = dynamic_cast<Page *>(this->DetachChild(this->GetChildCount() - 1));
+    assert(contentPage);
+    System *contentSystem = dynamic_cast<System *>(contentPage->GetChild(0));
     assert(contentSystem);
+    Page *castOffPage = NULL;
+    if (m_castOffCarriedPage) {
+        castOffPage = dynamic_cast<Page *>(this->DetachChild(this->GetChildCount() - 1));
+        assert(castOffPage);
+    }
+    else {
+        castOffPage = new Page();
+    }
+    bool firstChunk = (this->GetChildCount() == 0) && !m_castOffCarriedPage;
+    int firstPageIdx = this->GetChildCount();
+
+    // Move the content of the chunk to its own system and page
+    int i;
+    Page *chunkPage = new Page();
+    System *chunkSystem = NULL;
+    if ((measureCount < 0) || (measureCount >= contentSystem->GetChildCount())) {
+        // Everything remaining fits in the chunk - simply swap the content system
+        chunkSystem = dynamic_cast<System *>(contentPage->DetachChild(0));
+        contentSystem = new System();
+        contentPage->AddSystem(contentSystem);
+    }
+    else {
+        chunkSystem = new System();
+        for (i = 0; i < measureCount; i++) {
+            Object *child = contentSystem->DetachChild(0);
+            child->SetParent(chunkSystem);
+            chunkSystem->InsertChild(child, chunkSystem->GetChildCount());
+        }
+    }
+    chunkPage->AddSystem(chunkSystem);
+    // The scoreDef of the content page has not been changed since the initial Doc::SetCurrentScoreDef
+    chunkPage->m_drawingScoreDef = contentPage->m_drawingScoreDef;
+    this->AddPage(chunkPage);
+    this->SetDrawingPage(firstPageIdx);
+    chunkPage->LayOutHorizontally(m_castOffLongestDur);
+    this->DetachChild(firstPageIdx);
+    this->ResetDrawingPage();
+
+    // Move the measures to the position they would have with the entire content laid out at once
+    // because the vertical layout of the systems is done with these positions
+    for (i = 0; i < chunkSystem->GetChildCount(); i++) {
+        if (chunkSystem->GetChild(i)->Is() != MEASURE) continue;
+        Measure *measure = dynamic_cast<Measure *>(chunkSystem->GetChild(i));
+        assert(measure);
+        measure->m_drawingXRel += m_castOffMeasureXRel;
+    }
+
+    int shift = 0;
+    int abbrLabelsWidth = chunkSystem->GetDrawingAbbrLabelsWidth();
+    if (firstChunk) {
+        shift = -chunkSystem->GetDrawingLabelsWidth();
+        // The width of the initial scoreDef is stored in the page scoreDef
+        m_castOffScoreDefWidth = chunkPage->m_drawingScoreDef.GetDrawingWidth() + abbrLabelsWidth;
+    }
+    else {
+        // Other chunks start with the first measure of a system
+        Measure *firstMeasure = dynamic_cast<Measure *>(chunkSystem->FindChildByType(MEASURE, 1));
+        if (firstMeasure) shift = firstMeasure->m_drawingXRel;
+    }
+    chunkPage->DetachChild(0);
+    delete chunkPage;
 
     System *currentSystem = new System();
-    contentPage->AddSystem(currentSystem);
-    int shift = -contentSystem->GetDrawingLabelsWidth();
+    int firstSystemIdx = castOffPage->GetChildCount();
+    castOffPage->AddSystem(currentSystem);
     int systemFullWidth = this->m_drawingPageWidth - this->m_drawingPageLeftMar - this->m_drawingPageRightMar
         - currentSystem->m_systemLeftMar - currentSystem->m_systemRightMar;
-    // The width of the initial scoreDef is stored in the page scoreDef
-    int scoreDefWidth = contentPage->m_drawingScoreDef.GetDrawingWidth() + contentSystem->GetDrawingAbbrLabelsWidth();
+    int scoreDefWidth = m_castOffScoreDefWidth;
     ArrayPtrVoid params;
-    params.push_back(contentSystem);
-    params.push_back(contentPage);
+    params.push_back(chunkSystem);
+    params.push_back(castOffPage);
     params.push_back(&currentSystem);
     params.push_back(&shift);
     params.push_back(&systemFullWidth);
     params.push_back(&scoreDefWidth);
     Functor castOffSystems(&Object::CastOffSystems);
-    contentSystem->Process(&castOffSystems, &params);
-    delete contentSystem;
+    chunkSystem->Process(&castOffSystems, &params);
+    delete chunkSystem;
+
+    bool done = (contentSystem->GetChildCount() == 0);
+    if (!done) {
+        // The last system is not complete - move its content back to the content system
+        System *lastSystem = dynamic_cast<System *>(castOffPage->DetachChild(castOffPage->GetChildCount() - 1));
+        assert(lastSystem);
+        // The next chunk starts with the first measure of this system
+        Measure *firstMeasure = dynamic_cast<Measure *>(lastSystem->FindChildByType(MEASURE, 1));
+        if (firstMeasure) m_castOffMeasureXRel = firstMeasure->m_drawingXRel;
+        while (lastSystem->GetChildCount() > 0) {
+            Object *child = lastSystem->DetachChild(lastSystem->GetChildCount() - 1);
+            child->SetParent(contentSystem);
+            contentSystem->InsertChild(child, 0);
+        }
+        delete lastSystem;
+        // Keep the width of the last scoreDef of the completed systems for the next chunk
+        for (i = castOffPage->GetChildCount() - 1; i >= firstSystemIdx; i--) {
+            ScoreDef *scoreDef
+                = dynamic_cast<ScoreDef *>(castOffPage->GetChild(i)->FindChildByType(SCOREDEF, 1, BACKWARD));
+            if (scoreDef) {
+                m_castOffScoreDefWidth = scoreDef->GetDrawingWidth() + abbrLabelsWidth;
+                break;
+            }
+        }
+    }
+
+    // Not even one system was completed with the chunk
+    if (castOffPage->GetChildCount() == 0) {
+        assert(!done);
+        delete castOffPage;
+        m_castOffCarriedPage = false;
+        this->AddPage(contentPage);
+        return;
+    }
 
     // Reset the scoreDef at the beginning of each system
+    // The content page is detached and keeps the values set by the initial Doc::SetCurrentScoreDef
+    this->AddPage(castOffPage);
     this->SetCurrentScoreDef(true);
-    contentPage->LayOutVertically();
+    this->SetDrawingPage(firstPageIdx);
+    castOffPage->LayOutVertically();
 
-    // Detach the contentPage
-    this->DetachChild(0);
-    assert(contentPage && !contentPage->m_parent);
+    // Detach the castOffPage
+    this->DetachChild(firstPageIdx);
+    this->ResetDrawingPage();
+    assert(castOffPage && !castOffPage->m_parent);
 
     Page *currentPage = new Page();
     this->AddPage(currentPage);
     shift = 0;
     int pageFullHeight = this->m_drawingPageHeight - this->m_drawingPageTopMar; // obviously we need a bottom margin
+    if (!firstChunk) {
+        // Other chunks start with the first system of a page
+        System *firstSystem = dynamic_cast<System *>(castOffPage->GetChild(0));
+        assert(firstSystem);
+        shift = firstSystem->m_drawingYRel - pageFullHeight;
+    }
     params.clear();
-    params.push_back(contentPage);
+    params.push_back(castOffPage);
     params.push_back(this);
     params.push_back(&currentPage);
     params.push_back(&shift);
     params.push_back(&pageFullHeight);
     Functor castOffPages(&Object::CastOffPages);
-    contentPage->Process(&castOffPages, &params);
-    delete contentPage;
+    castOffPage->Process(&castOffPages, &params);
+    delete castOffPage;
+
+    m_castOffCarriedPage = false;
+    if (!done) {
+        // The last page is not complete - keep its systems for the next chunk
+        Page *lastPage = dynamic_cast<Page *>(this->DetachChild(this->GetChildCount() - 1));
+        assert(lastPage);
+        castOffPage = new Page();
+        castOffPage->MoveChildren(lastPage);
+        delete lastPage;
+        m_castOffCarriedPage = (castOffPage->GetChildCount() > 0);
+    }
+
+    for (i = firstPageIdx; i < this->GetChildCount(); i++) {
+        m_progressSystemsDone += this->GetChild(i)->GetChildCount(SYSTEM);
+    }
+    m_progressMeasuresDone = m_progressMeasureCount - contentSystem->GetChildCount(MEASURE);
+
+    if (m_castOffCarriedPage) {
+        this->AddPage(castOffPage);
+    }
+    else if (!done) {
+        delete castOffPage;
+    }
 
     // LogDebug("Layout: %d pages", this->GetChildCount());
 
@@ -482,6 +677,14 @@ void Doc::CastOff()
     // because idx will still be 0 but contentPage is dead!
     this->ResetDrawingPage();
     this->SetCurrentScoreDef(true);
+
+    if (done) {
+        delete contentPage;
+        m_castOffPending = false;
+    }
+    else {
+        this->AddPage(contentPage);
+    }
 }
 
 void Doc::UnCastOff()
@@ -499,6 +702,8 @@ void Doc::UnCastOff()
     this->ClearChildren();
 
     this->AddPage(contentPage);
+    m_castOffPending = false;
+    m_castOffCarriedPage = false;
 
     // LogDebug("ContinousLayout: %d pages", this->GetChildCount());
 
@@ -33,23 +33,31 @@ DrawingListInterface::~DrawingListInterface()
 void DrawingListInterface::Reset()
 {
     m_drawingList.clear();
+    m_drawingListSorted = true;
 }
 
-void DrawingListInterface::AddToDrawingList( Object *object)
+void DrawingListInterface::AddToDrawingList(Object *object)
 {
+    // Sorting and removing duplicates is postponed to GetDrawingList because staves
+    // push all their time spanning elements and sorting on each addition is quadratic
     m_drawingList.push_back(object);
-    m_drawingList.sort();
-    m_drawingList.unique();
+    m_drawingListSorted = false;
 }
 
 ListOfObjects *DrawingListInterface::GetDrawingList()
 {
+    if (!m_drawingListSorted) {
+        m_drawingList.sort();
+        m_drawingList.unique();
+        m_drawingListSorted = true;
+    }
     return &m_drawingList;
 }
 
 void DrawingListInterface::ResetDrawingList()
 {
     m_drawingList.clear();
+    m_drawingListSorted = true;
 }
 
 //----------------------------------------------------------------------------
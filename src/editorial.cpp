@@ -9,6 +9,7 @@
 
 //----------------------------------------------------------------------------
 
+#include <algorithm>
 #include <assert.h>
 
 //----------------------------------------------------------------------------
@@ -227,6 +228,21 @@ void App::AddLemOrRdg(EditorialElement *child)
     Modify();
 }
 
+bool App::SelectLemOrRdg(EditorialElement *lemOrRdg)
+{
+    if (std::find(m_children.begin(), m_children.end(), lemOrRdg) == m_children.end()) {
+        return false;
+    }
+
+    ArrayOfObjects::iterator iter;
+    for (iter = m_children.begin(); iter != m_children.end(); ++iter) {
+        EditorialElement *child = dynamic_cast<EditorialElement *>(*iter);
+        assert(child);
+        child->m_visibility = (child == lemOrRdg) ? Visible : Hidden;
+    }
+    return true;
+}
+
 //----------------------------------------------------------------------------
 // Corr
 //----------------------------------------------------------------------------
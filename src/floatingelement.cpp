@@ -139,6 +139,7 @@ void FloatingPositioner::ResetPositioner()
     m_slurAngle = 0.0;
     m_slurThickness = 0;
     m_slurDir = curvature_CURVEDIR_NONE;
+    m_cachedSlurRevision = -1;
 }
 
 void FloatingPositioner::UpdateSlurPosition(
@@ -153,6 +154,32 @@ void FloatingPositioner::UpdateSlurPosition(
     m_slurDir = curveDir;
 }
 
+bool FloatingPositioner::GetCachedSlurCurve(
+    int layoutRevision, curvature_CURVEDIR curveDir, Point points[4], float *angle) const
+{
+    assert(angle);
+
+    if ((m_cachedSlurRevision != layoutRevision) || (m_cachedSlurDir != curveDir)) return false;
+    if ((m_cachedSlurEnds[0] != points[0]) || (m_cachedSlurEnds[1] != points[1])) return false;
+
+    int i;
+    for (i = 0; i < 4; i++) points[i] = m_cachedSlurPoints[i];
+    *angle = m_cachedSlurAngle;
+    return true;
+}
+
+void FloatingPositioner::SetCachedSlurCurve(
+    int layoutRevision, curvature_CURVEDIR curveDir, const Point ends[2], const Point points[4], float angle)
+{
+    m_cachedSlurRevision = layoutRevision;
+    m_cachedSlurDir = curveDir;
+    m_cachedSlurEnds[0] = ends[0];
+    m_cachedSlurEnds[1] = ends[1];
+    int i;
+    for (i = 0; i < 4; i++) m_cachedSlurPoints[i] = points[i];
+    m_cachedSlurAngle = angle;
+}
+
 void FloatingPositioner::SetDrawingYRel(int drawingYRel)
 {
     if (m_place == STAFFREL_above) {
@@ -9,7 +9,20 @@
 
 //----------------------------------------------------------------------------
 
+#include <algorithm>
 #include <assert.h>
+#include <ctype.h>
+#include <stdint.h>
+#include <string.h>
+
+#if !defined(_WIN32) && !defined(USE_EMSCRIPTEN)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+//----------------------------------------------------------------------------
+
+#include "vrv.h"
 
 namespace vrv {
 
@@ -59,6 +72,7 @@ void FileInputStream::Init()
     m_hasLayoutInformation = false;
     m_hasMeasureWithinEditMarkup = false;
     m_ignoreLayoutInformation = false;
+    m_bufferFileMapping = false;
 }
 
 FileInputStream::~FileInputStream()
@@ -68,4 +82,148 @@ FileInputStream::~FileInputStream()
     }
 }
 
+// Return the position of the string in the data from pos or length if not found
+static size_t FindInData(const char *data, size_t length, size_t pos, const char *str)
+{
+    const char *end = data + length;
+    const char *found = std::search(data + pos, end, str, str + strlen(str));
+    return (found == end) ? length : found - data;
+}
+
+// Return true if the data at pos starts with the string
+static bool StartsWith(const char *data, size_t length, size_t pos, const char *str)
+{
+    size_t strLength = strlen(str);
+    return ((pos + strLength <= length) && (memcmp(data + pos, str, strLength) == 0));
+}
+
+// Return the position after the markup starting at pos (tag, comment, CDATA, PI or DOCTYPE) or length
+static size_t SkipMarkup(const char *data, size_t length, size_t pos)
+{
+    assert(data[pos] == '<');
+
+    size_t end;
+    if (StartsWith(data, length, pos, "<!--")) {
+        end = FindInData(data, length, pos + 4, "-->");
+        return (end == length) ? length : end + 3;
+    }
+    else if (StartsWith(data, length, pos, "<![CDATA[")) {
+        end = FindInData(data, length, pos + 9, "]]>");
+        return (end == length) ? length : end + 3;
+    }
+    else if (StartsWith(data, length, pos, "<?")) {
+        end = FindInData(data, length, pos + 2, "?>");
+        return (end == length) ? length : end + 2;
+    }
+
+    // Tags and DOCTYPE - look for the closing '>' outside quoted values (and internal subset)
+    char quote = 0;
+    int brackets = 0;
+    for (end = pos + 1; end < length; end++) {
+        char c = data[end];
+        if (quote) {
+            if (c == quote) quote = 0;
+        }
+        else if ((c == '"') || (c == '\'')) {
+            quote = c;
+        }
+        else if (c == '[') {
+            brackets++;
+        }
+        else if ((c == ']') && (brackets > 0)) {
+            brackets--;
+        }
+        else if ((c == '>') && (brackets == 0)) {
+            return end + 1;
+        }
+    }
+    return length;
+}
+
+// Return true if the markup at pos is the start or end tag (with endTag) of an element with the name
+static bool IsTag(const char *data, size_t length, size_t pos, const char *name, bool endTag)
+{
+    if (endTag) {
+        if (!StartsWith(data, length, pos, "</")) return false;
+        pos++;
+    }
+    if (!StartsWith(data, length, pos + 1, name)) return false;
+    size_t next = pos + 1 + strlen(name);
+    if (next >= length) return false;
+    char c = data[next];
+    return ((c == '>') || (c == '/') || isspace(c));
+}
+
+size_t FileInputStream::FindString(const char *data, size_t length, size_t pos, const char *str)
+{
+    return FindInData(data, length, pos, str);
+}
+
+bool FileInputStream::SplitXmlElements(const char *data, size_t length, const char *name, std::string &skeleton,
+    std::vector<std::pair<size_t, size_t> > &fragments)
+{
+    fragments.clear();
+    skeleton.clear();
+
+    // Nothing to scan (and no buffer for an empty file)
+    if (length == 0) return false;
+
+    size_t copied = 0;
+    size_t pos = 0;
+    const char *found;
+    while ((found = static_cast<const char *>(memchr(data + pos, '<', length - pos)))) {
+        pos = found - data;
+        size_t end = SkipMarkup(data, length, pos);
+        if (end == length) break;
+        // Self-closing elements are kept as they are
+        if (!IsTag(data, length, pos, name, false) || (data[end - 2] == '/')) {
+            pos = end;
+            continue;
+        }
+        // Look for the matching end tag
+        size_t start = pos;
+        size_t startTagEnd = end;
+        int depth = 1;
+        while (depth > 0) {
+            found = static_cast<const char *>(memchr(data + end, '<', length - end));
+            if (!found) return false;
+            pos = found - data;
+            end = SkipMarkup(data, length, pos);
+            if (IsTag(data, length, pos, name, true)) {
+                depth--;
+            }
+            else if (IsTag(data, length, pos, name, false) && (data[end - 2] != '/')) {
+                depth++;
+            }
+            if ((end == length) && (depth > 0)) return false;
+        }
+        // Keep the start tag in the skeleton with the index of the fragment as content
+        skeleton.append(data + copied, startTagEnd - copied);
+        skeleton += StringFormat("%d</%s>", (int)fragments.size(), name);
+        fragments.push_back(std::make_pair(start, end - start));
+        copied = end;
+        pos = end;
+    }
+    skeleton.append(data + copied, length - copied);
+    return true;
+}
+
+size_t FileInputStream::DiscardBuffer(char *data, size_t begin, size_t end)
+{
+#if !defined(_WIN32) && !defined(USE_EMSCRIPTEN)
+    if (!m_bufferFileMapping) return begin;
+
+    // Only the pages entirely within the range can be discarded
+    static const uintptr_t pageSize = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t first = ((uintptr_t)(data + begin) + pageSize - 1) / pageSize * pageSize;
+    uintptr_t last = (uintptr_t)(data + end) / pageSize * pageSize;
+    if (last <= first) return begin;
+    if (madvise(reinterpret_cast<void *>(first), last - first, MADV_DONTNEED) != 0) return begin;
+    return (size_t)(last - (uintptr_t)data);
+#else
+    return begin;
+#endif
+}
+
+
 } // namespace vrv
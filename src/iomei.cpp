@@ -10,7 +10,17 @@
 //----------------------------------------------------------------------------
 
 #include <assert.h>
+#include <algorithm>
+#include <ctype.h>
 #include <iostream>
+#include <set>
+#include <sstream>
+#include <string.h>
+
+#ifndef USE_EMSCRIPTEN
+#include <atomic>
+#include <thread>
+#endif
 
 //----------------------------------------------------------------------------
 
@@ -18,6 +28,7 @@
 #include "anchoredtext.h"
 #include "beam.h"
 #include "chord.h"
+#include "clef.h"
 #include "custos.h"
 #include "dir.h"
 #include "dot.h"
@@ -61,7 +72,7 @@ std::string MeiInput::s_editorialElementNames[] = { "abbr", "add", "app", "annot
 MeiOutput::MeiOutput(Doc *doc, std::string filename) : FileOutputStream(doc)
 {
     m_filename = filename;
-    m_writeToStreamString = false;
+    m_writer = NULL;
     m_page = -1;
     m_scoreBasedMEI = false;
 }
@@ -72,6 +83,24 @@ MeiOutput::~MeiOutput()
 
 bool MeiOutput::ExportFile()
 {
+    FILE *file = fopen(m_filename.c_str(), "wb");
+    if (!file) {
+        LogError("Unable to open file '%s' for writing", m_filename.c_str());
+        return false;
+    }
+
+    pugi::xml_writer_file writer(file);
+    bool success = this->Export(writer);
+    fclose(file);
+
+    return success;
+}
+
+bool MeiOutput::Export(pugi::xml_writer &writer)
+{
+    m_writer = &writer;
+    m_openNodes.clear();
+
     try {
         pugi::xml_document meiDoc;
 
@@ -104,8 +133,12 @@ bool MeiOutput::ExportFile()
         else {
             if (m_page >= m_doc->GetPageCount()) {
                 LogError("Page %d does not exist", m_page);
+                m_writer = NULL;
                 return false;
             }
+            // default declaration as written by pugi when there is none
+            writer.write("<?xml version=\"1.0\"?>\n", 22);
+
             Page *page = dynamic_cast<Page *>(m_doc->GetChild(m_page));
             assert(page);
             if (m_scoreBasedMEI) {
@@ -121,32 +154,117 @@ bool MeiOutput::ExportFile()
 
             page->Save(this);
         }
-        if (m_writeToStreamString) {
-            // meiDoc.save(m_streamStringOutput, "    ", pugi::format_default | pugi::format_no_escapes);
-            meiDoc.save(m_streamStringOutput, "    ");
-        }
-        else {
-            // meiDoc.save_file(m_filename.c_str(), "    ", pugi::format_default | pugi::format_no_escapes);
-            meiDoc.save_file(m_filename.c_str(), "    ");
+
+        // close the elements still open and write what has not been streamed
+        while (!m_openNodes.empty()) {
+            this->WriteEndTag(m_openNodes.back());
         }
+        // meiDoc.save(writer, "    ", pugi::format_default | pugi::format_no_escapes);
+        meiDoc.save(writer, "    ", pugi::format_default | pugi::format_no_declaration);
     }
     catch (char *str) {
         LogError("%s", str);
+        m_writer = NULL;
         return false;
     }
 
+    m_writer = NULL;
+    m_nodeStack.clear();
+
     return true;
 }
 
 std::string MeiOutput::GetOutput(int page)
 {
-    m_writeToStreamString = true;
+    std::string output;
+    MeiStringWriter writer(output);
     m_page = page;
-    this->ExportFile();
-    m_writeToStreamString = false;
+    this->Export(writer);
     m_page = -1;
 
-    return m_streamStringOutput.str();
+    return output;
+}
+
+bool MeiOutput::IsStreamed(pugi::xml_node node)
+{
+    // Containers with only elements as children - their start tag can be written before they are completed
+    static const char *containers[] = { "mei", "music", "body", "mdiv", "score", "section", "pages", "page", "system",
+        "measure", "staff", "layer" };
+
+    for (size_t i = 0; i < sizeof(containers) / sizeof(containers[0]); ++i) {
+        if (strcmp(node.name(), containers[i]) == 0) return true;
+    }
+    return false;
+}
+
+void MeiOutput::WriteStartTags(pugi::xml_node node)
+{
+    if (!m_writer || !this->IsStreamed(node.parent())) return;
+
+    std::vector<pugi::xml_node> ancestors;
+    for (pugi::xml_node current = node; current.type() == pugi::node_element; current = current.parent()) {
+        ancestors.insert(ancestors.begin(), current);
+    }
+
+    for (int depth = 0; depth < (int)ancestors.size(); ++depth) {
+        pugi::xml_node current = ancestors.at(depth);
+        // the start tag of the parent is written, so we can write the siblings before
+        this->WriteChildren(current.parent(), current, depth);
+        if (current == node) break;
+        if (depth < (int)m_openNodes.size()) {
+            assert(m_openNodes.at(depth) == current);
+            continue;
+        }
+        if (!this->IsStreamed(current)) break;
+
+        // write the start tag by printing a copy without the children as an empty element
+        pugi::xml_document tagDoc;
+        pugi::xml_node tag = tagDoc.append_child(current.name());
+        for (pugi::xml_attribute_iterator it = current.attributes_begin(); it != current.attributes_end(); ++it) {
+            tag.append_copy(*it);
+        }
+        std::string startTag;
+        MeiStringWriter tagWriter(startTag);
+        tag.print(tagWriter, "    ", pugi::format_default, pugi::encoding_auto, depth);
+        // replace the " />\n" of the empty element
+        assert(startTag.size() > 4);
+        startTag.replace(startTag.size() - 4, 3, ">");
+        m_writer->write(startTag.c_str(), startTag.size());
+        m_openNodes.push_back(current);
+    }
+}
+
+void MeiOutput::WriteEndTag(pugi::xml_node node)
+{
+    if (!m_writer) return;
+
+    pugi::xml_node parent = node.parent();
+    int depth = 0;
+    for (pugi::xml_node current = parent; current.type() == pugi::node_element; current = current.parent()) {
+        depth++;
+    }
+
+    if (!m_openNodes.empty() && (m_openNodes.back() == node)) {
+        this->WriteChildren(node, pugi::xml_node(), depth + 1);
+        std::string endTag;
+        for (int i = 0; i < depth; ++i) endTag += "    ";
+        endTag += StringFormat("</%s>\n", node.name());
+        m_writer->write(endTag.c_str(), endTag.size());
+        m_openNodes.pop_back();
+        parent.remove_child(node);
+    }
+    // the element is completed and its parent start tag written
+    else if (!m_openNodes.empty() && (m_openNodes.back() == parent)) {
+        this->WriteChildren(parent, node.next_sibling(), depth);
+    }
+}
+
+void MeiOutput::WriteChildren(pugi::xml_node node, pugi::xml_node until, int depth)
+{
+    while (node.first_child() && (node.first_child() != until)) {
+        node.first_child().print(*m_writer, "    ", pugi::format_default, pugi::encoding_auto, depth);
+        node.remove_child(node.first_child());
+    }
 }
 
 bool MeiOutput::WriteObject(Object *object)
@@ -411,6 +529,10 @@ bool MeiOutput::WriteObject(Object *object)
     }
 
     // LogDebug("Current: %s ", m_currentNode.value());
+    // a new element was appended (not for text or for pages and systems in score-based MEI)
+    if (m_nodeStack.empty() || (m_currentNode != m_nodeStack.back())) {
+        this->WriteStartTags(m_currentNode);
+    }
     m_nodeStack.push_back(m_currentNode);
 
     return true;
@@ -418,8 +540,15 @@ bool MeiOutput::WriteObject(Object *object)
 
 bool MeiOutput::WriteObjectEnd(Object *object)
 {
+    pugi::xml_node node = m_nodeStack.back();
     m_nodeStack.pop_back();
-    m_currentNode = m_nodeStack.back();
+    // the same node is pushed more than once for text and for pages and systems in score-based MEI
+    if (m_nodeStack.empty() || (node != m_nodeStack.back())) {
+        this->WriteEndTag(node);
+    }
+    if (!m_nodeStack.empty()) {
+        m_currentNode = m_nodeStack.back();
+    }
 
     return true;
 }
@@ -446,10 +575,10 @@ bool MeiOutput::WriteMeiDoc(Doc *doc)
 
     pugi::xml_node meiHead = m_mei.append_child("meiHead");
 
-    if (m_doc->m_header.first_child()) {
-        for (pugi::xml_node child = m_doc->m_header.first_child(); child; child = child.next_sibling()) {
-            meiHead.append_copy(child);
-        }
+    if (!m_doc->m_header.empty()) {
+        // the header is parsed back only here
+        meiHead.append_buffer(m_doc->m_header.c_str(), m_doc->m_header.size(),
+            pugi::parse_default & ~pugi::parse_eol, pugi::encoding_utf8);
     }
     else {
         pugi::xml_node fileDesc = meiHead.append_child("fileDesc");
@@ -1182,10 +1311,79 @@ MeiInput::MeiInput(Doc *doc, std::string filename) : FileInputStream(doc)
     m_system = NULL;
     //
     m_hasScoreDef = false;
+    m_meiData = NULL;
+    m_meiInPlace = false;
+    m_meiDiscarded = 0;
+    m_hasMeasureRange = false;
+    m_measureRangeByIndex = false;
+    m_measureIndex = 0;
+    m_measureRangePosition = RANGE_WITHIN;
+    m_threadCount = 1;
+    m_parallelMeasureIndex = 0;
+    m_appXPath = NULL;
 }
 
 MeiInput::~MeiInput()
 {
+    ClearParallelMeasures();
+    if (m_appXPath) {
+        delete m_appXPath;
+    }
+}
+
+void MeiInput::SetAppXPathQuery(std::string appXPathQuery)
+{
+    m_appXPathQuery = appXPathQuery;
+    if (m_appXPath) {
+        delete m_appXPath;
+        m_appXPath = NULL;
+    }
+    if (m_appXPathQuery.empty()) {
+        return;
+    }
+
+    // The query is evaluated for every <app> (possibly by several threads) but compiled only here
+    try {
+        m_appXPath = new pugi::xpath_query(m_appXPathQuery.c_str());
+    }
+    catch (pugi::xpath_exception &e) {
+        LogError("Invalid xPath query '%s': %s", m_appXPathQuery.c_str(), e.what());
+        m_appXPath = NULL;
+    }
+}
+
+void MeiInput::SetMeasureRange(std::string range, bool byIndex)
+{
+    m_measureRangeStart.clear();
+    m_measureRangeEnd.clear();
+    m_measureRangeByIndex = byIndex;
+    m_hasMeasureRange = !range.empty();
+    if (!m_hasMeasureRange) {
+        m_measureRangePosition = RANGE_WITHIN;
+        return;
+    }
+
+    size_t separator = range.find('-');
+    if (separator == std::string::npos) {
+        m_measureRangeStart = range;
+        m_measureRangeEnd = range;
+    }
+    else {
+        m_measureRangeStart = range.substr(0, separator);
+        m_measureRangeEnd = range.substr(separator + 1);
+    }
+    m_measureRangePosition = m_measureRangeStart.empty() ? RANGE_WITHIN : RANGE_BEFORE;
+}
+
+void MeiInput::SetStaffSelection(std::string staves)
+{
+    m_staffSelection.clear();
+    std::replace(staves.begin(), staves.end(), ',', ' ');
+    std::istringstream iss(staves);
+    int n;
+    while (iss >> n) {
+        m_staffSelection.insert(n);
+    }
 }
 
 bool MeiInput::ImportFile()
@@ -1206,22 +1404,234 @@ bool MeiInput::ImportFile()
     }
 }
 
-bool MeiInput::ImportString(const std::string mei)
+bool MeiInput::ImportString(const std::string &mei)
+{
+    return this->ImportData(mei.c_str(), mei.size(), false);
+}
+
+bool MeiInput::ImportBuffer(char *data, size_t length)
+{
+    return this->ImportData(data, length, true);
+}
+
+bool MeiInput::ImportData(const char *data, size_t length, bool inPlace)
 {
     try {
         m_doc->Reset(Raw);
+        // Declared first since the document is parsed in place in it
+        std::string skeleton;
         pugi::xml_document doc;
-        doc.load(mei.c_str(), pugi::parse_default & ~pugi::parse_eol);
+        unsigned int options = pugi::parse_default & ~pugi::parse_eol;
+        if (SplitXmlElements(data, length, "measure", skeleton, m_measureFragments)) {
+            m_meiData = data;
+            m_meiInPlace = inPlace;
+            m_meiDiscarded = 0;
+            doc.load_buffer_inplace(&skeleton[0], skeleton.size(), options, pugi::encoding_utf8);
+        }
+        else if (inPlace) {
+            // The buffer is the one passed to ImportBuffer and can be modified
+            doc.load_buffer_inplace(const_cast<char *>(data), length, options, pugi::encoding_utf8);
+        }
+        else {
+            doc.load_buffer(data, length, options, pugi::encoding_utf8);
+        }
         pugi::xml_node root = doc.first_child();
-        return ReadMei(root);
+        bool success = ReadMei(root);
+        m_meiData = NULL;
+        m_measureFragments.clear();
+        return success;
     }
     catch (char *str) {
+        m_meiData = NULL;
         LogError("%s", str);
         return false;
     }
 }
 
-bool MeiInput::IsAllowed(std::string element, Object *filterParent)
+bool MeiInput::GetMeasureFragment(pugi::xml_node measure, const char *&data, size_t &length)
+{
+    if (!m_meiData) return false;
+
+    // The placeholder is the only child of the <measure> in the skeleton
+    pugi::xml_node placeholder = measure.first_child();
+    if ((placeholder.type() != pugi::node_pcdata) || placeholder.next_sibling()) return false;
+    size_t idx = atoi(placeholder.value());
+    if (idx >= m_measureFragments.size()) return false;
+
+    data = m_meiData + m_measureFragments.at(idx).first;
+    length = m_measureFragments.at(idx).second;
+    return true;
+}
+
+void MeiInput::DiscardMeasureData(pugi::xml_node measure)
+{
+    if (!m_meiInPlace) return;
+
+    const char *data;
+    size_t length;
+    if (!this->GetMeasureFragment(measure, data, length)) return;
+    size_t end = (data - m_meiData) + length;
+    if (end > m_meiDiscarded) {
+        m_meiDiscarded = DiscardBuffer(const_cast<char *>(m_meiData), m_meiDiscarded, end);
+    }
+}
+
+bool MeiInput::ParseMeasureFragment(pugi::xml_node measure, pugi::xml_document &fragment)
+{
+    const char *data;
+    size_t length;
+    if (!this->GetMeasureFragment(measure, data, length)) return false;
+
+    unsigned int options = pugi::parse_default & ~pugi::parse_eol;
+    if (m_meiInPlace) {
+        // The fragments do not overlap and each of them is parsed only once
+        return fragment.load_buffer_inplace(const_cast<char *>(data), length, options, pugi::encoding_utf8);
+    }
+    return fragment.load_buffer(data, length, options, pugi::encoding_utf8);
+}
+
+bool MeiInput::IsMeasureSelected(pugi::xml_node measure)
+{
+    if (!m_hasMeasureRange) return true;
+
+    m_measureIndex++;
+    std::string value;
+    if (m_measureRangeByIndex) {
+        value = StringFormat("%d", m_measureIndex);
+    }
+    else {
+        value = measure.attribute("n").value();
+    }
+
+    if (m_measureRangePosition == RANGE_BEFORE) {
+        if (value != m_measureRangeStart) return false;
+        m_measureRangePosition = RANGE_WITHIN;
+    }
+    else if (m_measureRangePosition == RANGE_AFTER) {
+        return false;
+    }
+
+    // The last measure of the range is still read
+    if (value == m_measureRangeEnd) {
+        m_measureRangePosition = RANGE_AFTER;
+    }
+    return true;
+}
+
+bool MeiInput::IsStaffSelected(pugi::xml_node element)
+{
+    if (m_staffSelection.empty()) return true;
+
+    // <staff> and <staffDef> have a @n, control events a @staff with one or more values
+    std::string name = element.name();
+    if ((name == "staff") || (name == "staffDef")) {
+        return (m_staffSelection.count(element.attribute("n").as_int()) > 0);
+    }
+    pugi::xml_attribute staff = element.attribute("staff");
+    if (!staff) return true;
+    std::istringstream iss(staff.value());
+    int n;
+    while (iss >> n) {
+        if (m_staffSelection.count(n) > 0) return true;
+    }
+    return false;
+}
+
+bool MeiInput::HasSelectedStaffDef(pugi::xml_node staffGrp)
+{
+    pugi::xpath_node_set staffDefs = staffGrp.select_nodes(".//staffDef");
+    for (pugi::xpath_node_set::const_iterator it = staffDefs.begin(); it != staffDefs.end(); ++it) {
+        if (this->IsStaffSelected(it->node())) return true;
+    }
+    return false;
+}
+
+void MeiInput::ReadSkippedScoreDef(pugi::xml_node scoreDef)
+{
+    ScoreDef *docScoreDef = &m_doc->m_scoreDef;
+
+    // The attributes of the <scoreDef> apply to the scoreDef and to all the staves.
+    // They are read from a copy for each of them because reading an attribute removes it.
+    std::vector<ScoreDefInterface *> interfaces;
+    interfaces.push_back(docScoreDef);
+    ListOfObjects *staffDefs = docScoreDef->GetList(docScoreDef);
+    ListOfObjects::iterator iter;
+    for (iter = staffDefs->begin(); iter != staffDefs->end(); ++iter) {
+        StaffDef *staffDef = dynamic_cast<StaffDef *>(*iter);
+        assert(staffDef);
+        interfaces.push_back(staffDef);
+    }
+    std::vector<ScoreDefInterface *>::iterator it;
+    for (it = interfaces.begin(); it != interfaces.end(); ++it) {
+        pugi::xml_document copy;
+        pugi::xml_node node = copy.append_child(scoreDef.name());
+        for (pugi::xml_attribute attr = scoreDef.first_attribute(); attr; attr = attr.next_attribute()) {
+            node.append_copy(attr);
+        }
+        ReadScoreDefInterface(node, *it);
+    }
+
+    // Then the <staffDef> attributes to the staffDef with the same @n
+    pugi::xpath_node_set staffDefNodes = scoreDef.select_nodes(".//staffDef");
+    for (pugi::xpath_node_set::const_iterator nodeIt = staffDefNodes.begin(); nodeIt != staffDefNodes.end();
+         ++nodeIt) {
+        pugi::xml_node staffDefNode = nodeIt->node();
+        int n = staffDefNode.attribute("n").as_int();
+        // GetStaffDef returns the last staffDef when none matches
+        StaffDef *staffDef = docScoreDef->GetStaffDef(n);
+        if (!staffDef || (staffDef->GetN() != n)) continue;
+        staffDef->ReadCommon(staffDefNode);
+        staffDef->ReadLabelsAddl(staffDefNode);
+        ReadScoreDefInterface(staffDefNode, staffDef);
+    }
+}
+
+void MeiInput::ReadSkippedMeasure(pugi::xml_node measure)
+{
+    // Only clef and key changes within the layers carry over - most measures have none and are not parsed
+    const char *data;
+    size_t length;
+    if (this->GetMeasureFragment(measure, data, length)) {
+        if ((FindString(data, length, 0, "<clef") == length) && (FindString(data, length, 0, "<keySig") == length)) {
+            return;
+        }
+    }
+    pugi::xml_document fragment;
+    if (this->ParseMeasureFragment(measure, fragment)) {
+        measure = fragment.first_child();
+    }
+
+    for (pugi::xml_node staff = measure.child("staff"); staff; staff = staff.next_sibling("staff")) {
+        int n = staff.attribute("n").as_int();
+        StaffDef *staffDef = m_doc->m_scoreDef.GetStaffDef(n);
+        if (!staffDef || (staffDef->GetN() != n)) continue;
+        pugi::xpath_node_set changes = staff.select_nodes(".//clef|.//keySig");
+        for (pugi::xpath_node_set::const_iterator it = changes.begin(); it != changes.end(); ++it) {
+            pugi::xml_node change = it->node();
+            if (std::string(change.name()) == "clef") {
+                Clef clef;
+                clef.ReadClefshape(change);
+                clef.ReadLineloc(change);
+                clef.ReadOctavedisplacement(change);
+                staffDef->SetClefShape(clef.GetShape());
+                staffDef->SetClefLine(clef.GetLine());
+                staffDef->SetClefDis(clef.GetDis());
+                staffDef->SetClefDisPlace(clef.GetDisPlace());
+            }
+            else {
+                KeySig keySig;
+                keySig.ReadAccidental(change);
+                keySig.ReadPitch(change);
+                keySig.ConvertToInternal();
+                int key = keySig.GetAlterationNumber();
+                if (keySig.GetAlterationType() == ACCIDENTAL_EXPLICIT_f) key = -key;
+                staffDef->SetKeySig((data_KEYSIGNATURE)(KEYSIGNATURE_0 + key));
+            }
+        }
+    }
+}
+
+bool MeiInput::IsAllowed(const std::string &element, Object *filterParent)
 {
     if (!filterParent) {
         return true;
@@ -1304,7 +1714,18 @@ bool MeiInput::ReadMei(pugi::xml_node root)
     if (!music.empty()) {
         body = music.child("body");
     }
-    if (!body.empty()) {
+    if (!body.empty() && !m_mdivSelection.empty()) {
+        std::string selection = m_mdivSelection;
+        mdiv = body.find_node([&selection](pugi::xml_node node) {
+            return ((std::string(node.name()) == "mdiv")
+                && ((selection == node.attribute("n").value()) || (selection == node.attribute("xml:id").value())));
+        });
+        if (mdiv.empty()) {
+            LogError("<mdiv> '%s' could not be found", m_mdivSelection.c_str());
+            return false;
+        }
+    }
+    else if (!body.empty()) {
         mdiv = body.child("mdiv");
     }
     if (!mdiv.empty()) {
@@ -1334,22 +1755,28 @@ bool MeiInput::ReadMei(pugi::xml_node root)
         m_system = new System();
         m_page->AddSystem(m_system);
         m_doc->AddPage(m_page);
+        success = ReadMeiMeasuresInParallel(mdiv);
         pugi::xml_node current;
         for (current = mdiv.first_child(); current; current = current.next_sibling()) {
             if (!success) break;
             success = ReadScoreBasedMei(current);
         }
+        ClearParallelMeasures();
+        if (m_hasMeasureRange && (m_measureRangePosition == RANGE_BEFORE)) {
+            LogWarning("The start of the measure range could not be found");
+        }
     }
     return success;
 }
 
 bool MeiInput::ReadMeiHeader(pugi::xml_node meiHead)
 {
-    m_doc->m_header.reset();
-    // copy all the nodes inside into the master document
+    // keep all the nodes inside serialized in the master document - they are not needed for the rendering
+    std::ostringstream header;
     for (pugi::xml_node child = meiHead.first_child(); child; child = child.next_sibling()) {
-        m_doc->m_header.append_copy(child);
+        child.print(header, "", pugi::format_raw);
     }
+    m_doc->m_header = header.str();
     return true;
 }
 
@@ -1500,6 +1927,12 @@ bool MeiInput::ReadMeiScoreDef(Object *parent, pugi::xml_node scoreDef)
 {
     assert(dynamic_cast<System *>(parent) || dynamic_cast<EditorialElement *>(parent));
 
+    // A change before the measure range is applied to the initial scoreDef
+    if (m_hasScoreDef && (m_measureRangePosition == RANGE_BEFORE)) {
+        this->ReadSkippedScoreDef(scoreDef);
+        return true;
+    }
+
     ScoreDef *vrvScoreDef;
     if (!m_hasScoreDef) {
         vrvScoreDef = &m_doc->m_scoreDef;
@@ -1542,6 +1975,11 @@ bool MeiInput::ReadMeiStaffGrp(Object *parent, pugi::xml_node staffGrp)
 {
     assert(dynamic_cast<ScoreDef *>(parent) || dynamic_cast<StaffGrp *>(parent));
 
+    // Do not keep a staffGrp without any of the selected staves
+    if (!m_staffSelection.empty() && !this->HasSelectedStaffDef(staffGrp)) {
+        return true;
+    }
+
     StaffGrp *vrvStaffGrp = new StaffGrp();
     SetMeiUuid(staffGrp, vrvStaffGrp);
 
@@ -1585,6 +2023,10 @@ bool MeiInput::ReadMeiStaffDef(Object *parent, pugi::xml_node staffDef)
 {
     assert(dynamic_cast<StaffGrp *>(parent) || dynamic_cast<EditorialElement *>(parent));
 
+    if (!this->IsStaffSelected(staffDef)) {
+        return true;
+    }
+
     StaffDef *vrvStaffDef = new StaffDef();
     SetMeiUuid(staffDef, vrvStaffDef);
 
@@ -1618,12 +2060,27 @@ bool MeiInput::ReadMeiStaffDef(Object *parent, pugi::xml_node staffDef)
 
 bool MeiInput::ReadMeiMeasure(Object *parent, pugi::xml_node measure)
 {
-    Measure *vrvMeasure = new Measure();
-    SetMeiUuid(measure, vrvMeasure);
+    // Measures out of the range are not read, but changes before it are carried over
+    if (!this->IsMeasureSelected(measure)) {
+        if (m_measureRangePosition == RANGE_BEFORE) {
+            this->ReadSkippedMeasure(measure);
+        }
+        this->DiscardMeasureData(measure);
+        return true;
+    }
 
-    vrvMeasure->ReadCommon(measure);
-    vrvMeasure->ReadMeasureLog(measure);
-    vrvMeasure->ReadPointing(measure);
+    Measure *vrvMeasure = NULL;
+    // The measure might have been built already in parallel
+    bool prebuilt = (m_parallelMeasureIndex < m_parallelMeasures.size())
+        && (m_parallelMeasureNodes.at(m_parallelMeasureIndex) == measure);
+    if (prebuilt) {
+        vrvMeasure = m_parallelMeasures.at(m_parallelMeasureIndex);
+        m_parallelMeasures.at(m_parallelMeasureIndex) = NULL;
+        m_parallelMeasureIndex++;
+    }
+    else {
+        vrvMeasure = new Measure();
+    }
 
     // This could be moved to an AddMeasure method for consistency with AddLayerElement
     if (parent->Is() == SYSTEM) {
@@ -1636,9 +2093,155 @@ bool MeiInput::ReadMeiMeasure(Object *parent, pugi::xml_node measure)
         assert(element);
         element->AddMeasure(vrvMeasure);
     }
+
+    bool success = true;
+    if (prebuilt) {
+        // The children of a detached measure could not propagate their modification to its new ancestors
+        if (vrvMeasure->IsModified()) parent->Modify();
+    }
+    else {
+        success = ReadMeiMeasureContent(vrvMeasure, measure);
+    }
+    this->DiscardMeasureData(measure);
+    return success;
+}
+
+bool MeiInput::ReadMeiMeasureContent(Measure *vrvMeasure, pugi::xml_node measure)
+{
+    // When reading the data measure by measure, the content is parsed now and dropped once read
+    pugi::xml_document fragment;
+    if (this->ParseMeasureFragment(measure, fragment)) {
+        measure = fragment.first_child();
+    }
+
+    SetMeiUuid(measure, vrvMeasure);
+
+    vrvMeasure->ReadCommon(measure);
+    vrvMeasure->ReadMeasureLog(measure);
+    vrvMeasure->ReadPointing(measure);
+
     return ReadMeiMeasureChildren(vrvMeasure, measure);
 }
 
+void MeiInput::CollectMeasures(pugi::xml_node element, std::vector<pugi::xml_node> &measures)
+{
+    std::string name = element.name();
+    if (name == "measure") {
+        measures.push_back(element);
+    }
+    else if (name == "score") {
+        for (pugi::xml_node current = element.first_child(); current; current = current.next_sibling()) {
+            CollectMeasures(current, measures);
+        }
+    }
+    else if (name == "section") {
+        // Sections with unmeasured music are read differently (see ReadScoreBasedMei)
+        if (element.child("staff")) return;
+        for (pugi::xml_node current = element.first_child(); current; current = current.next_sibling()) {
+            CollectMeasures(current, measures);
+        }
+    }
+}
+
+#ifndef USE_EMSCRIPTEN
+namespace {
+    // A chunk of consecutive measures built by one thread
+    struct MeasureChunk {
+        size_t m_begin;
+        size_t m_end;
+        unsigned int m_uuidSeed;
+        std::vector<std::string> m_log;
+        bool m_success;
+    };
+} // namespace
+#endif
+
+bool MeiInput::ReadMeiMeasuresInParallel(pugi::xml_node mdiv)
+{
+#ifdef USE_EMSCRIPTEN
+    return true;
+#else
+    // The fragments are separate documents that can be modified by different threads - a single DOM cannot
+    if (!m_meiData || m_hasMeasureRange) return true;
+
+    int threadCount = (m_threadCount > 0) ? m_threadCount : (int)std::thread::hardware_concurrency();
+    if (threadCount < 2) return true;
+
+    // The measures are read before the <scoreDef>, which has to be at the beginning of the score
+    if (!mdiv.child("score").child("scoreDef")) return true;
+
+    for (pugi::xml_node current = mdiv.first_child(); current; current = current.next_sibling()) {
+        CollectMeasures(current, m_parallelMeasureNodes);
+    }
+    size_t count = m_parallelMeasureNodes.size();
+    if (count < 2) return true;
+    m_parallelMeasures.resize(count, NULL);
+
+    // Several chunks per thread for balancing the load; the seeds make the uuids independent of the scheduling
+    size_t chunkCount = std::min(count, (size_t)threadCount * 4);
+    std::vector<MeasureChunk> chunks(chunkCount);
+    for (size_t i = 0; i < chunkCount; i++) {
+        chunks.at(i).m_begin = count * i / chunkCount;
+        chunks.at(i).m_end = count * (i + 1) / chunkCount;
+        chunks.at(i).m_uuidSeed = (unsigned int)std::rand() + 1;
+        chunks.at(i).m_success = true;
+    }
+
+    std::atomic<size_t> nextChunk(0);
+    auto buildChunks = [this, &chunks, &nextChunk]() {
+        size_t i;
+        while ((i = nextChunk++) < chunks.size()) {
+            MeasureChunk &chunk = chunks.at(i);
+            SetThreadLogBuffer(&chunk.m_log);
+            Object::SeedThreadUuids(chunk.m_uuidSeed);
+            for (size_t j = chunk.m_begin; (j < chunk.m_end) && chunk.m_success; j++) {
+                m_parallelMeasures.at(j) = new Measure();
+                chunk.m_success = ReadMeiMeasureContent(m_parallelMeasures.at(j), m_parallelMeasureNodes.at(j));
+                // Only the fragment just read is discarded - the data between two measures can hold others read
+                // later (e.g., within <app>) and the pages shared with them are discarded when they are attached
+                const char *data;
+                size_t length;
+                if (m_meiInPlace && chunk.m_success
+                    && this->GetMeasureFragment(m_parallelMeasureNodes.at(j), data, length)) {
+                    DiscardBuffer(const_cast<char *>(m_meiData), data - m_meiData, (data - m_meiData) + length);
+                }
+            }
+            Object::SeedThreadUuids(0);
+            SetThreadLogBuffer(NULL);
+        }
+    };
+
+    // The calling thread builds chunks too
+    std::vector<std::thread> threads;
+    for (int i = 1; i < threadCount; i++) {
+        threads.push_back(std::thread(buildChunks));
+    }
+    buildChunks();
+    for (size_t i = 0; i < threads.size(); i++) {
+        threads.at(i).join();
+    }
+
+    bool success = true;
+    for (size_t i = 0; i < chunkCount; i++) {
+        PrintLogBuffer(chunks.at(i).m_log);
+        success = success && chunks.at(i).m_success;
+    }
+    return success;
+#endif
+}
+
+void MeiInput::ClearParallelMeasures()
+{
+    // Delete the measures not attached (if the reading failed)
+    std::vector<Measure *>::iterator iter;
+    for (iter = m_parallelMeasures.begin(); iter != m_parallelMeasures.end(); ++iter) {
+        if (*iter) delete *iter;
+    }
+    m_parallelMeasures.clear();
+    m_parallelMeasureNodes.clear();
+    m_parallelMeasureIndex = 0;
+}
+
 bool MeiInput::ReadMeiMeasureChildren(Object *parent, pugi::xml_node parentNode)
 {
     assert(dynamic_cast<Measure *>(parent) || dynamic_cast<EditorialElement *>(parent));
@@ -1651,6 +2254,10 @@ bool MeiInput::ReadMeiMeasureChildren(Object *parent, pugi::xml_node parentNode)
         else if (IsEditorialElementName(current.name())) {
             success = ReadMeiEditorialElement(parent, current, EDITORIAL_MEASURE);
         }
+        // staves and control events not selected
+        else if (!this->IsStaffSelected(current)) {
+            continue;
+        }
         // content
         else if (std::string(current.name()) == "anchoredText") {
             success = ReadMeiAnchoredText(parent, current);
@@ -1774,6 +2381,10 @@ bool MeiInput::ReadMeiTie(Object *parent, pugi::xml_node tie)
 
 bool MeiInput::ReadMeiStaff(Object *parent, pugi::xml_node staff)
 {
+    if (!this->IsStaffSelected(staff)) {
+        return true;
+    }
+
     Staff *vrvStaff = new Staff();
     SetMeiUuid(staff, vrvStaff);
 
@@ -1851,9 +2462,39 @@ bool MeiInput::ReadMeiLayer(Object *parent, pugi::xml_node layer)
 
 bool MeiInput::ReadMeiLayerChildren(Object *parent, pugi::xml_node parentNode, Object *filter)
 {
+    // The readers of the layer elements by element name
+    static const std::map<std::string, LayerElementReader> layerElementReaders = {
+        { "accid", &MeiInput::ReadMeiAccid },
+        { "bTrem", &MeiInput::ReadMeiBTrem },
+        { "barLine", &MeiInput::ReadMeiBarLine },
+        { "beam", &MeiInput::ReadMeiBeam },
+        { "beatRpt", &MeiInput::ReadMeiBeatRpt },
+        { "chord", &MeiInput::ReadMeiChord },
+        { "clef", &MeiInput::ReadMeiClef },
+        { "custos", &MeiInput::ReadMeiCustos },
+        { "dot", &MeiInput::ReadMeiDot },
+        { "fTrem", &MeiInput::ReadMeiFTrem },
+        { "keySig", &MeiInput::ReadMeiKeySig },
+        { "mRest", &MeiInput::ReadMeiMRest },
+        { "mRpt", &MeiInput::ReadMeiMRpt },
+        { "mRpt2", &MeiInput::ReadMeiMRpt2 },
+        { "mensur", &MeiInput::ReadMeiMensur },
+        { "meterSig", &MeiInput::ReadMeiMeterSig },
+        { "multiRest", &MeiInput::ReadMeiMultiRest },
+        { "multiRpt", &MeiInput::ReadMeiMultiRpt },
+        { "note", &MeiInput::ReadMeiNote },
+        { "proport", &MeiInput::ReadMeiProport },
+        { "rest", &MeiInput::ReadMeiRest },
+        { "space", &MeiInput::ReadMeiSpace },
+        { "syl", &MeiInput::ReadMeiSyl },
+        { "tuplet", &MeiInput::ReadMeiTuplet },
+        { "verse", &MeiInput::ReadMeiVerse },
+    };
+
     bool success = true;
     pugi::xml_node xmlElement;
     std::string elementName;
+    std::map<std::string, LayerElementReader>::const_iterator reader;
     for (xmlElement = parentNode.first_child(); xmlElement; xmlElement = xmlElement.next_sibling()) {
         if (!success) {
             break;
@@ -1864,84 +2505,12 @@ bool MeiInput::ReadMeiLayerChildren(Object *parent, pugi::xml_node parentNode, O
             continue;
         }
         // editorial
-        else if (IsEditorialElementName(xmlElement.name())) {
+        else if (IsEditorialElementName(elementName)) {
             success = ReadMeiEditorialElement(parent, xmlElement, EDITORIAL_LAYER, filter);
         }
         // content
-        else if (elementName == "accid") {
-            success = ReadMeiAccid(parent, xmlElement);
-        }
-        else if (elementName == "barLine") {
-            success = ReadMeiBarLine(parent, xmlElement);
-        }
-        else if (elementName == "beam") {
-            success = ReadMeiBeam(parent, xmlElement);
-        }
-        else if (elementName == "beatRpt") {
-            success = ReadMeiBeatRpt(parent, xmlElement);
-        }
-        else if (elementName == "bTrem") {
-            success = ReadMeiBTrem(parent, xmlElement);
-        }
-        else if (elementName == "chord") {
-            success = ReadMeiChord(parent, xmlElement);
-        }
-        else if (elementName == "clef") {
-            success = ReadMeiClef(parent, xmlElement);
-        }
-        else if (elementName == "custos") {
-            success = ReadMeiCustos(parent, xmlElement);
-        }
-        else if (elementName == "dot") {
-            success = ReadMeiDot(parent, xmlElement);
-        }
-        else if (elementName == "fTrem") {
-            success = ReadMeiFTrem(parent, xmlElement);
-        }
-        else if (elementName == "keySig") {
-            success = ReadMeiKeySig(parent, xmlElement);
-        }
-        else if (elementName == "mensur") {
-            success = ReadMeiMensur(parent, xmlElement);
-        }
-        else if (elementName == "meterSig") {
-            success = ReadMeiMeterSig(parent, xmlElement);
-        }
-        else if (elementName == "note") {
-            success = ReadMeiNote(parent, xmlElement);
-        }
-        else if (elementName == "rest") {
-            success = ReadMeiRest(parent, xmlElement);
-        }
-        else if (elementName == "mRest") {
-            success = ReadMeiMRest(parent, xmlElement);
-        }
-        else if (elementName == "mRpt") {
-            success = ReadMeiMRpt(parent, xmlElement);
-        }
-        else if (elementName == "mRpt2") {
-            success = ReadMeiMRpt2(parent, xmlElement);
-        }
-        else if (elementName == "multiRest") {
-            success = ReadMeiMultiRest(parent, xmlElement);
-        }
-        else if (elementName == "multiRpt") {
-            success = ReadMeiMultiRpt(parent, xmlElement);
-        }
-        else if (elementName == "proport") {
-            success = ReadMeiProport(parent, xmlElement);
-        }
-        else if (elementName == "space") {
-            success = ReadMeiSpace(parent, xmlElement);
-        }
-        else if (elementName == "syl") {
-            success = ReadMeiSyl(parent, xmlElement);
-        }
-        else if (elementName == "tuplet") {
-            success = ReadMeiTuplet(parent, xmlElement);
-        }
-        else if (elementName == "verse") {
-            success = ReadMeiVerse(parent, xmlElement);
+        else if ((reader = layerElementReaders.find(elementName)) != layerElementReaders.end()) {
+            success = (this->*(reader->second))(parent, xmlElement);
         }
         // unknown
         else {
@@ -2504,7 +3073,8 @@ bool MeiInput::ReadMeiAnnot(Object *parent, pugi::xml_node annot)
 
 bool MeiInput::ReadMeiApp(Object *parent, pugi::xml_node app, EditorialLevel level, Object *filter)
 {
-    if (!m_hasScoreDef) {
+    // The measures read in parallel are all after the <scoreDef> of the score (see ReadMeiMeasuresInParallel)
+    if (!m_hasScoreDef && m_parallelMeasureNodes.empty()) {
         LogError("<app> before any <scoreDef> is not supported");
         return false;
     }
@@ -2522,8 +3092,8 @@ bool MeiInput::ReadMeiAppChildren(Object *parent, pugi::xml_node parentNode, Edi
 
     // Check if one child node matches the m_appXPathQuery
     pugi::xml_node selectedLemOrRdg;
-    if (m_appXPathQuery.length() > 0) {
-        pugi::xpath_node selection = parentNode.select_single_node(m_appXPathQuery.c_str());
+    if (m_appXPath) {
+        pugi::xpath_node selection = m_appXPath->evaluate_node(parentNode);
         if (selection) selectedLemOrRdg = selection.node();
     }
 
@@ -2892,6 +3462,11 @@ void MeiInput::AddTextElement(Object *parent, TextElement *element)
 
 bool MeiInput::ReadScoreBasedMei(pugi::xml_node element)
 {
+    // Nothing is read after the end of the measure range
+    if (m_measureRangePosition == RANGE_AFTER) {
+        return true;
+    }
+
     bool success = true;
     // editorial
     if ((std::string(element.name()) == "app")) {
@@ -3066,13 +3641,11 @@ std::wstring MeiInput::RightTrim(std::wstring str)
     return str;
 }
 
-bool MeiInput::IsEditorialElementName(std::string elementName)
+bool MeiInput::IsEditorialElementName(const std::string &elementName)
 {
-    int i;
-    for (i = 0; i < EDIT_NAMES; i++) {
-        if (std::string(MeiInput::s_editorialElementNames[i]) == elementName) return true;
-    }
-    return false;
+    static const std::set<std::string> editorialElementNames(
+        MeiInput::s_editorialElementNames, MeiInput::s_editorialElementNames + EDIT_NAMES);
+    return (editorialElementNames.count(elementName) > 0);
 }
 
 } // namespace vrv
@@ -10,6 +10,7 @@
 //----------------------------------------------------------------------------
 
 #include <assert.h>
+#include <map>
 #include <sstream>
 
 //----------------------------------------------------------------------------
@@ -43,6 +44,9 @@ namespace vrv {
 MusicXmlInput::MusicXmlInput(Doc *doc, std::string filename) : FileInputStream(doc)
 {
     m_filename = filename;
+    m_xmlData = NULL;
+    m_xmlInPlace = false;
+    m_staffOffset = 0;
 }
 
 MusicXmlInput::~MusicXmlInput()
@@ -67,21 +71,67 @@ bool MusicXmlInput::ImportFile()
     }
 }
 
-bool MusicXmlInput::ImportString(const std::string musicxml)
+bool MusicXmlInput::ImportString(const std::string &musicxml)
+{
+    return this->ImportData(musicxml.c_str(), musicxml.size(), false);
+}
+
+bool MusicXmlInput::ImportBuffer(char *data, size_t length)
+{
+    return this->ImportData(data, length, true);
+}
+
+bool MusicXmlInput::ImportData(const char *data, size_t length, bool inPlace)
 {
     try {
         m_doc->Reset(Raw);
+        // Declared first since the document is parsed in place in it
+        std::string skeleton;
         pugi::xml_document xmlDoc;
-        xmlDoc.load(musicxml.c_str());
+        // Only the part-list and the placeholders of the parts are parsed at once
+        if (SplitXmlElements(data, length, "part", skeleton, m_partFragments)) {
+            m_xmlData = data;
+            m_xmlInPlace = inPlace;
+            xmlDoc.load_buffer_inplace(&skeleton[0], skeleton.size(), pugi::parse_default, pugi::encoding_utf8);
+        }
+        else if (inPlace) {
+            xmlDoc.load_buffer_inplace(const_cast<char *>(data), length, pugi::parse_default, pugi::encoding_utf8);
+        }
+        else {
+            xmlDoc.load_buffer(data, length, pugi::parse_default, pugi::encoding_utf8);
+        }
         pugi::xml_node root = xmlDoc.first_child();
-        return ReadMusicXml(root);
+        bool success = ReadMusicXml(root);
+        m_xmlData = NULL;
+        m_partFragments.clear();
+        return success;
     }
     catch (char *str) {
+        m_xmlData = NULL;
         LogError("%s", str);
         return false;
     }
 }
 
+bool MusicXmlInput::ParsePartFragment(pugi::xml_node part, pugi::xml_document &fragment)
+{
+    if (!m_xmlData) return false;
+
+    // The placeholder is the only child of the <part> in the skeleton
+    pugi::xml_node placeholder = part.first_child();
+    if ((placeholder.type() != pugi::node_pcdata) || placeholder.next_sibling()) return false;
+    size_t idx = atoi(placeholder.value());
+    if (idx >= m_partFragments.size()) return false;
+
+    const char *data = m_xmlData + m_partFragments.at(idx).first;
+    size_t length = m_partFragments.at(idx).second;
+    if (m_xmlInPlace) {
+        // Each fragment is parsed only once
+        return fragment.load_buffer_inplace(const_cast<char *>(data), length, pugi::parse_default, pugi::encoding_utf8);
+    }
+    return fragment.load_buffer(data, length, pugi::parse_default, pugi::encoding_utf8);
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // XML helpers
 
@@ -151,32 +201,6 @@ std::string MusicXmlInput::GetContentOfChild(pugi::xml_node node, std::string ch
     return "";
 }
 
-void MusicXmlInput::AddMeasure(System *system, Measure *measure, int i)
-{
-    assert(system);
-    assert(i >= 0);
-
-    // we just need to add a measure
-    if (i == system->GetChildCount()) {
-        system->AddMeasure(measure);
-    }
-    // otherwise copy the content to the corresponding existing measure
-    else if (system->GetChildCount() > i) {
-        Measure *existingMeasure = dynamic_cast<Measure *>(system->GetChild(i));
-        assert(existingMeasure);
-        Object *current;
-        for (current = measure->GetFirst(); current; current = measure->GetNext()) {
-            Staff *staff = dynamic_cast<Staff *>(measure->Relinquish(current->GetIdx()));
-            assert(staff);
-            existingMeasure->AddStaff(staff);
-        }
-    }
-    // there is a gap, this should not happen
-    else {
-        LogWarning("measures should be added in the right order");
-    }
-}
-
 void MusicXmlInput::AddLayerElement(Layer *layer, LayerElement *element)
 {
     assert(layer);
@@ -209,12 +233,12 @@ Layer *MusicXmlInput::SelectLayer(pugi::xml_node node, vrv::Measure *measure)
     if (!staffNbStr.empty()) {
         staffNb = atoi(staffNbStr.c_str());
     }
-    if ((staffNb < 1) || (staffNb > measure->GetChildCount())) {
+    if ((staffNb < 1) || (staffNb > measure->GetChildCount() - m_staffOffset)) {
         LogWarning("Staff %d cannot be found", staffNb);
         staffNb = 1;
     }
     staffNb--;
-    Staff *staff = dynamic_cast<Staff *>(measure->GetChild(staffNb));
+    Staff *staff = dynamic_cast<Staff *>(measure->GetChild(staffNb + m_staffOffset));
     assert(staff);
     // Now look for the layer with the corresponding voice
     int layerNb = 1;
@@ -232,7 +256,7 @@ Layer *MusicXmlInput::SelectLayer(pugi::xml_node node, vrv::Measure *measure)
 Layer *MusicXmlInput::SelectLayer(int staffNb, vrv::Measure *measure)
 {
     staffNb--;
-    Staff *staff = dynamic_cast<Staff *>(measure->GetChild(staffNb));
+    Staff *staff = dynamic_cast<Staff *>(measure->GetChild(staffNb + m_staffOffset));
     assert(staff);
     // layer -1 means the first one
     return SelectLayer(-1, staff);
@@ -337,6 +361,12 @@ bool MusicXmlInput::ReadMusicXml(pugi::xml_node root)
     Page *page = new Page();
     System *system = new System();
 
+    // Index the parts by @id in one pass
+    std::map<std::string, pugi::xml_node> parts;
+    for (pugi::xml_node part = root.child("part"); part; part = part.next_sibling("part")) {
+        parts.insert(std::make_pair(std::string(part.attribute("id").as_string()), part));
+    }
+
     pugi::xpath_node_set partListChildren = root.select_nodes("/score-partwise/part-list/*");
     for (pugi::xpath_node_set::const_iterator it = partListChildren.begin(); it != partListChildren.end(); ++it) {
         pugi::xpath_node xpathNode = *it;
@@ -364,10 +394,27 @@ bool MusicXmlInput::ReadMusicXml(pugi::xml_node root)
             }
         }
         else if (IsElement(xpathNode.node(), "score-part")) {
-            // get the attributes element of the first measure of the part
+            // find the part - when reading part by part, it is parsed now and dropped once read
             std::string partId = xpathNode.node().attribute("id").as_string();
-            std::string xpath = StringFormat("/score-partwise/part[@id='%s']/measure[@number='1']", partId.c_str());
-            pugi::xpath_node partFirstMeasureAttributes = root.select_single_node(xpath.c_str());
+            pugi::xml_document partFragment;
+            pugi::xml_node part;
+            std::map<std::string, pugi::xml_node>::iterator partIt = parts.find(partId);
+            if (partIt != parts.end()) {
+                part = partIt->second;
+                // a fragment cannot be parsed twice
+                parts.erase(partIt);
+                if (this->ParsePartFragment(part, partFragment)) {
+                    part = partFragment.first_child();
+                }
+            }
+            // get the attributes element of the first measure of the part
+            pugi::xml_node partFirstMeasureAttributes;
+            for (pugi::xml_node measure = part.child("measure"); measure; measure = measure.next_sibling("measure")) {
+                if (HasAttributeWithValue(measure, "number", "1")) {
+                    partFirstMeasureAttributes = measure;
+                    break;
+                }
+            }
             if (!partFirstMeasureAttributes) {
                 LogWarning("Could not find the 'attributes' element in the first measure of part '%s'", partId.c_str());
                 continue;
@@ -375,8 +422,7 @@ bool MusicXmlInput::ReadMusicXml(pugi::xml_node root)
             std::string partName = GetContentOfChild(xpathNode.node(), "part-name");
             // create the staffDef(s)
             StaffGrp *partStaffGrp = new StaffGrp();
-            int nbStaves
-                = ReadMusicXmlPartAttributesAsStaffDef(partFirstMeasureAttributes.node(), partStaffGrp, staffOffset);
+            int nbStaves = ReadMusicXmlPartAttributesAsStaffDef(partFirstMeasureAttributes, partStaffGrp, staffOffset);
             // if we have more than one staff in the part we create a new staffGrp
             if (nbStaves > 1) {
                 partStaffGrp->SetLabel(partName);
@@ -393,14 +439,8 @@ bool MusicXmlInput::ReadMusicXml(pugi::xml_node root)
                 delete partStaffGrp;
             }
 
-            // find the part and read it
-            xpath = StringFormat("/score-partwise/part[@id='%s']", partId.c_str());
-            pugi::xpath_node part = root.select_single_node(xpath.c_str());
-            if (!part) {
-                LogWarning("Could not find the part '%s'", partId.c_str());
-                continue;
-            }
-            ReadMusicXmlPart(part.node(), system, nbStaves, staffOffset);
+            // read the part
+            ReadMusicXmlPart(part, system, nbStaves, staffOffset);
             // increment the staffOffset for reading the next part
             staffOffset += nbStaves;
         }
@@ -542,19 +582,32 @@ bool MusicXmlInput::ReadMusicXmlPart(pugi::xml_node node, System *system, int nb
     assert(node);
     assert(system);
 
-    pugi::xpath_node_set measures = node.select_nodes("measure");
-    if (measures.size() == 0) {
+    if (!node.child("measure")) {
         LogWarning("No measure to load");
         return false;
     }
 
     int i = 0;
-    for (pugi::xpath_node_set::const_iterator it = measures.begin(); it != measures.end(); ++it) {
-        pugi::xpath_node xmlMeasure = *it;
-        Measure *measure = new Measure();
-        ReadMusicXmlMeasure(xmlMeasure.node(), measure, nbStaves, staffOffset);
-        // Add the measure to the system - if already there from a previous part we'll just merge the content
-        AddMeasure(system, measure, i);
+    pugi::xml_node xmlMeasure;
+    for (xmlMeasure = node.child("measure"); xmlMeasure; xmlMeasure = xmlMeasure.next_sibling("measure")) {
+        // The staves are added directly to the measure if already there from a previous part
+        if (i < system->GetChildCount()) {
+            Measure *measure = dynamic_cast<Measure *>(system->GetChild(i));
+            assert(measure);
+            // The measure keeps the attributes read from the first part
+            int n = measure->GetN();
+            data_BARRENDITION left = measure->GetLeft();
+            data_BARRENDITION right = measure->GetRight();
+            ReadMusicXmlMeasure(xmlMeasure, measure, nbStaves, staffOffset);
+            measure->SetN(n);
+            measure->SetLeft(left);
+            measure->SetRight(right);
+        }
+        else {
+            Measure *measure = new Measure();
+            system->AddMeasure(measure);
+            ReadMusicXmlMeasure(xmlMeasure, measure, nbStaves, staffOffset);
+        }
         i++;
     }
     return false;
@@ -566,7 +619,10 @@ bool MusicXmlInput::ReadMusicXmlMeasure(pugi::xml_node node, Measure *measure, i
     assert(measure);
 
     int measureNb = atoi(GetAttributeValue(node, "number").c_str());
-    if (measure > 0) measure->SetN(measureNb);
+    if (measure) measure->SetN(measureNb);
+
+    // The staves of the previous parts are already in the measure - none if they have fewer measures
+    m_staffOffset = measure->GetChildCount();
 
     int i = 0;
     for (i = 0; i < nbStaves; i++) {
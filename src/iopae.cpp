@@ -33,31 +33,12 @@
 
 //----------------------------------------------------------------------------
 
-#ifndef NO_PAE_SUPPORT
-#include <regex.h>
-#endif
-
 namespace vrv {
 
 #define BEAM_INITIAL 0x01
 #define BEAM_MEDIAL 0x02
 #define BEAM_TERMINAL 0x04
 
-// User interface variables:
-int debugQ = 0; // used with --debug option
-int stdoutQ = 0;
-char outdir[1024] = { 0 }; // used with -d option
-char extension[1024] = { 0 }; // used with -e option
-char hum2abc[1024] = { 0 }; // used with -a option
-int quietQ = 0; // used with -q option
-int quiet2Q = 0; // used with -Q option
-
-// Global variables:
-char data_line[10001] = { 0 };
-#define MAX_DATA_LEN 1024 // One line of the pae file would not be that long!
-char data_key[MAX_DATA_LEN];
-char data_value[MAX_DATA_LEN]; // ditto as above
-
 //----------------------------------------------------------------------------
 // PaeInput
 //----------------------------------------------------------------------------
@@ -93,7 +74,7 @@ bool PaeInput::ImportFile()
 #endif
 }
 
-bool PaeInput::ImportString(std::string pae)
+bool PaeInput::ImportString(const std::string &pae)
 {
 #ifndef NO_PAE_SUPPORT
     std::istringstream in_stream(pae);
@@ -105,8 +86,323 @@ bool PaeInput::ImportString(std::string pae)
 #endif
 }
 
+bool PaeInput::ImportNextRecord(std::istream &input)
+{
+#ifndef NO_PAE_SUPPORT
+    // skip the blank lines between the records
+    input >> std::ws;
+    if (!input.good()) {
+        return false;
+    }
+    parsePlainAndEasy(input);
+    return true;
+#else
+    LogError("Plain and Easy import is not supported in the build.");
+    return false;
+#endif
+}
+
 #ifndef NO_PAE_SUPPORT
 
+//----------------------------------------------------------------------------
+// pae::Lexer
+//----------------------------------------------------------------------------
+
+#define BASE_OCT 4
+
+namespace pae {
+
+    Lexer::Lexer(const char *data, size_t length)
+    {
+        m_data = data;
+        m_length = length;
+        m_pos = 0;
+        m_flagsEnd = 0;
+        m_lastTrill = std::string::npos;
+        m_lastTie = std::string::npos;
+        m_lastChord = std::string::npos;
+    }
+
+    bool Lexer::Next(Token &token)
+    {
+        while (m_pos < m_length) {
+            size_t pos = m_pos;
+            char c = m_data[pos];
+
+            token.position = pos;
+            token.length = 1;
+            token.value = 0;
+            token.trill = token.tie = token.chord = false;
+
+            // octaves
+            if ((c == '\'') || (c == ',')) {
+                while ((pos + token.length < m_length) && (m_data[pos + token.length] == c)) {
+                    token.length++;
+                }
+                token.type = TOKEN_OCTAVE;
+                token.value = (c == '\'') ? BASE_OCT + (int)token.length - 1 : BASE_OCT - (int)token.length;
+            }
+
+            // rhythmic values, each with up to two dots
+            else if (isdigit(c)) {
+                size_t i = pos;
+                while ((i < m_length) && isdigit(m_data[i])) {
+                    i++;
+                    if ((i < m_length) && (m_data[i] == '.')) i++;
+                    if ((i < m_length) && (m_data[i] == '.')) i++;
+                }
+                token.type = TOKEN_DURATIONS;
+                token.length = i - pos;
+            }
+
+            // accidentals
+            else if ((c == 'n') || (c == 'x') || (c == 'b')) {
+                token.type = TOKEN_ACCIDENTAL;
+                if (c == 'n') {
+                    token.value = ACCIDENTAL_EXPLICIT_n;
+                }
+                else if (StartsWith(pos, "xx")) {
+                    token.value = ACCIDENTAL_EXPLICIT_ss;
+                    token.length = 2;
+                }
+                else if (c == 'x') {
+                    token.value = ACCIDENTAL_EXPLICIT_s;
+                }
+                else if (StartsWith(pos, "bb")) {
+                    token.value = ACCIDENTAL_EXPLICIT_ff;
+                    token.length = 2;
+                }
+                else {
+                    token.value = ACCIDENTAL_EXPLICIT_f;
+                }
+            }
+
+            // beams
+            else if (c == '{') {
+                token.type = TOKEN_BEAM_START;
+            }
+            else if (c == '}') {
+                token.type = TOKEN_BEAM_END;
+            }
+
+            // beginning of tuplets and fermatas
+            else if (c == '(') {
+                int tupletNotes = GetTupletNotes(pos);
+                if (tupletNotes == -1) {
+                    token.type = TOKEN_FERMATA_START;
+                }
+                else if (tupletNotes == -2) {
+                    LogWarning("Invalid tuplet at position %d of the incipit", (int)pos + 1);
+                    m_pos++;
+                    continue;
+                }
+                else {
+                    token.type = TOKEN_TUPLET_START;
+                    token.value = tupletNotes;
+                }
+            }
+
+            // end of tuplets and fermatas
+            else if ((c == ';') || (c == ')')) {
+                token.type = TOKEN_TUPLET_FERMATA_END;
+            }
+
+            // grace notes
+            else if (c == 'g') {
+                token.type = TOKEN_ACCIACCATURA;
+            }
+            else if (c == 'q') {
+                // the number of notes in the appoggiatura group is given by the notes until the 'r'
+                token.type = TOKEN_APPOGGIATURA;
+                token.value = 1;
+                if (StartsWith(pos, "qq")) {
+                    token.length = 2;
+                    for (size_t r = pos + 1; (r < m_length) && (m_data[r] != 'r'); r++) {
+                        if ((m_data[r] >= 'A') && (m_data[r] <= 'G')) token.value++;
+                    }
+                }
+            }
+            else if (c == 'r') {
+                token.type = TOKEN_APPOGGIATURA_END;
+            }
+
+            // notes and rests
+            else if (((c >= 'A') && (c <= 'G')) || (c == '-')) {
+                token.type = TOKEN_NOTE;
+                ReadNoteFlags(pos, token);
+            }
+
+            // whole rests, with the number of measures
+            else if (c == '=') {
+                token.type = TOKEN_WHOLE_REST;
+                token.value = 1;
+                if ((pos + 1 < m_length) && isdigit(m_data[pos + 1])) {
+                    token.value = atoi(m_data + pos + 1);
+                    while ((pos + token.length < m_length) && isdigit(m_data[pos + token.length])) {
+                        token.length++;
+                    }
+                }
+            }
+
+            // abbreviations, with the number of repetitions
+            else if (c == '!') {
+                token.type = TOKEN_ABBREVIATION;
+                while ((pos + token.length < m_length) && (m_data[pos + token.length] == 'f')) {
+                    token.length++;
+                }
+                token.value = (int)token.length - 1;
+            }
+
+            // measure repetition
+            else if (c == 'i') {
+                token.type = TOKEN_MEASURE_REPEAT;
+            }
+
+            // bar lines
+            else if ((c == ':') || (c == '/')) {
+                token.type = TOKEN_BARLINE;
+                if (StartsWith(pos, "://:")) {
+                    token.value = BARRENDITION_rptboth;
+                    token.length = 4;
+                }
+                else if (StartsWith(pos, "//:")) {
+                    token.value = BARRENDITION_rptstart;
+                    token.length = 3;
+                }
+                else if (StartsWith(pos, "://")) {
+                    token.value = BARRENDITION_rptend;
+                    token.length = 3;
+                }
+                else if (StartsWith(pos, "//")) {
+                    token.value = BARRENDITION_dbl;
+                    token.length = 2;
+                }
+                else {
+                    token.value = BARRENDITION_single;
+                }
+            }
+
+            // clef, time and key signature changes
+            else if (((c == '%') || (c == '@') || (c == '$')) && (pos + 1 < m_length)) {
+                const char *value = m_data + pos + 1;
+                size_t length = m_length - pos - 1;
+                if (c == '%') {
+                    // a clef is maximum 3 character length
+                    token.type = TOKEN_CLEF;
+                    token.length += std::min(length, (size_t)3);
+                }
+                else if (c == '@') {
+                    token.type = TOKEN_TIMESIG;
+                    token.length += GetTimeSigLength(value, length);
+                }
+                else {
+                    token.type = TOKEN_KEYSIG;
+                    token.length += GetKeySigLength(value, length);
+                }
+            }
+
+            // spaces, and trills, ties and chords read with the notes
+            else if ((c == ' ') || (c == 't') || (c == '+') || (c == '^') || (c == ']')) {
+                m_pos++;
+                continue;
+            }
+
+            else {
+                LogWarning("Unexpected character '%c' at position %d of the incipit", c, (int)pos + 1);
+                m_pos++;
+                continue;
+            }
+
+            m_pos += token.length;
+            return true;
+        }
+        return false;
+    }
+
+    size_t Lexer::GetTimeSigLength(const char *data, size_t length)
+    {
+        if ((length == 0) || (!isdigit(data[0]) && (data[0] != 'c') && (data[0] != 'o'))) {
+            return 0;
+        }
+
+        // the time signature length is a least 1
+        size_t i = 1;
+        while ((i < length) && (isdigit(data[i]) || (data[i] == '/') || (data[i] == '.'))) {
+            i++;
+        }
+        return i;
+    }
+
+    size_t Lexer::GetKeySigLength(const char *data, size_t length)
+    {
+        size_t i = 0;
+        while ((i < length) && strchr("bxn[FCGDAEB", data[i]) && (data[i] != '\0')) {
+            i++;
+        }
+        return i;
+    }
+
+    bool Lexer::StartsWith(size_t pos, const char *str) const
+    {
+        size_t length = strlen(str);
+        return ((m_length - pos >= length) && (strncmp(m_data + pos, str, length) == 0));
+    }
+
+    int Lexer::GetTupletNotes(size_t pos) const
+    {
+        // it is a tuplet if at least two notes or rests are found before the closing parenthesis
+        int notes = 0;
+        for (size_t i = pos + 1; (i < m_length) && (m_data[i] != ')') && (notes < 2); i++) {
+            if (((m_data[i] >= 'A') && (m_data[i] <= 'G')) || (m_data[i] == '-')) notes++;
+        }
+        if (notes < 2) return -1;
+
+        // Triplets are in the form (4ABC)
+        // if the previous character is a number or dot, it means we have the long format
+        // i.e. 4(6ABC;5) or 4.(6ABC;5)
+        if ((pos == 0) || (!isdigit(m_data[pos - 1]) && (m_data[pos - 1] != '.'))) {
+            return 3;
+        }
+
+        // move until we find the ';' - we should not find any closing parenthesis before it
+        size_t t = pos;
+        while ((t < m_length) && (m_data[t] != ';')) {
+            if (m_data[t] == ')') return -2;
+            t++;
+        }
+        // then read the number until the closing parenthesis
+        int value = 0;
+        for (t = t + 1; (t < m_length) && (m_data[t] != ')'); t++) {
+            if (!isdigit(m_data[t])) return -2;
+            value = value * 10 + (m_data[t] - '0');
+        }
+        return value;
+    }
+
+    void Lexer::ReadNoteFlags(size_t pos, Token &token)
+    {
+        // The flags are given by the characters until the next note. The positions of the last ones are kept
+        // because rests do not end the span and the next token can be a rest within it.
+        if (pos >= m_flagsEnd) {
+            m_lastTrill = m_lastTie = m_lastChord = std::string::npos;
+            size_t i = pos + 1;
+            for (; (i < m_length) && ((m_data[i] < 'A') || (m_data[i] > 'G')); i++) {
+                if (m_data[i] == 't')
+                    m_lastTrill = i;
+                else if (m_data[i] == '+')
+                    m_lastTie = i;
+                else if (m_data[i] == '^')
+                    m_lastChord = i;
+            }
+            m_flagsEnd = i;
+        }
+        token.trill = ((m_lastTrill != std::string::npos) && (m_lastTrill > pos));
+        token.tie = ((m_lastTie != std::string::npos) && (m_lastTie > pos));
+        token.chord = ((m_lastChord != std::string::npos) && (m_lastChord > pos));
+    }
+
+} // namespace pae
+
 //////////////////////////////
 //
 // parsePlainAndEasy --
@@ -114,234 +410,196 @@ bool PaeInput::ImportString(std::string pae)
 
 void PaeInput::parsePlainAndEasy(std::istream &infile)
 {
-    // buffers
-    char c_clef[1024] = { 0 };
-    char c_key[1024] = { 0 };
-    char c_keysig[1024] = { 0 };
-    char c_timesig[1024] = { 0 };
-    char c_alttimesig[1024] = { 0 };
-    char incipit[10001] = { 0 };
+    std::string clef, keysig, timesig, incipit;
+    std::string line, key, value;
     int in_beam = 0;
 
-    std::string s_key;
     pae::Measure current_measure;
     pae::Note current_note;
     Clef *staffDefClef = NULL;
 
     std::vector<pae::Measure> staff;
 
+    // the input can be used for several records
+    m_last_tied_note = NULL;
+    m_is_in_chord = false;
+    m_nested_objects.clear();
+
     // read values
-    while (!infile.eof()) {
-        infile.getline(data_line, 10000);
-        if (infile.eof()) {
-            LogDebug("Truncated file or ending tag missing");
-            // exit(1);
-        }
-        getAtRecordKeyValue(data_key, data_value, data_line);
-        if (strcmp(data_key, "end") == 0) {
+    bool ended = false;
+    while (std::getline(infile, line)) {
+        getAtRecordKeyValue(line, key, value);
+        if (key == "end") {
+            ended = true;
             break;
         }
-        else if (strcmp(data_key, "clef") == 0) {
-            strcpy(c_clef, data_value);
-        }
-        else if (strcmp(data_key, "key") == 0) {
-            strcpy(c_key, data_value);
+        else if (key == "clef") {
+            clef = value;
         }
-        else if (strcmp(data_key, "keysig") == 0) {
-            strcpy(c_keysig, data_value);
+        else if (key == "keysig") {
+            keysig = value;
         }
-        else if (strcmp(data_key, "timesig") == 0) {
-            strcpy(c_timesig, data_value);
+        else if (key == "timesig") {
+            timesig = value;
         }
-        else if (strcmp(data_key, "alttimesig") == 0) {
-            strcpy(c_alttimesig, data_value);
-        }
-        else if (strcmp(data_key, "data") == 0) {
-            strcpy(incipit, data_value);
+        else if (key == "data") {
+            incipit = value;
         }
     }
+    if (!ended) {
+        LogDebug("Truncated file or ending tag missing");
+    }
 
-    if (strlen(c_clef)) {
+    if (!clef.empty()) {
         Clef *c = new Clef;
-        getClefInfo(c_clef, c); // do we need to put a default clef?
+        getClefInfo(clef.c_str(), clef.size(), c); // do we need to put a default clef?
         if (!staffDefClef)
             staffDefClef = c;
         else
             current_measure.clef = c;
     }
 
-    if (strlen(c_keysig)) {
+    if (!keysig.empty()) {
         KeySig *k = new KeySig();
-        getKeyInfo(c_keysig, k);
+        getKeyInfo(keysig.c_str(), pae::Lexer::GetKeySigLength(keysig.c_str(), keysig.size()), k);
         current_measure.key = k;
     }
-    if (strlen(c_timesig)) {
+    if (!timesig.empty()) {
         MeterSig *meter = new MeterSig;
-        getTimeInfo(c_timesig, meter);
+        getTimeInfo(timesig.c_str(), pae::Lexer::GetTimeSigLength(timesig.c_str(), timesig.size()), meter);
         // What about previous values? Potential memory leak? LP
         current_measure.meter = meter;
     }
 
-    // read the incipit string
-    size_t length = strlen(incipit);
-    int i = 0;
-    while (i < length) {
-        // eat the input...
-
-        if (incipit[i] == ' ') {
-            // just skip
-            i++;
-        }
-
-        // octaves
-        if ((incipit[i] == '\'') || (incipit[i] == ',')) {
-            i += getOctave(incipit, &current_note.octave, i);
-        }
+    // read the incipit string token by token
+    pae::Lexer lexer(incipit.c_str(), incipit.size());
+    pae::Token token;
+    while (lexer.Next(token)) {
+        const char *text = incipit.c_str() + token.position;
 
-        // rhythmic values
-        else if (isdigit(incipit[i]) != 0) {
-            i += getDurations(incipit, &current_measure, i);
-        }
+        switch (token.type) {
+            case pae::TOKEN_OCTAVE: current_note.octave = token.value; break;
 
-        // accidentals (1 = n; 2 = x; 3 = xx; 4 = b; 5 = bb)
-        else if (incipit[i] == 'n' || incipit[i] == 'x' || incipit[i] == 'b') {
-            i += getAccidental(incipit, &current_note.accidental, i);
-        }
+            case pae::TOKEN_DURATIONS: getDurations(text, token.length, &current_measure); break;
 
-        //
-        // beaming starts
-        else if (incipit[i] == '{') {
-            // current_note.beam = 1;
-            current_note.beam = BEAM_INITIAL;
-            in_beam++;
-        }
+            case pae::TOKEN_ACCIDENTAL: current_note.accidental = (data_ACCIDENTAL_EXPLICIT)token.value; break;
 
-        // beaming ends
-        else if (incipit[i] == '}' && in_beam > 0) {
-            current_measure.notes[current_measure.notes.size() - 1].beam = BEAM_TERMINAL;
-            current_note.beam = 0;
-            in_beam--;
-        }
+            case pae::TOKEN_BEAM_START:
+                current_note.beam = BEAM_INITIAL;
+                in_beam++;
+                break;
 
-        // slurs are read when adding the note
-        else if (incipit[i] == '+') {
-        }
-
-        // beginning tuplets & fermatas
-        else if (incipit[i] == '(') {
-            i += getTupletFermata(incipit, &current_note, i);
-        }
-
-        // end of tuplets
-        else if ((incipit[i] == ';') || (incipit[i] == ')')) {
-            i += getTupletFermataEnd(incipit, &current_note, i);
-        }
-
-        // trills are read when adding the note
-        else if (incipit[i] == 't') {
-        }
+            case pae::TOKEN_BEAM_END:
+                if ((in_beam > 0) && !current_measure.notes.empty()) {
+                    current_measure.notes.back().beam = BEAM_TERMINAL;
+                    current_note.beam = 0;
+                    in_beam--;
+                }
+                break;
+
+            case pae::TOKEN_TUPLET_START:
+                // this is the first note, the total number of notes = tuplet_val
+                current_note.tuplet_notes = token.value;
+                // but also the note counter
+                current_note.tuplet_note = token.value;
+                break;
+
+            case pae::TOKEN_FERMATA_START:
+                if (current_note.tuplet_notes > 0) {
+                    LogWarning("Fermata within a tuplet. Won't be handled correctly");
+                }
+                current_note.fermata = true;
+                break;
 
-        // grace notes
-        else if ((incipit[i] == 'g') || (incipit[i] == 'q')) {
-            i += getGraceNote(incipit, &current_note, i);
-        }
+            // TODO: fermatas inside tuplets won't be currently handled correctly
+            case pae::TOKEN_TUPLET_FERMATA_END: current_note.fermata = false; break;
 
-        // end of appogiatura
-        else if (incipit[i] == 'r') {
-            current_note.appoggiatura = 0; // should not have to be done, but just in case
-        }
+            case pae::TOKEN_ACCIACCATURA: current_note.acciaccatura = true; break;
 
-        // note and rest
-        // getNote also creates a new note object
-        else if (((incipit[i] - 'A' >= 0) && (incipit[i] - 'A' < 7)) || (incipit[i] == '-')) {
-            i += getNote(incipit, &current_note, &current_measure, i);
-        }
+            case pae::TOKEN_APPOGGIATURA: current_note.appoggiatura = token.value; break;
 
-        // whole rest
-        else if (incipit[i] == '=') {
-            i += getWholeRest(incipit, &current_measure.wholerest, i);
-        }
+            // should not have to be done, but just in case
+            case pae::TOKEN_APPOGGIATURA_END: current_note.appoggiatura = 0; break;
 
-        // abbreviation
-        else if (incipit[i] == '!') {
-            i += getAbbreviation(incipit, &current_measure, i);
-        }
+            // getNote also creates a new note object
+            case pae::TOKEN_NOTE: getNote(token, text[0], &current_note, &current_measure); break;
 
-        // measure repetition
-        else if ((incipit[i] == 'i') && staff.size() > 0) {
-            pae::Measure last_measure = staff[staff.size() - 1];
-            current_measure.notes = last_measure.notes;
-            current_measure.wholerest = last_measure.wholerest;
-        }
+            case pae::TOKEN_WHOLE_REST: current_measure.wholerest = token.value; break;
 
-        // barLine
-        else if ((incipit[i] == ':') || (incipit[i] == '/')) {
-            i += getBarLine(incipit, &current_measure.barLine, i);
-            current_measure.abbreviation_offset = 0; // just in case...
-            staff.push_back(current_measure);
-            current_measure.reset();
-        }
+            case pae::TOKEN_ABBREVIATION: getAbbreviation(token.value, &current_measure); break;
 
-        // clef change
-        else if ((incipit[i] == '%') && (i + 1 < length)) {
-            Clef *c = new Clef;
-            i += getClefInfo(incipit, c, i + 1);
-            //
-            if (!staffDefClef) {
-                staffDefClef = c;
-            }
-            // If there are no notes yet in the measure
-            // attach this clef change to the measure
-            else if (current_measure.notes.size() == 0) {
-                // If a clef was already assigned, remove it
-                if (current_measure.clef) delete current_measure.clef;
+            case pae::TOKEN_MEASURE_REPEAT:
+                if (!staff.empty()) {
+                    current_measure.notes = staff.back().notes;
+                    current_measure.wholerest = staff.back().wholerest;
+                }
+                break;
+
+            case pae::TOKEN_BARLINE:
+                current_measure.barLine = (data_BARRENDITION)token.value;
+                current_measure.abbreviation_offset = 0; // just in case...
+                staff.push_back(current_measure);
+                current_measure.reset();
+                break;
+
+            case pae::TOKEN_CLEF: {
+                Clef *c = new Clef;
+                getClefInfo(text + 1, token.length - 1, c);
+                if (!staffDefClef) {
+                    staffDefClef = c;
+                }
+                // If there are no notes yet in the measure
+                // attach this clef change to the measure
+                else if (current_measure.notes.size() == 0) {
+                    // If a clef was already assigned, remove it
+                    if (current_measure.clef) delete current_measure.clef;
 
-                current_measure.clef = c;
-            }
-            else {
-                // as above
-                if (current_note.clef) delete current_note.clef;
+                    current_measure.clef = c;
+                }
+                else {
+                    // as above
+                    if (current_note.clef) delete current_note.clef;
 
-                current_note.clef = c;
+                    current_note.clef = c;
+                }
+                break;
             }
-        }
 
-        // time signature change
-        else if ((incipit[i] == '@') && (i + 1 < length)) {
-            MeterSig *meter = new MeterSig;
-            i += getTimeInfo(incipit, meter, i + 1);
-            if (current_measure.notes.size() == 0) {
-                if (current_measure.meter) {
-                    delete current_measure.meter;
+            case pae::TOKEN_TIMESIG: {
+                MeterSig *meter = new MeterSig;
+                getTimeInfo(text + 1, token.length - 1, meter);
+                if (current_measure.notes.size() == 0) {
+                    if (current_measure.meter) {
+                        delete current_measure.meter;
+                    }
+                    // When will this be deleted? Potential memory leak? LP
+                    current_measure.meter = meter;
                 }
-                // When will this be deleted? Potential memory leak? LP
-                current_measure.meter = meter;
-            }
-            else {
-                if (current_note.meter) {
-                    delete current_note.meter;
+                else {
+                    if (current_note.meter) {
+                        delete current_note.meter;
+                    }
+                    current_note.meter = meter;
                 }
-                current_note.meter = meter;
+                break;
             }
-        }
 
-        // key signature change
-        else if ((incipit[i] == '$') && (i + 1 < length)) {
-            KeySig *k = new KeySig;
-            i += getKeyInfo(incipit, k, i + 1);
-            if (current_measure.notes.size() == 0) {
-                if (current_measure.key) delete current_measure.key;
+            case pae::TOKEN_KEYSIG: {
+                KeySig *k = new KeySig;
+                getKeyInfo(text + 1, token.length - 1, k);
+                if (current_measure.notes.size() == 0) {
+                    if (current_measure.key) delete current_measure.key;
 
-                current_measure.key = k;
-            }
-            else {
-                if (current_note.key) delete current_note.key;
+                    current_measure.key = k;
+                }
+                else {
+                    if (current_note.key) delete current_note.key;
 
-                current_note.key = k;
+                    current_note.key = k;
+                }
+                break;
             }
         }
-
-        i++;
     }
 
     // we need to add the last measure if it has no barLine at the end
@@ -393,274 +651,49 @@ void PaeInput::parsePlainAndEasy(std::istream &infile)
     m_doc->AddPage(page);
 }
 
-//////////////////////////////
-//
-// getOctave --
-//
-#define BASE_OCT 4
-int PaeInput::getOctave(const char *incipit, char *octave, int index)
-{
-    int i = index;
-    size_t length = strlen(incipit);
-    if (incipit[i] == '\'') {
-        *octave = BASE_OCT;
-        while ((i + 1 < length) && (incipit[i + 1] == '\'')) {
-            (*octave)++;
-            i++;
-        }
-    }
-    else if (incipit[i] == ',') {
-        // negative octave
-        *octave = BASE_OCT - 1;
-        while ((i + 1 < length) && (incipit[i + 1] == ',')) {
-            (*octave)--;
-            i++;
-        }
-    }
-
-    return i - index;
-}
-
-//////////////////////////////
-//
-// getDuration --
-//
-
-int PaeInput::getDuration(const char *incipit, data_DURATION *duration, int *dot, int index)
-{
-
-    int i = index;
-    size_t length = strlen(incipit);
-
-    switch (incipit[i]) {
-        case '0': *duration = DURATION_long; break;
-        case '1': *duration = DURATION_1; break;
-        case '2': *duration = DURATION_2; break;
-        case '3': *duration = DURATION_32; break;
-        case '4': *duration = DURATION_4; break;
-        case '5': *duration = DURATION_64; break;
-        case '6': *duration = DURATION_16; break;
-        case '7': *duration = DURATION_128; break;
-        case '8': *duration = DURATION_8; break;
-        case '9': *duration = DURATION_breve; break;
-    }
-
-    *dot = 0;
-    if ((i + 1 < length) && (incipit[i + 1] == '.')) {
-        // one dot
-        (*dot)++;
-        i++;
-    }
-    if ((i + 1 < length) && (incipit[i + 1] == '.')) {
-        // two dots
-        (*dot)++;
-        i++;
-    }
-    if ((*dot == 1) && (*duration == 7)) {
-        // neumatic notation
-        *duration = DURATION_breve;
-        *dot = 0;
-        LogWarning("Found a note in neumatic notation (7.), using quarter note instead");
-    }
-
-    return i - index;
-}
-
 //////////////////////////////
 //
 // getDurations --
 //
 
-int PaeInput::getDurations(const char *incipit, pae::Measure *measure, int index)
+void PaeInput::getDurations(const char *data, size_t length, pae::Measure *measure)
 {
-    int i = index;
-    size_t length = strlen(incipit);
-
     measure->durations_offset = 0;
     measure->durations.clear();
     measure->dots.clear();
 
-    // int j = 0;
-    do {
-        int dot;
-        data_DURATION dur;
-        // measure->dots.setSize(j+1);
-        i += getDuration(incipit, &dur, &dot, i);
-        measure->durations.push_back(dur);
-        measure->dots.push_back(dot);
-        // j++;
-        if ((i + 1 < length) && isdigit(incipit[i + 1])) {
-            i++;
-        }
-        else {
-            break;
+    size_t i = 0;
+    while (i < length) {
+        char c = data[i];
+        data_DURATION duration = DURATION_4;
+        switch (c) {
+            case '0': duration = DURATION_long; break;
+            case '1': duration = DURATION_1; break;
+            case '2': duration = DURATION_2; break;
+            case '3': duration = DURATION_32; break;
+            case '4': duration = DURATION_4; break;
+            case '5': duration = DURATION_64; break;
+            case '6': duration = DURATION_16; break;
+            case '7': duration = DURATION_128; break;
+            case '8': duration = DURATION_8; break;
+            case '9': duration = DURATION_breve; break;
         }
-    } while (1);
-
-    return i - index;
-}
-
-//////////////////////////////
-//
-// getAccidental --
-//
-
-int PaeInput::getAccidental(const char *incipit, data_ACCIDENTAL_EXPLICIT *accident, int index)
-{
-    int i = index;
-    size_t length = strlen(incipit);
+        i++;
 
-    if (incipit[i] == 'n') {
-        *accident = ACCIDENTAL_EXPLICIT_n;
-    }
-    else if (incipit[i] == 'x') {
-        *accident = ACCIDENTAL_EXPLICIT_s;
-        if ((i + 1 < length) && (incipit[i + 1] == 'x')) {
-            *accident = ACCIDENTAL_EXPLICIT_ss;
+        int dots = 0;
+        while ((i < length) && (data[i] == '.')) {
+            dots++;
             i++;
         }
-    }
-    else if (incipit[i] == 'b') {
-        *accident = ACCIDENTAL_EXPLICIT_f;
-        if ((i + 1 < length) && (incipit[i + 1] == 'b')) {
-            *accident = ACCIDENTAL_EXPLICIT_ff;
-            i++;
-        }
-    }
-    return i - index;
-}
-
-//////////////////////////////
-//
-// getTupletOrFermata --
-//
-
-int PaeInput::getTupletFermata(const char *incipit, pae::Note *note, int index)
-{
-    int i = index;
-    size_t length = strlen(incipit);
-
-    // detect if it is a fermata or a tuplet
-    regex_t re;
-    regcomp(&re, "^([^)]*[ABCDEFG-][^)]*[ABCDEFG-][^)]*)", REG_EXTENDED);
-    int is_tuplet = regexec(&re, incipit + i, 0, NULL, 0);
-    regfree(&re);
-
-    if (is_tuplet == 0) {
-        int t = i;
-        int t2 = 0;
-        int tuplet_val = 0;
-        char *buf;
-
-        // Triplets are in the form (4ABC)
-        // index points to the '(', so we look back
-        // if the resut is a number or dot, it means we have the long format
-        // i.e. 4(6ABC;5) or 4.(6ABC;5)
-        if ((index != 0) && (isdigit(incipit[index - 1]) || incipit[index - 1] == '.')) {
-
-            // create the buffer so we can convert the tuplet nr to int
-            buf = (char *)malloc(length + 1); // allocate it with space for 0x00
-            memset(buf, 0x00, length + 1); // wipe it up
-
-            // move until we find the ;
-            while ((t < length) && (incipit[t] != ';')) {
-
-                // we should not find any close paren before the ';' !
-                // FIXME find a graceful way to exit signaling this to user
-                if (incipit[t] == ')') {
-                    LogDebug("You have a) before the ; in a tuplet!");
-                    free(buf);
-                    return i - index;
-                }
-
-                t++;
-            }
-
-            // t + 1 should point to the number
-            t++; // move one char to the number
-            while (((t + t2) < length) && (incipit[t + t2] != ')')) {
-
-                // If we have extraneous chars, exit here
-                if (!isdigit(incipit[t + t2])) {
-                    LogDebug("You have a non-number in a tuplet number");
-                    free(buf);
-                    return i - index;
-                }
-
-                // copy the number char-by-char
-                buf[t2] = incipit[t + t2];
-                t2++;
-            }
-
-            tuplet_val = atoi(buf);
-            free(buf); // dispose of the buffer
-        }
-        else { // it is a triplet
-            // don't care to parse all the stuff
-            tuplet_val = 3;
-        }
-
-        // this is the first note, the total number of notes = tuplet_val
-        note->tuplet_notes = tuplet_val;
-        // but also the note counter
-        note->tuplet_note = tuplet_val;
-    }
-    else {
-        if (note->tuplet_notes > 0) {
-            LogWarning("Fermata within a tuplet. Won't be handled correctly");
-        }
-        note->fermata = true;
-    }
-
-    return i - index;
-}
-
-//////////////////////////////
-//
-// getTupletFermataEnd --
-//
-// this can be deleted in the future?
-int PaeInput::getTupletFermataEnd(const char *incipit, pae::Note *note, int index)
-{
-    int i = index;
-    // int length = strlen(incipit);
-
-    // TODO: fermatas inside tuplets won't be currently handled correctly
-    note->fermata = false;
-
-    return i - index;
-}
-
-//////////////////////////////
-//
-// getGraceNote --
-//
-
-int PaeInput::getGraceNote(const char *incipit, pae::Note *note, int index)
-{
-    int i = index;
-    size_t length = strlen(incipit);
-
-    // acciaccatura
-    if (incipit[i] == 'g') {
-        note->acciaccatura = true;
-    }
-
-    // appoggiatura
-    else if (incipit[i] == 'q') {
-        note->appoggiatura = 1;
-        if ((i + 1 < length) && (incipit[i + 1] == 'q')) {
-            i++;
-            int r = i;
-            while ((r < length) && (incipit[r] != 'r')) {
-                if ((incipit[r] - 'A' >= 0) && (incipit[r] - 'A' < 7)) {
-                    note->appoggiatura++;
-                }
-                r++;
-            }
+        if ((dots == 1) && (c == '7')) {
+            // neumatic notation
+            duration = DURATION_4;
+            dots = 0;
+            LogWarning("Found a note in neumatic notation (7.), using quarter note instead");
         }
+        measure->durations.push_back(duration);
+        measure->dots.push_back(dots);
     }
-    return i - index;
 }
 
 //////////////////////////////
@@ -688,107 +721,70 @@ data_PITCHNAME PaeInput::getPitch(char c_note)
 
 //////////////////////////////
 //
-// getTimeInfo -- read the key signature.
+// getTimeInfo -- read the time signature.
 //
 
-int PaeInput::getTimeInfo(const char *incipit, MeterSig *meter, int index)
+void PaeInput::getTimeInfo(const char *data, size_t length, MeterSig *meter)
 {
-    int i = index;
-    size_t length = strlen(incipit);
-
-    if (!isdigit(incipit[i]) && (incipit[i] != 'c') && (incipit[i] != 'o')) {
-        return 0;
+    if (length == 0) {
+        return;
     }
 
-    // find the end of time signature
-    i++; // the time signature length is a least 1
-    while (i < length) {
-        if (!isdigit(incipit[i]) && (incipit[i] != '/') && (incipit[i] != '.')) {
-            break;
+    std::string timesig(data, length);
+    const char *digits = "0123456789";
+    size_t slash = timesig.find('/');
+
+    // check if format X/X or one number only
+    if ((slash != std::string::npos) && (timesig.find_first_not_of(digits) == slash)
+        && (timesig.find_first_not_of(digits, slash + 1) == std::string::npos)) {
+        if ((slash == 0) || (slash + 1 == timesig.size())) {
+            LogWarning("Incomplete time signature: %s", timesig.c_str());
+        }
+        else {
+            meter->SetCount(atoi(timesig.c_str()));
+            meter->SetUnit(atoi(timesig.c_str() + slash + 1));
         }
-        i++;
     }
-
-    // use a substring for the time signature
-    char timesig_str[1024];
-    memset(timesig_str, 0, 1024);
-    // strncpy not always put the \0 in the end!
-    strncpy(timesig_str, incipit + index, i - index);
-
-    std::ostringstream sout;
-    regex_t re;
-
-    // check if format X/X or one digit only
-    regcomp(&re, "^[0-9]*/[0-9]*$", REG_EXTENDED);
-    int is_standard = regexec(&re, timesig_str, 0, NULL, 0);
-    regfree(&re);
-    regcomp(&re, "^[0-9]*$", REG_EXTENDED);
-    int is_one_number = regexec(&re, timesig_str, 0, NULL, 0);
-    regfree(&re);
-
-    if (is_standard == 0) {
-        char buf_str[1024];
-        strcpy(buf_str, timesig_str);
-        int beats = atoi(strtok(buf_str, "/"));
-        int note_value = atoi(strtok(NULL, "/"));
-        meter->SetCount(beats);
-        meter->SetUnit(note_value);
-    }
-    else if (is_one_number == 0) {
-        int beats = atoi(timesig_str);
-        meter->SetCount(beats);
-    }
-    else if (strcmp(timesig_str, "c") == 0) {
+    else if (timesig.find_first_not_of(digits) == std::string::npos) {
+        meter->SetCount(atoi(timesig.c_str()));
+    }
+    else if (timesig == "c") {
         // C
         meter->SetSym(METERSIGN_common);
     }
-    else if (strcmp(timesig_str, "c/") == 0) {
+    else if (timesig == "c/") {
         // C|
         meter->SetSym(METERSIGN_cut);
     }
-    else if (strcmp(timesig_str, "c3") == 0) {
+    else if (timesig == "c3") {
         // C3
         meter->SetSym(METERSIGN_common);
         meter->SetCount(3);
     }
-    else if (strcmp(timesig_str, "c3/2") == 0) {
+    else if (timesig == "c3/2") {
         // C3/2
         meter->SetSym(METERSIGN_common); // ??
         meter->SetCount(3);
         meter->SetUnit(2);
     }
     else {
-        LogWarning("Unknown time signature: %s", timesig_str);
+        LogWarning("Unknown time signature: %s", timesig.c_str());
     }
-
-    return i - index;
 }
 
 //////////////////////////////
 //
-// getClefInfo -- read the key signature.
+// getClefInfo -- read the clef.
 //
 
-int PaeInput::getClefInfo(const char *incipit, Clef *mclef, int index)
+void PaeInput::getClefInfo(const char *data, size_t length, Clef *mclef)
 {
     // a clef is maximum 3 character length
     // go through the 3 character and retrieve the letter (clef) and the line
     // mensural clef (with + in between) currently ignored
     // clef with octava correct?
-    size_t length = strlen(incipit);
-    int i = 0;
-    char clef = 'G';
-    char line = '2';
-    while ((index < length) && (i < 3)) {
-        if (i == 0) {
-            clef = incipit[index];
-        }
-        else if (i == 2) {
-            line = incipit[index];
-        }
-        i++;
-        index++;
-    }
+    char clef = (length > 0) ? data[0] : 'G';
+    char line = (length > 2) ? data[2] : '2';
 
     if (clef == 'C' || clef == 'c') {
         mclef->SetShape(CLEFSHAPE_C);
@@ -812,88 +808,6 @@ int PaeInput::getClefInfo(const char *incipit, Clef *mclef, int index)
         // what the...
         LogDebug("Clef %c is Undefined", clef);
     }
-
-    // measure->clef = mclef;
-
-    return i;
-}
-
-//////////////////////////////
-//
-// getWholeRest -- read the getWholeRest.
-//
-
-int PaeInput::getWholeRest(const char *incipit, int *wholerest, int index)
-{
-    size_t length = strlen(incipit);
-    int i = index;
-
-    *wholerest = 1;
-    if ((i + 1 < length) && isdigit(incipit[i + 1])) {
-        sscanf(&(incipit[i + 1]), "%d", wholerest);
-        char buf[10];
-        memset(buf, 0, 10);
-        sprintf(buf, "%d", *wholerest);
-        i += strlen(buf);
-    }
-    return i - index;
-}
-
-/**********************************
- *
- * getBarLine -- read the barLine.
- * Translation from PAE to verovio representaion:
- *
- BARRENDITION_single     /
- BARRENDITION_end        does not exist
- BARRENDITION_rptboth    ://:
- BARRENDITION_rptend     ://
- BARRENDITION_rptstart   //:
- BARRENDITION_dbl        //
- */
-
-int PaeInput::getBarLine(const char *incipit, data_BARRENDITION *output, int index)
-{
-    regex_t re;
-
-    regcomp(&re, "^://:", REG_EXTENDED);
-    int is_barline_rptboth = regexec(&re, incipit + index, 0, NULL, 0);
-    regfree(&re);
-
-    regcomp(&re, "^://", REG_EXTENDED);
-    int is_barline_rptend = regexec(&re, incipit + index, 0, NULL, 0);
-    regfree(&re);
-
-    regcomp(&re, "^//:", REG_EXTENDED);
-    int is_barline_rptstart = regexec(&re, incipit + index, 0, NULL, 0);
-    regfree(&re);
-
-    regcomp(&re, "^//", REG_EXTENDED);
-    int is_barline_dbl = regexec(&re, incipit + index, 0, NULL, 0);
-    regfree(&re);
-
-    int i = 0; // number of characters
-    if (is_barline_rptboth == 0) {
-        *output = BARRENDITION_rptboth;
-        i = 3;
-    }
-    else if (is_barline_rptstart == 0) {
-        *output = BARRENDITION_rptstart;
-        i = 2;
-    }
-    else if (is_barline_rptend == 0) {
-        *output = BARRENDITION_rptend;
-        i = 2;
-    }
-    else if (is_barline_dbl == 0) {
-        *output = BARRENDITION_dbl;
-        i = 1;
-    }
-    else {
-        *output = BARRENDITION_single;
-        i = 0;
-    }
-    return i;
 }
 
 //////////////////////////////
@@ -901,27 +815,20 @@ int PaeInput::getBarLine(const char *incipit, data_BARRENDITION *output, int ind
 // getAbbreviation -- read abbreviation
 //
 
-int PaeInput::getAbbreviation(const char *incipit, pae::Measure *measure, int index)
+void PaeInput::getAbbreviation(int repeats, pae::Measure *measure)
 {
-    size_t length = strlen(incipit);
-    int i = index;
-    int j;
-
     if (measure->abbreviation_offset == -1) { // start
         measure->abbreviation_offset = (int)measure->notes.size();
     }
-    else { //
+    else {
         int abbreviation_stop = (int)measure->notes.size();
-        while ((i + 1 < length) && (incipit[i + 1] == 'f')) {
-            i++;
-            for (j = measure->abbreviation_offset; j < abbreviation_stop; j++) {
+        for (int i = 0; i < repeats; i++) {
+            for (int j = measure->abbreviation_offset; j < abbreviation_stop; j++) {
                 measure->notes.push_back(measure->notes[j]);
             }
         }
         measure->abbreviation_offset = -1;
     }
-
-    return i - index;
 }
 
 //////////////////////////////
@@ -929,20 +836,16 @@ int PaeInput::getAbbreviation(const char *incipit, pae::Measure *measure, int in
 // getKeyInfo -- read the key signature.
 //
 
-int PaeInput::getKeyInfo(const char *incipit, KeySig *key, int index)
+void PaeInput::getKeyInfo(const char *data, size_t length, KeySig *key)
 {
     int alt_nr = 0;
 
     // at the key information line, extract data
-    size_t length = strlen(incipit);
-    int i = index;
-    bool end_of_keysig = false;
-    while ((i < length) && (!end_of_keysig)) {
-        switch (incipit[i]) {
+    for (size_t i = 0; i < length; i++) {
+        switch (data[i]) {
             case 'b': key->SetAlterationType(ACCIDENTAL_EXPLICIT_f); break;
             case 'x': key->SetAlterationType(ACCIDENTAL_EXPLICIT_s); break;
             case 'n': key->SetAlterationType(ACCIDENTAL_EXPLICIT_n); break;
-            case '[': break;
             case 'F':
             case 'C':
             case 'G':
@@ -950,9 +853,8 @@ int PaeInput::getKeyInfo(const char *incipit, KeySig *key, int index)
             case 'A':
             case 'E':
             case 'B': alt_nr++; break;
-            default: end_of_keysig = true; break;
+            default: break;
         }
-        if (!end_of_keysig) i++;
     }
 
     if (key->GetAlterationType() != ACCIDENTAL_EXPLICIT_n) {
@@ -960,8 +862,6 @@ int PaeInput::getKeyInfo(const char *incipit, KeySig *key, int index)
     }
 
     key->ConvertToMei();
-
-    return i - index;
 }
 
 //////////////////////////////
@@ -969,11 +869,9 @@ int PaeInput::getKeyInfo(const char *incipit, KeySig *key, int index)
 // getNote --
 //
 
-int PaeInput::getNote(const char *incipit, pae::Note *note, pae::Measure *measure, int index)
+void PaeInput::getNote(const pae::Token &token, char c_note, pae::Note *note, pae::Measure *measure)
 {
-    regex_t re;
     int oct;
-    int i = index;
     bool acc;
     int app;
     int tuplet_num;
@@ -987,14 +885,14 @@ int PaeInput::getNote(const char *incipit, pae::Note *note, pae::Measure *measur
         if (measure->durations.size() == 0) {
             note->duration = DURATION_4;
             note->dots = 0;
-            LogWarning("Got a note before a duration was specified");
+            LogWarning("Got a note before a duration was specified at position %d", (int)token.position + 1);
         }
         else {
             note->duration = measure->durations[measure->durations_offset];
             note->dots = measure->dots[measure->durations_offset];
         }
     }
-    note->pitch = getPitch(incipit[i]);
+    note->pitch = getPitch(c_note);
 
     // lookout, hack. If it is a rest (PITCHNAME_NONE val) then create the rest object.
     // it will be added instead of the note
@@ -1002,27 +900,14 @@ int PaeInput::getNote(const char *incipit, pae::Note *note, pae::Measure *measur
         note->rest = true;
     }
 
-    // trills
-    regcomp(&re, "^[^ABCDEFG]*t", REG_EXTENDED);
-    int has_trill = regexec(&re, incipit + i + 1, 0, NULL, 0);
-    regfree(&re);
-    if (has_trill == 0) {
+    // trills, ties and chords are given by the characters following the note
+    if (token.trill) {
         note->trill = true;
     }
-
-    // tie
-    regcomp(&re, "^[^ABCDEFG]*\\+", REG_EXTENDED);
-    int has_tie = regexec(&re, incipit + i + 1, 0, NULL, 0);
-    regfree(&re);
-    if (has_tie == 0) {
+    if (token.tie) {
         if (note->tie == 0) note->tie = 1; // reset 1 for the first note, >1 for next ones is incremented under
     }
-
-    // chord
-    regcomp(&re, "^[^ABCDEFG]*\\^", REG_EXTENDED);
-    int is_chord = regexec(&re, incipit + i + 1, 0, NULL, 0);
-    regfree(&re);
-    if (is_chord == 0) {
+    if (token.chord) {
         note->chord = true;
     }
 
@@ -1061,8 +946,6 @@ int PaeInput::getNote(const char *incipit, pae::Note *note, pae::Measure *measur
 
     note->fermata = false; // only one note per fermata;
     note->trill = false;
-
-    return i - index;
 }
 
 //////////////////////////////
@@ -1290,77 +1173,42 @@ void PaeInput::addLayerElement(LayerElement *element)
 //   only one per line
 //
 
-void PaeInput::getAtRecordKeyValue(char *key, char *value, const char *input)
+void PaeInput::getAtRecordKeyValue(const std::string &line, std::string &key, std::string &value)
 {
+    const char MARKER = '@';
+    const char SEPARATOR = ':';
 
-#define SKIPSPACE                                                                                                      \
-    while ((index < length) && isspace(input[index])) {                                                                \
-        index++;                                                                                                       \
-    }
-
-    char MARKER = '@';
-    char SEPARATOR = ':';
-    char EMPTY = '\0';
-
-    size_t length = strlen(input);
-    int count = 0;
+    key.clear();
+    value.clear();
 
-    // zero out strings
-    memset(key, EMPTY, MAX_DATA_LEN);
-    memset(value, EMPTY, MAX_DATA_LEN);
-
-    if (length == 0) {
-        return;
-    }
-
-    char ch;
-    int index = 0;
+    size_t length = line.size();
+    size_t index = 0;
 
     // find starting @ symbol (ignoring any starting space)
-    SKIPSPACE
-    if (input[index] != MARKER) {
+    while ((index < length) && isspace(line[index])) index++;
+    if ((index == length) || (line[index] != MARKER)) {
         // invalid record format since it does not start with @
         return;
     }
     index++;
-    SKIPSPACE
-
-    // start storing the key value:
-    while ((index < length) && (input[index] != SEPARATOR)) {
-        if (isspace(input[index])) {
-            continue;
-        }
-        ch = input[index];
-
-        // Should never happen
-        if (count >= MAX_DATA_LEN) return;
 
-        key[count] = ch;
-        count++;
+    // store the key value, ignoring the spaces
+    while ((index < length) && (line[index] != SEPARATOR)) {
+        if (!isspace(line[index])) key.push_back(line[index]);
         index++;
     }
     // check to see if valid format: (:) must be the current character
-    if (input[index] != SEPARATOR) {
-        key[0] = EMPTY;
+    if (index == length) {
+        key.clear();
         return;
     }
     index++;
-    SKIPSPACE
+    while ((index < length) && isspace(line[index])) index++;
 
-    // Also should never happen
-    if (strlen(&input[index]) > MAX_DATA_LEN) return;
-
-    strcpy(value, &input[index]);
-
-    // Truncate string to first space
-    size_t i;
-    for (i = strlen(value) - 2; i > 0; i--) {
-        if (isspace(value[i])) {
-            value[i] = EMPTY;
-            continue;
-        }
-        break;
-    }
+    // the value without the trailing spaces and line ending
+    size_t end = length;
+    while ((end > index) && isspace(line[end - 1])) end--;
+    value = line.substr(index, end - index);
 }
 
 #endif // NO_PAE_SUPPORT
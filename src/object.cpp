@@ -9,6 +9,7 @@
 
 #include <assert.h>
 #include <iostream>
+#include <random>
 #include <sstream>
 
 //----------------------------------------------------------------------------
@@ -478,9 +479,21 @@ void Object::RemoveChildAt(int idx)
     m_children.erase(iter + (idx));
 }
 
+/** The uuid generator of the thread (if seeded) */
+thread_local bool threadUuidSeeded = false;
+thread_local std::minstd_rand threadUuidGenerator;
+
+void Object::SeedThreadUuids(unsigned int seed)
+{
+    threadUuidSeeded = (seed != 0);
+    if (threadUuidSeeded) {
+        threadUuidGenerator.seed(seed);
+    }
+}
+
 void Object::GenerateUuid()
 {
-    int nr = std::rand();
+    int nr = threadUuidSeeded ? (int)threadUuidGenerator() : std::rand();
     char str[17];
     // I do not want to use a stream for doing this!
     snprintf(str, 16, "%016d", nr);
@@ -26,6 +26,8 @@ namespace vrv {
 // Page
 //----------------------------------------------------------------------------
 
+std::atomic<int> Page::s_layoutRevision(0);
+
 Page::Page() : Object("page-")
 {
     Reset();
@@ -41,6 +43,7 @@ void Page::Reset()
 
     m_drawingScoreDef.Reset();
     m_layoutDone = false;
+    this->ModifyLayout();
     this->ResetUuid();
 
     // by default we have no values and use the document ones
@@ -87,7 +90,27 @@ void Page::LayOut(bool force)
     m_layoutDone = true;
 }
 
+int Page::GetLongestActualDur()
+{
+    int longestActualDur = DUR_4;
+    // Get the longest duration in the piece
+    AttDurExtreme durExtremeComparison(LONGEST);
+    Object *longestDur = this->FindChildExtremeByAttComparison(&durExtremeComparison);
+    if (longestDur) {
+        DurationInterface *interface = longestDur->GetDurationInterface();
+        assert(interface);
+        longestActualDur = interface->GetActualDur();
+        // LogDebug("Longest duration is DUR_* code %d", longestActualDur);
+    }
+    return longestActualDur;
+}
+
 void Page::LayOutHorizontally()
+{
+    this->LayOutHorizontally(this->GetLongestActualDur());
+}
+
+void Page::LayOutHorizontally(int longestActualDur)
 {
     Doc *doc = dynamic_cast<Doc *>(m_parent);
     assert(doc);
@@ -122,17 +145,6 @@ void Page::LayOutHorizontally()
     // Unless duration-based spacing is disabled, set the X position of each Alignment.
     // Does non-linear spacing based on the duration space between two Alignment objects.
     if (!doc->GetEvenSpacing()) {
-        int longestActualDur;
-        // Get the longest duration in the piece
-        AttDurExtreme durExtremeComparison(LONGEST);
-        Object *longestDur = this->FindChildExtremeByAttComparison(&durExtremeComparison);
-        if (longestDur) {
-            DurationInterface *interface = longestDur->GetDurationInterface();
-            assert(interface);
-            longestActualDur = interface->GetActualDur();
-            // LogDebug("Longest duration is DUR_* code %d", longestActualDur);
-        }
-
         params.clear();
         double previousTime = 0.0;
         int previousXRel = 0;
@@ -146,6 +158,9 @@ void Page::LayOutHorizontally()
         this->Process(&setAlignmentX, &params);
     }
 
+    // Positions have changed since the last drawing
+    this->ModifyLayout();
+
     // Render it for filling the bounding box
     View view;
     BBoxDeviceContext bBoxDC(&view, 0, 0, BBOX_HORIZONTAL_ONLY);
@@ -205,6 +220,8 @@ void Page::LayOutHorizontally()
     Functor alignMeasures(&Object::AlignMeasures);
     Functor alignMeasuresEnd(&Object::AlignMeasuresEnd);
     this->Process(&alignMeasures, &params, &alignMeasuresEnd);
+
+    this->ModifyLayout();
 }
 
 void Page::LayOutVertically()
@@ -235,6 +252,9 @@ void Page::LayOutVertically()
     Functor alignVertically(&Object::AlignVertically);
     this->Process(&alignVertically, &params);
 
+    // Positions have changed since the last drawing
+    this->ModifyLayout();
+
     // Render it for filling the bounding box
     View view;
     BBoxDeviceContext bBoxDC(&view, 0, 0);
@@ -304,6 +324,8 @@ void Page::LayOutVertically()
     Functor alignSystems(&Object::AlignSystems);
     Functor alignSystemsEnd(&Object::AlignSystemsEnd);
     this->Process(&alignSystems, &params, &alignSystemsEnd);
+
+    this->ModifyLayout();
 }
 
 void Page::JustifyHorizontally()
@@ -335,6 +357,13 @@ void Page::JustifyHorizontally()
     // Special case: because we redirect the functor, pass it as parameter to itself (!)
     params.push_back(&justifyX);
     this->Process(&justifyX, &params);
+
+    this->ModifyLayout();
+}
+
+void Page::ModifyLayout()
+{
+    m_layoutRevision = ++s_layoutRevision;
 }
 
 int Page::GetContentHeight() const
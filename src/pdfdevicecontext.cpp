@@ -0,0 +1,872 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        pdfdevicecontext.cpp
+// Author:      agent
+// Created:     19/10/2026
+// Copyright (c) Authors and others. All rights reserved.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "pdfdevicecontext.h"
+
+//----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <assert.h>
+#include <ctype.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//----------------------------------------------------------------------------
+
+#include "glyph.h"
+#include "vrv.h"
+
+//----------------------------------------------------------------------------
+
+#include "pugixml.hpp"
+
+namespace vrv {
+
+// The size of the pages is given in tenths of millimeters at 100%
+#define PDF_POINTS_PER_UNIT (72.0 / 254.0)
+// The size of the chunks of page content written to the output
+#define PDF_BUFFER_SIZE 65536
+
+// The objects written when the document is finished
+#define PDF_CATALOG_OBJECT 1
+#define PDF_PAGES_OBJECT 2
+#define PDF_RESOURCES_OBJECT 3
+
+static const char *pdfFontNames[4] = { "Times-Roman", "Times-Italic", "Times-Bold", "Times-BoldItalic" };
+
+/**
+ * Map a character to the WinAnsiEncoding of the standard fonts.
+ * Latin-1 is the same and only the most common punctuation is mapped otherwise.
+ */
+static unsigned char ToWinAnsi(wchar_t c)
+{
+    if ((c < 0x80) || ((c >= 0xA0) && (c < 0x100))) return (unsigned char)c;
+    switch (c) {
+        case 0x2013: return 0x96; // en dash
+        case 0x2014: return 0x97; // em dash
+        case 0x2018: return 0x91;
+        case 0x2019: return 0x92;
+        case 0x201C: return 0x93;
+        case 0x201D: return 0x94;
+        case 0x2022: return 0x95; // bullet
+        case 0x2026: return 0x85; // ellipsis
+        case 0x20AC: return 0x80; // euro
+        default: return '?';
+    }
+}
+
+//----------------------------------------------------------------------------
+// PdfDeviceContext
+//----------------------------------------------------------------------------
+
+PdfDeviceContext::PdfDeviceContext(std::ostream &output) : DeviceContext(), m_output(output)
+{
+    m_offset = 0;
+    m_contentObject = 0;
+    m_contentLengthObject = 0;
+    m_contentStart = 0;
+    m_textAlignment = LEFT;
+    for (int i = 0; i < 4; i++) m_fontObjects[i] = 0;
+    m_finished = false;
+
+    this->Reset(0, 0);
+}
+
+PdfDeviceContext::~PdfDeviceContext()
+{
+}
+
+void PdfDeviceContext::Reset(int width, int height)
+{
+    m_width = width;
+    m_height = height;
+
+    m_userScaleX = 1.0;
+    m_userScaleY = 1.0;
+    m_originX = 0;
+    m_originY = 0;
+
+    m_penStack = std::stack<Pen>();
+    m_brushStack = std::stack<Brush>();
+    m_fontStack = std::stack<FontInfo *>();
+    SetBrush(AxBLACK, AxSOLID);
+    SetPen(AxBLACK, 1, AxSOLID);
+}
+
+void PdfDeviceContext::Write(const std::string &data)
+{
+    m_buffer += data;
+    if (m_buffer.size() > PDF_BUFFER_SIZE) this->Flush();
+}
+
+void PdfDeviceContext::Flush()
+{
+    m_output.write(m_buffer.data(), m_buffer.size());
+    m_offset += m_buffer.size();
+    m_buffer.clear();
+}
+
+int PdfDeviceContext::AddObject()
+{
+    m_objectOffsets.push_back(0);
+    return (int)m_objectOffsets.size();
+}
+
+void PdfDeviceContext::StartObject(int object)
+{
+    assert((object > 0) && (object <= (int)m_objectOffsets.size()));
+
+    m_objectOffsets.at(object - 1) = m_offset + m_buffer.size();
+    this->Write(StringFormat("%d 0 obj\n", object));
+}
+
+void PdfDeviceContext::AppendNumber(std::string &output, double value)
+{
+    char number[32];
+    snprintf(number, sizeof(number), "%.4f", value);
+    // remove the trailing zeros and the decimal point when not needed
+    char *end = number + strlen(number) - 1;
+    while (*end == '0') *(end--) = '\0';
+    if (*end == '.') *end = '\0';
+    if (strcmp(number, "-0") == 0) strcpy(number, "0");
+    output += number;
+}
+
+void PdfDeviceContext::AppendPoint(double x, double y)
+{
+    // the origin is given by the transformation of the page
+    AppendNumber(m_buffer, x);
+    m_buffer += ' ';
+    AppendNumber(m_buffer, y);
+    m_buffer += ' ';
+}
+
+void PdfDeviceContext::AppendTextString(const std::wstring &text)
+{
+    m_buffer += '(';
+    for (size_t i = 0; i < text.size(); i++) {
+        unsigned char c = ToWinAnsi(text[i]);
+        if ((c == '(') || (c == ')') || (c == '\\')) {
+            m_buffer += '\\';
+            m_buffer += (char)c;
+        }
+        else if ((c < 32) || (c > 126)) {
+            m_buffer += StringFormat("\\%03o", c);
+        }
+        else {
+            m_buffer += (char)c;
+        }
+    }
+    m_buffer += ')';
+}
+
+void PdfDeviceContext::SetFillColour(int colour)
+{
+    if (colour == m_fillColour) return;
+    AppendNumber(m_buffer, ((colour >> 16) & 0xFF) / 255.0);
+    m_buffer += ' ';
+    AppendNumber(m_buffer, ((colour >> 8) & 0xFF) / 255.0);
+    m_buffer += ' ';
+    AppendNumber(m_buffer, (colour & 0xFF) / 255.0);
+    m_buffer += " rg\n";
+    m_fillColour = colour;
+}
+
+void PdfDeviceContext::SetStrokeColour(int colour)
+{
+    if (colour == m_strokeColour) return;
+    AppendNumber(m_buffer, ((colour >> 16) & 0xFF) / 255.0);
+    m_buffer += ' ';
+    AppendNumber(m_buffer, ((colour >> 8) & 0xFF) / 255.0);
+    m_buffer += ' ';
+    AppendNumber(m_buffer, (colour & 0xFF) / 255.0);
+    m_buffer += " RG\n";
+    m_strokeColour = colour;
+}
+
+void PdfDeviceContext::SetLineWidth(int width)
+{
+    if (width == m_lineWidth) return;
+    AppendNumber(m_buffer, width);
+    m_buffer += " w\n";
+    m_lineWidth = width;
+}
+
+void PdfDeviceContext::SetPaint(bool &fill, bool &stroke)
+{
+    assert(m_penStack.size());
+    assert(m_brushStack.size());
+
+    fill = (m_brushStack.top().GetOpacity() > 0.0);
+    // a line width of 0 is the thinnest line in PDF but nothing in SVG
+    stroke = (m_penStack.top().GetOpacity() > 0.0) && (m_penStack.top().GetWidth() > 0);
+
+    if (fill) this->SetFillColour(m_brushStack.top().GetColour());
+    if (stroke) {
+        this->SetStrokeColour(m_penStack.top().GetColour());
+        this->SetLineWidth(m_penStack.top().GetWidth());
+    }
+}
+
+void PdfDeviceContext::PaintPath(bool close, bool fill, bool stroke)
+{
+    if (fill && stroke)
+        m_buffer += (close) ? "b\n" : "B\n";
+    else if (fill)
+        m_buffer += "f\n";
+    else if (stroke)
+        m_buffer += (close) ? "s\n" : "S\n";
+    else
+        m_buffer += "n\n";
+
+    if (m_buffer.size() > PDF_BUFFER_SIZE) this->Flush();
+}
+
+void PdfDeviceContext::AppendArc(double xc, double yc, double rx, double ry, double start, double end)
+{
+    // no more than a quarter of ellipse by curve
+    int n = std::max(1, (int)ceil(fabs(end - start) / (M_PI / 2.0) - 1e-9));
+    double step = (end - start) / n;
+    double k = 4.0 / 3.0 * tan(step / 4.0);
+    // the angles are counter-clockwise and the y axis goes down
+    for (int i = 0; i < n; i++) {
+        double a0 = start + i * step;
+        double a1 = a0 + step;
+        this->AppendPoint(xc + rx * (cos(a0) - k * sin(a0)), yc - ry * (sin(a0) + k * cos(a0)));
+        this->AppendPoint(xc + rx * (cos(a1) + k * sin(a1)), yc - ry * (sin(a1) - k * cos(a1)));
+        this->AppendPoint(xc + rx * cos(a1), yc - ry * sin(a1));
+        m_buffer += "c ";
+    }
+}
+
+void PdfDeviceContext::StartPage()
+{
+    assert(!m_finished);
+
+    if (m_objectOffsets.empty()) {
+        // the binary comment tells that the file is not text
+        this->Write("%PDF-1.4\n%\xE2\xE3\xCF\xD3\n");
+        this->AddObject(); // PDF_CATALOG_OBJECT
+        this->AddObject(); // PDF_PAGES_OBJECT
+        this->AddObject(); // PDF_RESOURCES_OBJECT
+    }
+
+    // the length of the content is written after it
+    m_contentObject = this->AddObject();
+    m_contentLengthObject = this->AddObject();
+    this->StartObject(m_contentObject);
+    this->Write(StringFormat("<< /Length %d 0 R >>\nstream\n", m_contentLengthObject));
+    this->Flush();
+    m_contentStart = m_offset;
+
+    // the default graphic state
+    m_fillColour = AxBLACK;
+    m_strokeColour = AxBLACK;
+    m_lineWidth = 1;
+
+    // the coordinates are logical with the y axis going down from the top of the page
+    double scaleX = m_userScaleX / DEFINITON_FACTOR * PDF_POINTS_PER_UNIT;
+    double scaleY = m_userScaleY / DEFINITON_FACTOR * PDF_POINTS_PER_UNIT;
+    AppendNumber(m_buffer, scaleX);
+    m_buffer += " 0 0 ";
+    AppendNumber(m_buffer, -scaleY);
+    m_buffer += ' ';
+    AppendNumber(m_buffer, m_originX * scaleX);
+    m_buffer += ' ';
+    AppendNumber(m_buffer, m_height * m_userScaleY * PDF_POINTS_PER_UNIT - m_originY * scaleY);
+    m_buffer += " cm\n";
+}
+
+void PdfDeviceContext::EndPage()
+{
+    this->Flush();
+    size_t length = m_offset - m_contentStart;
+    this->Write("\nendstream\nendobj\n");
+
+    this->StartObject(m_contentLengthObject);
+    this->Write(StringFormat("%lu\nendobj\n", (unsigned long)length));
+
+    int page = this->AddObject();
+    this->StartObject(page);
+    std::string pageDict = StringFormat("<< /Type /Page /Parent %d 0 R /MediaBox [0 0 ", PDF_PAGES_OBJECT);
+    AppendNumber(pageDict, m_width * m_userScaleX * PDF_POINTS_PER_UNIT);
+    pageDict += ' ';
+    AppendNumber(pageDict, m_height * m_userScaleY * PDF_POINTS_PER_UNIT);
+    pageDict += StringFormat("] /Resources %d 0 R /Contents %d 0 R >>\nendobj\n", PDF_RESOURCES_OBJECT, m_contentObject);
+    this->Write(pageDict);
+    m_pageObjects.push_back(page);
+
+    this->Flush();
+}
+
+void PdfDeviceContext::Finish()
+{
+    if (m_finished) return;
+
+    // a document without pages still needs its objects
+    if (m_objectOffsets.empty()) {
+        this->Write("%PDF-1.4\n%\xE2\xE3\xCF\xD3\n");
+        this->AddObject();
+        this->AddObject();
+        this->AddObject();
+    }
+
+    std::vector<std::pair<std::string, int> >::iterator glyphIt;
+    for (glyphIt = m_glyphs.begin(); glyphIt != m_glyphs.end(); ++glyphIt) {
+        this->WriteGlyph(glyphIt->first, glyphIt->second);
+    }
+
+    std::string resources = "<< /ProcSet [/PDF /Text]";
+    if (!m_glyphs.empty()) {
+        resources += " /XObject <<";
+        for (int i = 0; i < (int)m_glyphs.size(); i++) {
+            resources += StringFormat(" /G%d %d 0 R", i, m_glyphs.at(i).second);
+        }
+        resources += " >>";
+    }
+    std::string fonts;
+    for (int i = 0; i < 4; i++) {
+        if (m_fontObjects[i] == 0) continue;
+        this->StartObject(m_fontObjects[i]);
+        this->Write(StringFormat(
+            "<< /Type /Font /Subtype /Type1 /BaseFont /%s /Encoding /WinAnsiEncoding >>\nendobj\n", pdfFontNames[i]));
+        fonts += StringFormat(" /F%d %d 0 R", i, m_fontObjects[i]);
+    }
+    if (!fonts.empty()) {
+        resources += " /Font <<" + fonts + " >>";
+    }
+    resources += " >>\nendobj\n";
+    this->StartObject(PDF_RESOURCES_OBJECT);
+    this->Write(resources);
+
+    std::string pages = "<< /Type /Pages /Kids [";
+    std::vector<int>::iterator pageIt;
+    for (pageIt = m_pageObjects.begin(); pageIt != m_pageObjects.end(); ++pageIt) {
+        pages += StringFormat(" %d 0 R", *pageIt);
+    }
+    pages += StringFormat(" ] /Count %d >>\nendobj\n", (int)m_pageObjects.size());
+    this->StartObject(PDF_PAGES_OBJECT);
+    this->Write(pages);
+
+    this->StartObject(PDF_CATALOG_OBJECT);
+    this->Write(StringFormat("<< /Type /Catalog /Pages %d 0 R >>\nendobj\n", PDF_PAGES_OBJECT));
+
+    // the cross-reference table has entries of 20 bytes
+    size_t xref = m_offset + m_buffer.size();
+    std::string table = StringFormat("xref\n0 %d\n0000000000 65535 f \n", (int)m_objectOffsets.size() + 1);
+    std::vector<size_t>::iterator offsetIt;
+    for (offsetIt = m_objectOffsets.begin(); offsetIt != m_objectOffsets.end(); ++offsetIt) {
+        table += StringFormat("%010lu 00000 n \n", (unsigned long)*offsetIt);
+    }
+    table += StringFormat("trailer\n<< /Size %d /Root %d 0 R >>\nstartxref\n%lu\n%%%%EOF\n",
+        (int)m_objectOffsets.size() + 1, PDF_CATALOG_OBJECT, (unsigned long)xref);
+    this->Write(table);
+    this->Flush();
+
+    m_finished = true;
+}
+
+void PdfDeviceContext::WriteGlyph(const std::string &path, int object)
+{
+    std::string content;
+    double minX = 0.0, minY = 0.0, maxX = 0.0, maxY = 0.0;
+    bool first = true;
+
+    pugi::xml_document doc;
+    if (!doc.load_file(path.c_str())) {
+        LogError("Font file '%s' could not be loaded", path.c_str());
+    }
+    pugi::xpath_node_set paths = doc.select_nodes("//path");
+    for (pugi::xpath_node_set::const_iterator it = paths.begin(); it != paths.end(); ++it) {
+        pugi::xml_node pathNode = it->node();
+        // the form is drawn upwards - the glyphs are normally drawn upside down in a <g transform="scale(1,-1)">
+        double flip = (std::string(pathNode.parent().attribute("transform").value()) == "scale(1,-1)") ? 1.0 : -1.0;
+
+        // convert the SVG path data, with the quadratic curves as cubic ones
+        double args[7];
+        double cx = 0.0, cy = 0.0, startX = 0.0, startY = 0.0, ctrlX = 0.0, ctrlY = 0.0;
+        char command = 0, previous = 0;
+        const char *c = pathNode.attribute("d").value();
+        while (*c) {
+            while (*c && (isspace((unsigned char)*c) || (*c == ','))) c++;
+            if (!*c) break;
+            if (isalpha((unsigned char)*c)) {
+                command = *c++;
+                if (toupper(command) == 'Z') {
+                    content += "h\n";
+                    cx = startX;
+                    cy = startY;
+                    previous = command;
+                    continue;
+                }
+            }
+            int count = 0;
+            switch (toupper(command)) {
+                case 'M':
+                case 'L':
+                case 'T': count = 2; break;
+                case 'H':
+                case 'V': count = 1; break;
+                case 'C': count = 6; break;
+                case 'S':
+                case 'Q': count = 4; break;
+                case 'A': count = 7; break;
+                default: LogWarning("Unsupported path command '%c' in '%s'", command, path.c_str()); c = ""; continue;
+            }
+            int i;
+            for (i = 0; i < count; i++) {
+                while (*c && (isspace((unsigned char)*c) || (*c == ','))) c++;
+                char *end;
+                args[i] = strtod(c, &end);
+                if (end == c) break;
+                c = end;
+            }
+            if (i < count) {
+                LogWarning("Invalid path data in '%s'", path.c_str());
+                break;
+            }
+
+            bool relative = islower((unsigned char)command);
+            double dx = (relative) ? cx : 0.0;
+            double dy = (relative) ? cy : 0.0;
+            // the points to append and the operator
+            double points[6];
+            int pointCount = 1;
+            const char *op = "l";
+            switch (toupper(command)) {
+                case 'M':
+                    points[0] = args[0] + dx;
+                    points[1] = args[1] + dy;
+                    startX = points[0];
+                    startY = points[1];
+                    op = "m";
+                    // the following coordinates are lines
+                    command = (relative) ? 'l' : 'L';
+                    break;
+                case 'L':
+                    points[0] = args[0] + dx;
+                    points[1] = args[1] + dy;
+                    break;
+                case 'H':
+                    points[0] = args[0] + dx;
+                    points[1] = cy;
+                    break;
+                case 'V':
+                    points[0] = cx;
+                    points[1] = args[0] + dy;
+                    break;
+                case 'A':
+                    points[0] = args[5] + dx;
+                    points[1] = args[6] + dy;
+                    break;
+                case 'C':
+                case 'S': {
+                    int k = 0;
+                    if (toupper(command) == 'C') {
+                        points[0] = args[0] + dx;
+                        points[1] = args[1] + dy;
+                        k = 2;
+                    }
+                    else if ((toupper(previous) == 'C') || (toupper(previous) == 'S')) {
+                        // reflection of the previous control point
+                        points[0] = 2.0 * cx - ctrlX;
+                        points[1] = 2.0 * cy - ctrlY;
+                    }
+                    else {
+                        points[0] = cx;
+                        points[1] = cy;
+                    }
+                    points[2] = args[k] + dx;
+                    points[3] = args[k + 1] + dy;
+                    points[4] = args[k + 2] + dx;
+                    points[5] = args[k + 3] + dy;
+                    ctrlX = points[2];
+                    ctrlY = points[3];
+                    pointCount = 3;
+                    op = "c";
+                    break;
+                }
+                case 'Q':
+                case 'T': {
+                    double qx, qy;
+                    int k = 0;
+                    if (toupper(command) == 'Q') {
+                        qx = args[0] + dx;
+                        qy = args[1] + dy;
+                        k = 2;
+                    }
+                    else if ((toupper(previous) == 'Q') || (toupper(previous) == 'T')) {
+                        qx = 2.0 * cx - ctrlX;
+                        qy = 2.0 * cy - ctrlY;
+                    }
+                    else {
+                        qx = cx;
+                        qy = cy;
+                    }
+                    points[4] = args[k] + dx;
+                    points[5] = args[k + 1] + dy;
+                    points[0] = cx + 2.0 / 3.0 * (qx - cx);
+                    points[1] = cy + 2.0 / 3.0 * (qy - cy);
+                    points[2] = points[4] + 2.0 / 3.0 * (qx - points[4]);
+                    points[3] = points[5] + 2.0 / 3.0 * (qy - points[5]);
+                    ctrlX = qx;
+                    ctrlY = qy;
+                    pointCount = 3;
+                    op = "c";
+                    break;
+                }
+            }
+            for (i = 0; i < pointCount; i++) {
+                double x = points[2 * i];
+                double y = points[2 * i + 1] * flip;
+                minX = (first) ? x : std::min(minX, x);
+                minY = (first) ? y : std::min(minY, y);
+                maxX = (first) ? x : std::max(maxX, x);
+                maxY = (first) ? y : std::max(maxY, y);
+                first = false;
+                AppendNumber(content, x);
+                content += ' ';
+                AppendNumber(content, y);
+                content += ' ';
+            }
+            content += op;
+            content += '\n';
+            cx = points[2 * pointCount - 2];
+            cy = points[2 * pointCount - 1];
+            previous = command;
+        }
+    }
+    content += "f\n";
+
+    this->StartObject(object);
+    std::string form = "<< /Type /XObject /Subtype /Form /BBox [";
+    AppendNumber(form, floor(minX));
+    form += ' ';
+    AppendNumber(form, floor(minY));
+    form += ' ';
+    AppendNumber(form, ceil(maxX));
+    form += ' ';
+    AppendNumber(form, ceil(maxY));
+    form += StringFormat("] /Length %d >>\nstream\n", (int)content.size());
+    this->Write(form);
+    this->Write(content);
+    this->Write("\nendstream\nendobj\n");
+}
+
+int PdfDeviceContext::GetFontIndex(const FontInfo &font)
+{
+    FontInfo fontInfo = font;
+    int index = 0;
+    if ((fontInfo.GetStyle() == FONTSTYLE_italic) || (fontInfo.GetStyle() == FONTSTYLE_oblique)) index += 1;
+    if (fontInfo.GetWeight() == FONTWEIGHT_bold) index += 2;
+    if (m_fontObjects[index] == 0) m_fontObjects[index] = this->AddObject();
+    return index;
+}
+
+void PdfDeviceContext::SetBackground(int colour, int style)
+{
+    // nothing to do, we do not handle Background
+}
+
+void PdfDeviceContext::SetBackgroundMode(int mode)
+{
+    // nothing to do, we do not handle Background Mode
+}
+
+void PdfDeviceContext::SetTextForeground(int colour)
+{
+    m_brushStack.top().SetColour(colour); // we use the brush colour for text
+}
+
+void PdfDeviceContext::SetTextBackground(int colour)
+{
+    // nothing to do, we do not handle Text Background Mode
+}
+
+void PdfDeviceContext::SetLogicalOrigin(int x, int y)
+{
+    m_originX = -x;
+    m_originY = -y;
+}
+
+void PdfDeviceContext::SetUserScale(double xScale, double yScale)
+{
+    m_userScaleX = xScale;
+    m_userScaleY = yScale;
+}
+
+Point PdfDeviceContext::GetLogicalOrigin()
+{
+    return Point(m_originX, m_originY);
+}
+
+void PdfDeviceContext::DrawComplexBezierPath(Point bezier1[4], Point bezier2[4])
+{
+    bool fill, stroke;
+    this->SetPaint(fill, stroke);
+
+    // the same path as in the SVG - the first curve and the second one backwards, with round caps and joins
+    m_buffer += "1 J 1 j\n";
+    this->AppendPoint(bezier1[0].x, bezier1[0].y);
+    m_buffer += "m ";
+    for (int i = 1; i < 4; ++i) this->AppendPoint(bezier1[i].x, bezier1[i].y);
+    m_buffer += "c ";
+    for (int i = 2; i >= 0; --i) this->AppendPoint(bezier2[i].x, bezier2[i].y);
+    m_buffer += "c\n";
+    this->PaintPath(false, fill, stroke);
+    m_buffer += "0 J 0 j\n";
+}
+
+void PdfDeviceContext::DrawCircle(int x, int y, int radius)
+{
+    DrawEllipse(x - radius, y - radius, 2 * radius, 2 * radius);
+}
+
+void PdfDeviceContext::DrawEllipse(int x, int y, int width, int height)
+{
+    int rh = height / 2;
+    int rw = width / 2;
+
+    bool fill, stroke;
+    this->SetPaint(fill, stroke);
+    this->AppendPoint(x + rw + rw, y + rh);
+    m_buffer += "m ";
+    this->AppendArc(x + rw, y + rh, rw, rh, 0.0, 2.0 * M_PI);
+    m_buffer += '\n';
+    this->PaintPath(true, fill, stroke);
+}
+
+void PdfDeviceContext::DrawEllipticArc(int x, int y, int width, int height, double start, double end)
+{
+    // radius
+    double rx = width / 2;
+    double ry = height / 2;
+    // center
+    double xc = x + rx;
+    double yc = y + ry;
+
+    // angles are counter-clockwise from three o'clock and a complete ellipse is drawn if they are equal
+    if (end <= start) end += 360.0;
+    start = start * M_PI / 180.0;
+    end = end * M_PI / 180.0;
+
+    bool fill, stroke;
+    this->SetPaint(fill, stroke);
+    this->AppendPoint(xc + rx * cos(start), yc - ry * sin(start));
+    m_buffer += "m ";
+    this->AppendArc(xc, yc, rx, ry, start, end);
+    m_buffer += '\n';
+    this->PaintPath(false, fill, stroke);
+}
+
+void PdfDeviceContext::DrawLine(int x1, int y1, int x2, int y2)
+{
+    assert(m_penStack.size());
+
+    if ((m_penStack.top().GetOpacity() == 0.0) || (m_penStack.top().GetWidth() <= 0)) return;
+
+    this->SetStrokeColour(m_penStack.top().GetColour());
+    this->SetLineWidth(m_penStack.top().GetWidth());
+    this->AppendPoint(x1, y1);
+    m_buffer += "m ";
+    this->AppendPoint(x2, y2);
+    m_buffer += "l S\n";
+
+    if (m_buffer.size() > PDF_BUFFER_SIZE) this->Flush();
+}
+
+void PdfDeviceContext::DrawPolygon(int n, Point points[], int xoffset, int yoffset, int fill_style)
+{
+    if (n < 2) return;
+
+    bool fill, stroke;
+    this->SetPaint(fill, stroke);
+
+    // nonzero rule as in the SVG
+    for (int i = 0; i < n; i++) {
+        this->AppendPoint(points[i].x + xoffset, points[i].y + yoffset);
+        m_buffer += (i == 0) ? "m " : "l ";
+    }
+    m_buffer += '\n';
+    this->PaintPath(true, fill, stroke);
+}
+
+void PdfDeviceContext::DrawRectangle(int x, int y, int width, int height)
+{
+    DrawRoundedRectangle(x, y, width, height, 0);
+}
+
+void PdfDeviceContext::DrawRoundedRectangle(int x, int y, int width, int height, double radius)
+{
+    bool fill, stroke;
+    this->SetPaint(fill, stroke);
+
+    // the corners are not rounded
+    this->AppendPoint(x, y);
+    this->AppendPoint(width, height);
+    m_buffer += "re\n";
+    this->PaintPath(true, fill, stroke);
+}
+
+void PdfDeviceContext::StartText(int x, int y, char alignment)
+{
+    m_textAlignment = alignment;
+    m_textLines.clear();
+    this->MoveTextTo(x, y);
+}
+
+void PdfDeviceContext::MoveTextTo(int x, int y)
+{
+    PdfTextLine line;
+    line.m_x = x;
+    line.m_y = y;
+    m_textLines.push_back(line);
+}
+
+void PdfDeviceContext::EndText()
+{
+    std::vector<PdfTextLine>::iterator lineIt;
+    std::vector<PdfTextRun>::iterator runIt;
+    for (lineIt = m_textLines.begin(); lineIt != m_textLines.end(); ++lineIt) {
+        // the line is aligned with the width of the runs
+        int x = lineIt->m_x;
+        int width = 0;
+        for (runIt = lineIt->m_runs.begin(); runIt != lineIt->m_runs.end(); ++runIt) width += runIt->m_width;
+        if (m_textAlignment == RIGHT) {
+            x -= width;
+        }
+        else if (m_textAlignment == CENTER) {
+            x -= width / 2;
+        }
+
+        for (runIt = lineIt->m_runs.begin(); runIt != lineIt->m_runs.end(); ++runIt) {
+            this->SetFillColour(runIt->m_colour);
+            // the SMuFL characters of the VerovioText font are drawn as glyphs
+            if (runIt->m_font.GetFaceName() == "VerovioText") {
+                this->DrawGlyphs(runIt->m_text, x, lineIt->m_y, runIt->m_font.GetPointSize());
+                x += runIt->m_width;
+                continue;
+            }
+            m_buffer += StringFormat("BT /F%d ", this->GetFontIndex(runIt->m_font));
+            AppendNumber(m_buffer, runIt->m_font.GetPointSize());
+            // the text is flipped back upwards
+            m_buffer += " Tf 1 0 0 -1 ";
+            this->AppendPoint(x, lineIt->m_y);
+            m_buffer += "Tm ";
+            this->AppendTextString(runIt->m_text);
+            m_buffer += " Tj ET\n";
+            x += runIt->m_width;
+        }
+    }
+    m_textLines.clear();
+
+    if (m_buffer.size() > PDF_BUFFER_SIZE) this->Flush();
+}
+
+void PdfDeviceContext::DrawText(const std::string &text, const std::wstring &wtext)
+{
+    assert(m_fontStack.top());
+    assert(!m_textLines.empty());
+
+    PdfTextRun run;
+    run.m_text = (wtext.empty()) ? UTF8to16(text) : wtext;
+    run.m_font = *m_fontStack.top();
+    run.m_colour = m_brushStack.top().GetColour();
+    // the width as used for the layout
+    TextExtend extend;
+    this->GetTextExtent(run.m_text, &extend);
+    run.m_width = extend.m_width;
+    m_textLines.back().m_runs.push_back(run);
+}
+
+void PdfDeviceContext::DrawRotatedText(const std::string &text, int x, int y, double angle)
+{
+    assert(m_fontStack.top());
+
+    this->SetFillColour(m_brushStack.top().GetColour());
+    m_buffer += StringFormat("BT /F%d ", this->GetFontIndex(*m_fontStack.top()));
+    AppendNumber(m_buffer, m_fontStack.top()->GetPointSize());
+    // the text is flipped back upwards and rotated counter-clockwise, as the arcs
+    angle = angle * M_PI / 180.0;
+    m_buffer += " Tf ";
+    AppendNumber(m_buffer, cos(angle));
+    m_buffer += ' ';
+    AppendNumber(m_buffer, -sin(angle));
+    m_buffer += ' ';
+    AppendNumber(m_buffer, -sin(angle));
+    m_buffer += ' ';
+    AppendNumber(m_buffer, -cos(angle));
+    m_buffer += ' ';
+    this->AppendPoint(x, y);
+    m_buffer += "Tm ";
+    this->AppendTextString(UTF8to16(text));
+    m_buffer += " Tj ET\n";
+
+    if (m_buffer.size() > PDF_BUFFER_SIZE) this->Flush();
+}
+
+void PdfDeviceContext::DrawMusicText(const std::wstring &text, int x, int y)
+{
+    assert(m_fontStack.top());
+
+    this->SetFillColour(m_brushStack.top().GetColour());
+    this->DrawGlyphs(text, x, y, m_fontStack.top()->GetPointSize());
+}
+
+void PdfDeviceContext::DrawGlyphs(const std::wstring &text, int x, int y, int pointSize)
+{
+    int w, h, gx, gy;
+
+    // draw chars one by one
+    for (unsigned int i = 0; i < text.length(); i++) {
+        wchar_t c = text[i];
+        Glyph *glyph = Resources::GetGlyph(c);
+        if (!glyph) {
+            continue;
+        }
+
+        // the form of the glyph is written once for the document
+        std::map<std::string, int>::iterator it = m_glyphIndexes.find(glyph->GetPath());
+        int index;
+        if (it == m_glyphIndexes.end()) {
+            index = (int)m_glyphs.size();
+            m_glyphIndexes[glyph->GetPath()] = index;
+            m_glyphs.push_back(std::make_pair(glyph->GetPath(), this->AddObject()));
+        }
+        else {
+            index = it->second;
+        }
+
+        // the size of the viewBox of the glyph is a tenth of the units per em
+        double scale = pointSize * 10.0 / glyph->GetUnitsPerEm();
+        m_buffer += "q ";
+        AppendNumber(m_buffer, scale);
+        m_buffer += " 0 0 ";
+        AppendNumber(m_buffer, -scale);
+        m_buffer += ' ';
+        this->AppendPoint(x, y);
+        m_buffer += StringFormat("cm /G%d Do Q\n", index);
+
+        // Get the bounds of the char
+        if (glyph->GetHorizAdvX() > 0)
+            x += glyph->GetHorizAdvX() * pointSize / glyph->GetUnitsPerEm();
+        else {
+            glyph->GetBoundingBox(&gx, &gy, &w, &h);
+            x += w * pointSize / glyph->GetUnitsPerEm();
+        }
+    }
+
+    if (m_buffer.size() > PDF_BUFFER_SIZE) this->Flush();
+}
+
+void PdfDeviceContext::DrawSpline(int n, Point points[])
+{
+}
+
+} // namespace vrv
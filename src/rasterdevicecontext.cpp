@@ -0,0 +1,911 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        rasterdevicecontext.cpp
+// Author:      agent
+// Created:     19/10/2026
+// Copyright (c) Authors and others. All rights reserved.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "rasterdevicecontext.h"
+
+//----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <assert.h>
+#include <ctype.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+//----------------------------------------------------------------------------
+
+#include "glyph.h"
+#include "unzip.h"
+#include "vrv.h"
+
+//----------------------------------------------------------------------------
+
+#include "pugixml.hpp"
+
+namespace vrv {
+
+extern "C" {
+static inline double DegToRad(double deg)
+{
+    return (deg * M_PI) / 180.0;
+}
+}
+
+// The tolerance for flattening the glyphs in the units of their viewBox (1000 per em with the SMuFL fonts)
+#define GLYPH_FLATTENING_TOLERANCE 20.0
+// The tolerance for flattening the other curves in pixels
+#define PIXEL_FLATTENING_TOLERANCE 2.0
+
+//----------------------------------------------------------------------------
+// PNG encoding
+//----------------------------------------------------------------------------
+
+static void AppendUInt32(std::string &output, unsigned int value)
+{
+    output += (char)((value >> 24) & 0xFF);
+    output += (char)((value >> 16) & 0xFF);
+    output += (char)((value >> 8) & 0xFF);
+    output += (char)(value & 0xFF);
+}
+
+static void AppendChunk(std::string &png, const char *type, const std::string &data)
+{
+    AppendUInt32(png, (unsigned int)data.size());
+    size_t start = png.size();
+    png.append(type, 4);
+    png += data;
+    AppendUInt32(png, Unzip::Crc32(png.data() + start, png.size() - start));
+}
+
+/**
+ * This class writes the bits of a deflate stream, the least significant first.
+ */
+class DeflateWriter {
+public:
+    DeflateWriter(std::string &output) : m_output(output), m_bits(0), m_bitCount(0) {}
+
+    void Write(unsigned int bits, int count)
+    {
+        m_bits |= bits << m_bitCount;
+        m_bitCount += count;
+        while (m_bitCount >= 8) {
+            m_output += (char)(m_bits & 0xFF);
+            m_bits >>= 8;
+            m_bitCount -= 8;
+        }
+    }
+
+    // Huffman codes are written the most significant bit first
+    void WriteCode(unsigned int code, int length)
+    {
+        unsigned int reversed = 0;
+        for (int i = 0; i < length; i++) {
+            reversed = (reversed << 1) | ((code >> i) & 1);
+        }
+        this->Write(reversed, length);
+    }
+
+    // A literal or a length symbol with the fixed Huffman codes
+    void WriteSymbol(int symbol)
+    {
+        if (symbol < 144)
+            this->WriteCode(0x30 + symbol, 8);
+        else if (symbol < 256)
+            this->WriteCode(0x190 + symbol - 144, 9);
+        else if (symbol < 280)
+            this->WriteCode(symbol - 256, 7);
+        else
+            this->WriteCode(0xC0 + symbol - 280, 8);
+    }
+
+    void WriteMatch(int length, int distance)
+    {
+        static const int lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59,
+            67, 83, 99, 115, 131, 163, 195, 227, 258 };
+        static const int lengthExtra[29]
+            = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+        static const int distanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385,
+            513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+        static const int distanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10,
+            10, 11, 11, 12, 12, 13, 13 };
+
+        int i = 28;
+        while (lengthBase[i] > length) i--;
+        this->WriteSymbol(257 + i);
+        this->Write(length - lengthBase[i], lengthExtra[i]);
+
+        int j = 29;
+        while (distanceBase[j] > distance) j--;
+        this->WriteCode(j, 5);
+        this->Write(distance - distanceBase[j], distanceExtra[j]);
+    }
+
+    void Flush()
+    {
+        if (m_bitCount > 0) m_output += (char)(m_bits & 0xFF);
+        m_bits = 0;
+        m_bitCount = 0;
+    }
+
+private:
+    std::string &m_output;
+    unsigned int m_bits;
+    int m_bitCount;
+};
+
+/**
+ * Compress the filtered rows into a zlib stream.
+ * A single block with the fixed Huffman codes is written and only the repetitions of the previous byte, the previous
+ * pixel and the previous row are looked for, which is enough for the large uniform areas of a score.
+ */
+static void ZlibCompress(const std::string &data, int pixelLength, int rowLength, std::string &output)
+{
+    // 32K window, no dictionary, fastest compression
+    output += (char)0x78;
+    output += (char)0x01;
+
+    DeflateWriter writer(output);
+    // final block with fixed Huffman codes
+    writer.Write(1, 1);
+    writer.Write(1, 2);
+
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data.data());
+    size_t size = data.size();
+    size_t i = 0;
+    while (i < size) {
+        size_t maxLength = std::min((size_t)258, size - i);
+        int bestLength = 0;
+        int bestDistance = 0;
+        const int distances[3] = { 1, pixelLength, rowLength };
+        for (int d = 0; d < 3; d++) {
+            size_t distance = (size_t)distances[d];
+            if ((distance > i) || (distance > 32768)) continue;
+            size_t length = 0;
+            while ((length < maxLength) && (bytes[i + length] == bytes[i + length - distance])) length++;
+            if ((int)length > bestLength) {
+                bestLength = (int)length;
+                bestDistance = (int)distance;
+            }
+        }
+        if (bestLength >= 3) {
+            writer.WriteMatch(bestLength, bestDistance);
+            i += bestLength;
+        }
+        else {
+            writer.WriteSymbol(bytes[i]);
+            i++;
+        }
+    }
+    // end of block
+    writer.WriteSymbol(256);
+    writer.Flush();
+
+    unsigned int a = 1, b = 0;
+    for (i = 0; i < size; i++) {
+        a = (a + bytes[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    AppendUInt32(output, (b << 16) | a);
+}
+
+//----------------------------------------------------------------------------
+// RasterDeviceContext
+//----------------------------------------------------------------------------
+
+std::map<std::string, RasterOutline> RasterDeviceContext::m_outlines;
+#ifndef USE_EMSCRIPTEN
+std::mutex RasterDeviceContext::m_outlinesMutex;
+#endif
+
+RasterDeviceContext::RasterDeviceContext(int width, int height) : DeviceContext()
+{
+    m_grayscale = false;
+
+    this->Reset(width, height);
+}
+
+RasterDeviceContext::~RasterDeviceContext()
+{
+}
+
+void RasterDeviceContext::Reset(int width, int height)
+{
+    m_width = width;
+    m_height = height;
+
+    m_userScaleX = 1.0;
+    m_userScaleY = 1.0;
+    m_originX = 0;
+    m_originY = 0;
+
+    m_penStack = std::stack<Pen>();
+    m_brushStack = std::stack<Brush>();
+    m_fontStack = std::stack<FontInfo *>();
+    SetBrush(AxBLACK, AxSOLID);
+    SetPen(AxBLACK, 1, AxSOLID);
+
+    m_pixelWidth = 0;
+    m_pixelHeight = 0;
+    m_pixels.clear();
+}
+
+void RasterDeviceContext::AllocatePixels()
+{
+    int pixelWidth = std::max(1, (int)((double)m_width * m_userScaleX));
+    int pixelHeight = std::max(1, (int)((double)m_height * m_userScaleY));
+    if (!m_pixels.empty() && (pixelWidth == m_pixelWidth) && (pixelHeight == m_pixelHeight)) return;
+
+    m_pixelWidth = pixelWidth;
+    m_pixelHeight = pixelHeight;
+    // white or transparent
+    m_pixels.assign((size_t)m_pixelWidth * m_pixelHeight * (m_grayscale ? 1 : 4), m_grayscale ? 255 : 0);
+}
+
+std::string RasterDeviceContext::GetPNG()
+{
+    this->AllocatePixels();
+
+    int channels = (m_grayscale) ? 1 : 4;
+    int rowLength = m_pixelWidth * channels;
+
+    // each row starts with its filter type (none)
+    std::string rows;
+    rows.reserve((size_t)(rowLength + 1) * m_pixelHeight);
+    for (int y = 0; y < m_pixelHeight; y++) {
+        rows += '\0';
+        rows.append(reinterpret_cast<const char *>(&m_pixels[(size_t)y * rowLength]), rowLength);
+    }
+
+    std::string png("\x89PNG\r\n\x1a\n", 8);
+
+    std::string header;
+    AppendUInt32(header, m_pixelWidth);
+    AppendUInt32(header, m_pixelHeight);
+    header += (char)8; // bit depth
+    header += (char)((m_grayscale) ? 0 : 6); // grayscale or RGBA
+    header += (char)0; // compression
+    header += (char)0; // filter
+    header += (char)0; // interlace
+    AppendChunk(png, "IHDR", header);
+
+    std::string data;
+    ZlibCompress(rows, channels, rowLength + 1, data);
+    AppendChunk(png, "IDAT", data);
+
+    AppendChunk(png, "IEND", "");
+
+    return png;
+}
+
+RasterPoint RasterDeviceContext::ToPixel(double x, double y) const
+{
+    return RasterPoint((x + m_originX) * m_userScaleX / DEFINITON_FACTOR,
+        (y + m_originY) * m_userScaleY / DEFINITON_FACTOR);
+}
+
+void RasterDeviceContext::FillContours(const std::vector<RasterContour> &contours, int colour)
+{
+    this->AllocatePixels();
+
+    double minX = m_pixelWidth, minY = m_pixelHeight, maxX = 0.0, maxY = 0.0;
+    std::vector<RasterContour>::const_iterator it;
+    RasterContour::const_iterator pointIt;
+    for (it = contours.begin(); it != contours.end(); ++it) {
+        for (pointIt = it->begin(); pointIt != it->end(); ++pointIt) {
+            minX = std::min(minX, pointIt->x);
+            minY = std::min(minY, pointIt->y);
+            maxX = std::max(maxX, pointIt->x);
+            maxY = std::max(maxY, pointIt->y);
+        }
+    }
+
+    // the area of the buffer covered by the shape
+    m_coverageX = std::max(0, (int)floor(minX));
+    m_coverageY = std::max(0, (int)floor(minY));
+    m_coverageWidth = std::min(m_pixelWidth, (int)ceil(maxX)) - m_coverageX;
+    m_coverageHeight = std::min(m_pixelHeight, (int)ceil(maxY)) - m_coverageY;
+    if ((m_coverageWidth <= 0) || (m_coverageHeight <= 0)) return;
+
+    m_coverage.assign((size_t)(m_coverageWidth + 2) * m_coverageHeight, 0.0f);
+    for (it = contours.begin(); it != contours.end(); ++it) {
+        int n = (int)it->size();
+        for (int i = 0; i < n; i++) {
+            const RasterPoint &p0 = it->at(i);
+            const RasterPoint &p1 = it->at((i + 1) % n);
+            // what is left of the area is counted in the first column
+            double x0 = std::min((double)m_coverageWidth, std::max(0.0, p0.x - m_coverageX));
+            double x1 = std::min((double)m_coverageWidth, std::max(0.0, p1.x - m_coverageX));
+            this->AccumulateLine(x0, p0.y - m_coverageY, x1, p1.y - m_coverageY);
+        }
+    }
+
+    int red = (colour >> 16) & 0xFF;
+    int green = (colour >> 8) & 0xFF;
+    int blue = colour & 0xFF;
+    int gray = (red * 299 + green * 587 + blue * 114) / 1000;
+    int channels = (m_grayscale) ? 1 : 4;
+
+    for (int y = 0; y < m_coverageHeight; y++) {
+        const float *line = &m_coverage[(size_t)y * (m_coverageWidth + 2)];
+        unsigned char *pixel = &m_pixels[((size_t)(m_coverageY + y) * m_pixelWidth + m_coverageX) * channels];
+        float accumulated = 0.0f;
+        for (int x = 0; x < m_coverageWidth; x++, pixel += channels) {
+            accumulated += line[x];
+            // nonzero rule
+            float coverage = std::min(1.0f, fabsf(accumulated));
+            if (coverage < 1.0f / 512.0f) continue;
+            if (m_grayscale) {
+                pixel[0] = (unsigned char)(gray * coverage + pixel[0] * (1.0f - coverage) + 0.5f);
+                continue;
+            }
+            // source over destination with straight alpha
+            float alpha = pixel[3] / 255.0f;
+            float outAlpha = coverage + alpha * (1.0f - coverage);
+            pixel[0] = (unsigned char)((red * coverage + pixel[0] * alpha * (1.0f - coverage)) / outAlpha + 0.5f);
+            pixel[1] = (unsigned char)((green * coverage + pixel[1] * alpha * (1.0f - coverage)) / outAlpha + 0.5f);
+            pixel[2] = (unsigned char)((blue * coverage + pixel[2] * alpha * (1.0f - coverage)) / outAlpha + 0.5f);
+            pixel[3] = (unsigned char)(outAlpha * 255.0f + 0.5f);
+        }
+    }
+}
+
+void RasterDeviceContext::AccumulateLine(double x0, double y0, double x1, double y1)
+{
+    if (y0 == y1) return;
+
+    // go down and keep the direction for the sign of the area
+    double direction = 1.0;
+    if (y0 > y1) {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+        direction = -1.0;
+    }
+    double dxdy = (x1 - x0) / (y1 - y0);
+    double x = x0;
+    int yStart = (int)floor(y0);
+    if (y0 < 0.0) {
+        x -= y0 * dxdy;
+        yStart = 0;
+    }
+    int yEnd = std::min(m_coverageHeight, (int)ceil(y1));
+
+    for (int y = yStart; y < yEnd; y++) {
+        float *line = &m_coverage[(size_t)y * (m_coverageWidth + 2)];
+        double dy = std::min((double)(y + 1), y1) - std::max((double)y, y0);
+        double xNext = x + dxdy * dy;
+        double d = dy * direction;
+        double xLeft = std::min(x, xNext);
+        double xRight = std::max(x, xNext);
+        double xLeftFloor = floor(xLeft);
+        int xLeftIdx = (int)xLeftFloor;
+        double xRightCeil = ceil(xRight);
+        int xRightIdx = (int)xRightCeil;
+        if (xRightIdx <= xLeftIdx + 1) {
+            // within one pixel - split the area between it and the next one
+            double xMid = 0.5 * (x + xNext) - xLeftFloor;
+            line[xLeftIdx] += (float)(d - d * xMid);
+            line[xLeftIdx + 1] += (float)(d * xMid);
+        }
+        else {
+            double s = 1.0 / (xRight - xLeft);
+            double xLeftFract = xLeft - xLeftFloor;
+            double a0 = 0.5 * s * (1.0 - xLeftFract) * (1.0 - xLeftFract);
+            double xRightFract = xRight - xRightCeil + 1.0;
+            double am = 0.5 * s * xRightFract * xRightFract;
+            line[xLeftIdx] += (float)(d * a0);
+            if (xRightIdx == xLeftIdx + 2) {
+                line[xLeftIdx + 1] += (float)(d * (1.0 - a0 - am));
+            }
+            else {
+                double a1 = s * (1.5 - xLeftFract);
+                line[xLeftIdx + 1] += (float)(d * (a1 - a0));
+                for (int xi = xLeftIdx + 2; xi < xRightIdx - 1; xi++) {
+                    line[xi] += (float)(d * s);
+                }
+                double a2 = a1 + (xRightIdx - xLeftIdx - 3) * s;
+                line[xRightIdx - 1] += (float)(d * (1.0 - a2 - am));
+            }
+            line[xRightIdx] += (float)(d * am);
+        }
+        x = xNext;
+    }
+}
+
+void RasterDeviceContext::StrokeContour(
+    const RasterContour &contour, bool closed, double width, bool roundJoins, int colour)
+{
+    if ((width <= 0.0) || contour.empty()) return;
+
+    double halfWidth = width / 2.0;
+    // all the pieces are clockwise for their union to be filled with the nonzero rule
+    std::vector<RasterContour> pieces;
+    int n = (int)contour.size();
+    int segmentCount = (closed) ? n : n - 1;
+    for (int i = 0; i < segmentCount; i++) {
+        const RasterPoint &p0 = contour.at(i);
+        const RasterPoint &p1 = contour.at((i + 1) % n);
+        double dx = p1.x - p0.x;
+        double dy = p1.y - p0.y;
+        double length = sqrt(dx * dx + dy * dy);
+        if (length == 0.0) continue;
+        double nx = -dy / length * halfWidth;
+        double ny = dx / length * halfWidth;
+        RasterContour quad;
+        quad.push_back(RasterPoint(p0.x + nx, p0.y + ny));
+        quad.push_back(RasterPoint(p1.x + nx, p1.y + ny));
+        quad.push_back(RasterPoint(p1.x - nx, p1.y - ny));
+        quad.push_back(RasterPoint(p0.x - nx, p0.y - ny));
+        pieces.push_back(quad);
+    }
+    if (roundJoins) {
+        for (int i = 0; i < n; i++) {
+            AddEllipse(pieces, contour.at(i).x, contour.at(i).y, halfWidth, halfWidth, true);
+        }
+    }
+    // a single point is drawn as a dot
+    if (pieces.empty()) {
+        AddEllipse(pieces, contour.at(0).x, contour.at(0).y, halfWidth, halfWidth, true);
+    }
+
+    this->FillContours(pieces, colour);
+}
+
+void RasterDeviceContext::FlattenCubic(RasterContour &contour, const RasterPoint &p0, const RasterPoint &p1,
+    const RasterPoint &p2, const RasterPoint &p3, double tolerance)
+{
+    double length = sqrt((p1.x - p0.x) * (p1.x - p0.x) + (p1.y - p0.y) * (p1.y - p0.y))
+        + sqrt((p2.x - p1.x) * (p2.x - p1.x) + (p2.y - p1.y) * (p2.y - p1.y))
+        + sqrt((p3.x - p2.x) * (p3.x - p2.x) + (p3.y - p2.y) * (p3.y - p2.y));
+    int n = std::max(1, std::min(64, (int)ceil(length / tolerance)));
+    for (int i = 1; i <= n; i++) {
+        double t = (double)i / n;
+        double u = 1.0 - t;
+        double a = u * u * u;
+        double b = 3.0 * u * u * t;
+        double c = 3.0 * u * t * t;
+        double d = t * t * t;
+        contour.push_back(RasterPoint(
+            a * p0.x + b * p1.x + c * p2.x + d * p3.x, a * p0.y + b * p1.y + c * p2.y + d * p3.y));
+    }
+}
+
+void RasterDeviceContext::AddEllipse(
+    std::vector<RasterContour> &contours, double cx, double cy, double rx, double ry, bool cw)
+{
+    // enough segments for the error to stay below a quarter of pixel
+    double radius = std::max(fabs(rx), fabs(ry));
+    int n = std::max(8, std::min(256, (int)ceil(M_PI / acos(std::max(0.0, 1.0 - 0.25 / std::max(radius, 0.25))))));
+    RasterContour ellipse;
+    for (int i = 0; i < n; i++) {
+        double angle = 2.0 * M_PI * i / n;
+        if (cw) angle = -angle;
+        ellipse.push_back(RasterPoint(cx + rx * cos(angle), cy + ry * sin(angle)));
+    }
+    contours.push_back(ellipse);
+}
+
+void RasterDeviceContext::ParsePath(const char *data, std::vector<RasterContour> &contours)
+{
+    RasterPoint current, start, control;
+    char command = 0;
+    char previous = 0;
+    double args[7];
+    const char *c = data;
+    while (*c) {
+        while (*c && (isspace((unsigned char)*c) || (*c == ','))) c++;
+        if (!*c) break;
+        if (isalpha((unsigned char)*c)) {
+            command = *c;
+            c++;
+            if ((command == 'z') || (command == 'Z')) {
+                current = start;
+                previous = command;
+                continue;
+            }
+        }
+        int count = 0;
+        switch (toupper(command)) {
+            case 'M':
+            case 'L':
+            case 'T': count = 2; break;
+            case 'H':
+            case 'V': count = 1; break;
+            case 'C': count = 6; break;
+            case 'S':
+            case 'Q': count = 4; break;
+            case 'A': count = 7; break;
+            default: LogWarning("Unsupported path command '%c'", command); return;
+        }
+        for (int i = 0; i < count; i++) {
+            while (*c && (isspace((unsigned char)*c) || (*c == ','))) c++;
+            char *end;
+            args[i] = strtod(c, &end);
+            if (end == c) {
+                LogWarning("Invalid path data '%s'", data);
+                return;
+            }
+            c = end;
+        }
+
+        bool relative = islower((unsigned char)command);
+        double dx = (relative) ? current.x : 0.0;
+        double dy = (relative) ? current.y : 0.0;
+        switch (toupper(command)) {
+            case 'M':
+                current = RasterPoint(args[0] + dx, args[1] + dy);
+                start = current;
+                contours.push_back(RasterContour(1, current));
+                // the following coordinates are lines
+                command = (relative) ? 'l' : 'L';
+                break;
+            case 'L': current = RasterPoint(args[0] + dx, args[1] + dy); break;
+            case 'H': current.x = args[0] + dx; break;
+            case 'V': current.y = args[0] + dy; break;
+            case 'A': current = RasterPoint(args[5] + dx, args[6] + dy); break;
+            case 'C':
+            case 'S': {
+                RasterPoint p1;
+                if (toupper(command) == 'C') {
+                    p1 = RasterPoint(args[0] + dx, args[1] + dy);
+                }
+                else {
+                    // reflection of the previous control point
+                    bool smooth = (toupper(previous) == 'C') || (toupper(previous) == 'S');
+                    p1 = (smooth) ? RasterPoint(2.0 * current.x - control.x, 2.0 * current.y - control.y) : current;
+                }
+                int k = (toupper(command) == 'C') ? 2 : 0;
+                RasterPoint p2(args[k] + dx, args[k + 1] + dy);
+                RasterPoint p3(args[k + 2] + dx, args[k + 3] + dy);
+                if (contours.empty()) contours.push_back(RasterContour(1, current));
+                FlattenCubic(contours.back(), current, p1, p2, p3, GLYPH_FLATTENING_TOLERANCE);
+                control = p2;
+                current = p3;
+                break;
+            }
+            case 'Q':
+            case 'T': {
+                RasterPoint q;
+                if (toupper(command) == 'Q') {
+                    q = RasterPoint(args[0] + dx, args[1] + dy);
+                }
+                else {
+                    bool smooth = (toupper(previous) == 'Q') || (toupper(previous) == 'T');
+                    q = (smooth) ? RasterPoint(2.0 * current.x - control.x, 2.0 * current.y - control.y) : current;
+                }
+                int k = (toupper(command) == 'Q') ? 2 : 0;
+                RasterPoint p3(args[k] + dx, args[k + 1] + dy);
+                // as a cubic curve
+                RasterPoint p1(current.x + 2.0 / 3.0 * (q.x - current.x), current.y + 2.0 / 3.0 * (q.y - current.y));
+                RasterPoint p2(p3.x + 2.0 / 3.0 * (q.x - p3.x), p3.y + 2.0 / 3.0 * (q.y - p3.y));
+                if (contours.empty()) contours.push_back(RasterContour(1, current));
+                FlattenCubic(contours.back(), current, p1, p2, p3, GLYPH_FLATTENING_TOLERANCE);
+                control = q;
+                current = p3;
+                break;
+            }
+        }
+        if ((toupper(command) == 'L') || (toupper(command) == 'H') || (toupper(command) == 'V')
+            || (toupper(command) == 'A')) {
+            if (contours.empty()) contours.push_back(RasterContour(1, start));
+            contours.back().push_back(current);
+        }
+        previous = command;
+    }
+}
+
+const RasterOutline &RasterDeviceContext::GetOutline(Glyph *glyph)
+{
+#ifndef USE_EMSCRIPTEN
+    // the outline is loaded only once and returned when it is complete
+    std::lock_guard<std::mutex> lock(m_outlinesMutex);
+#endif
+    std::map<std::string, RasterOutline>::iterator it = m_outlines.find(glyph->GetPath());
+    if (it != m_outlines.end()) return it->second;
+
+    RasterOutline &outline = m_outlines[glyph->GetPath()];
+    pugi::xml_document doc;
+    if (!doc.load_file(glyph->GetPath().c_str())) {
+        LogError("Font file '%s' could not be loaded", glyph->GetPath().c_str());
+        return outline;
+    }
+    pugi::xml_node symbol = doc.first_child();
+    double x, y, width, height;
+    if ((sscanf(symbol.attribute("viewBox").value(), "%lf %lf %lf %lf", &x, &y, &width, &height) == 4)
+        && (width > 0)) {
+        outline.m_size = width;
+    }
+
+    pugi::xpath_node_set paths = symbol.select_nodes(".//path");
+    for (pugi::xpath_node_set::const_iterator pathIt = paths.begin(); pathIt != paths.end(); ++pathIt) {
+        pugi::xml_node path = pathIt->node();
+        size_t first = outline.m_contours.size();
+        ParsePath(path.attribute("d").value(), outline.m_contours);
+        // the glyphs are drawn upside down in a <g transform="scale(1,-1)">
+        if (std::string(path.parent().attribute("transform").value()) == "scale(1,-1)") {
+            for (size_t i = first; i < outline.m_contours.size(); i++) {
+                RasterContour::iterator pointIt;
+                for (pointIt = outline.m_contours[i].begin(); pointIt != outline.m_contours[i].end(); ++pointIt) {
+                    pointIt->y = -pointIt->y;
+                }
+            }
+        }
+    }
+
+    return outline;
+}
+
+void RasterDeviceContext::StartPage()
+{
+    this->AllocatePixels();
+}
+
+void RasterDeviceContext::SetBackground(int colour, int style)
+{
+    // nothing to do, we do not handle Background
+}
+
+void RasterDeviceContext::SetBackgroundMode(int mode)
+{
+    // nothing to do, we do not handle Background Mode
+}
+
+void RasterDeviceContext::SetTextForeground(int colour)
+{
+    m_brushStack.top().SetColour(colour); // we use the brush colour for text
+}
+
+void RasterDeviceContext::SetTextBackground(int colour)
+{
+    // nothing to do, we do not handle Text Background Mode
+}
+
+void RasterDeviceContext::SetLogicalOrigin(int x, int y)
+{
+    m_originX = -x;
+    m_originY = -y;
+}
+
+void RasterDeviceContext::SetUserScale(double xScale, double yScale)
+{
+    m_userScaleX = xScale;
+    m_userScaleY = yScale;
+}
+
+Point RasterDeviceContext::GetLogicalOrigin()
+{
+    return Point(m_originX, m_originY);
+}
+
+void RasterDeviceContext::DrawComplexBezierPath(Point bezier1[4], Point bezier2[4])
+{
+    // the same path as in the SVG - the first curve and the second one backwards
+    RasterContour contour(1, this->ToPixel(bezier1[0].x, bezier1[0].y));
+    FlattenCubic(contour, RasterPoint(contour.back()), this->ToPixel(bezier1[1].x, bezier1[1].y),
+        this->ToPixel(bezier1[2].x, bezier1[2].y), this->ToPixel(bezier1[3].x, bezier1[3].y),
+        PIXEL_FLATTENING_TOLERANCE);
+    FlattenCubic(contour, RasterPoint(contour.back()), this->ToPixel(bezier2[2].x, bezier2[2].y),
+        this->ToPixel(bezier2[1].x, bezier2[1].y), this->ToPixel(bezier2[0].x, bezier2[0].y),
+        PIXEL_FLATTENING_TOLERANCE);
+
+    if (m_brushStack.top().GetOpacity() > 0.0) {
+        this->FillContours(std::vector<RasterContour>(1, contour), m_brushStack.top().GetColour());
+    }
+    if (m_penStack.top().GetOpacity() > 0.0) {
+        this->StrokeContour(contour, false, m_penStack.top().GetWidth() * m_userScaleX / DEFINITON_FACTOR, true,
+            m_penStack.top().GetColour());
+    }
+}
+
+void RasterDeviceContext::DrawCircle(int x, int y, int radius)
+{
+    DrawEllipse(x - radius, y - radius, 2 * radius, 2 * radius);
+}
+
+void RasterDeviceContext::DrawEllipse(int x, int y, int width, int height)
+{
+    assert(m_penStack.size());
+    assert(m_brushStack.size());
+
+    int rh = height / 2;
+    int rw = width / 2;
+    RasterPoint center = this->ToPixel(x + rw, y + rh);
+    double rx = rw * m_userScaleX / DEFINITON_FACTOR;
+    double ry = rh * m_userScaleY / DEFINITON_FACTOR;
+
+    std::vector<RasterContour> contours;
+    if (m_brushStack.top().GetOpacity() > 0.0) {
+        AddEllipse(contours, center.x, center.y, rx, ry, true);
+        this->FillContours(contours, m_brushStack.top().GetColour());
+    }
+    double halfWidth = m_penStack.top().GetWidth() * m_userScaleX / DEFINITON_FACTOR / 2.0;
+    if ((m_penStack.top().GetOpacity() > 0.0) && (halfWidth > 0.0)) {
+        // a ring between the outer and the inner ellipse
+        contours.clear();
+        AddEllipse(contours, center.x, center.y, rx + halfWidth, ry + halfWidth, true);
+        if ((rx > halfWidth) && (ry > halfWidth)) {
+            AddEllipse(contours, center.x, center.y, rx - halfWidth, ry - halfWidth, false);
+        }
+        this->FillContours(contours, m_penStack.top().GetColour());
+    }
+}
+
+void RasterDeviceContext::DrawEllipticArc(int x, int y, int width, int height, double start, double end)
+{
+    assert(m_penStack.size());
+    assert(m_brushStack.size());
+
+    // radius and center
+    double rx = width / 2;
+    double ry = height / 2;
+    double xc = x + rx;
+    double yc = y + ry;
+
+    // angles are counter-clockwise from three o'clock and a complete ellipse is drawn if they are equal
+    if (end <= start) end += 360.0;
+    int n = std::max(2, (int)ceil((end - start) / 5.0));
+    RasterContour contour;
+    for (int i = 0; i <= n; i++) {
+        double angle = DegToRad(start + (end - start) * i / n);
+        contour.push_back(this->ToPixel(xc + rx * cos(angle), yc - ry * sin(angle)));
+    }
+
+    if (m_brushStack.top().GetOpacity() > 0.0) {
+        this->FillContours(std::vector<RasterContour>(1, contour), m_brushStack.top().GetColour());
+    }
+    if (m_penStack.top().GetOpacity() > 0.0) {
+        this->StrokeContour(contour, false, m_penStack.top().GetWidth() * m_userScaleX / DEFINITON_FACTOR, false,
+            m_penStack.top().GetColour());
+    }
+}
+
+void RasterDeviceContext::DrawLine(int x1, int y1, int x2, int y2)
+{
+    assert(m_penStack.size());
+
+    if (m_penStack.top().GetOpacity() == 0.0) return;
+
+    RasterContour contour;
+    contour.push_back(this->ToPixel(x1, y1));
+    contour.push_back(this->ToPixel(x2, y2));
+    this->StrokeContour(contour, false, m_penStack.top().GetWidth() * m_userScaleX / DEFINITON_FACTOR, false,
+        m_penStack.top().GetColour());
+}
+
+void RasterDeviceContext::DrawPolygon(int n, Point points[], int xoffset, int yoffset, int fill_style)
+{
+    assert(m_penStack.size());
+    assert(m_brushStack.size());
+
+    if (n < 2) return;
+
+    RasterContour contour;
+    for (int i = 0; i < n; i++) {
+        contour.push_back(this->ToPixel(points[i].x + xoffset, points[i].y + yoffset));
+    }
+
+    if (m_brushStack.top().GetOpacity() > 0.0) {
+        this->FillContours(std::vector<RasterContour>(1, contour), m_brushStack.top().GetColour());
+    }
+    if (m_penStack.top().GetOpacity() > 0.0) {
+        this->StrokeContour(contour, true, m_penStack.top().GetWidth() * m_userScaleX / DEFINITON_FACTOR, true,
+            m_penStack.top().GetColour());
+    }
+}
+
+void RasterDeviceContext::DrawRectangle(int x, int y, int width, int height)
+{
+    DrawRoundedRectangle(x, y, width, height, 0);
+}
+
+void RasterDeviceContext::DrawRoundedRectangle(int x, int y, int width, int height, double radius)
+{
+    assert(m_penStack.size());
+    assert(m_brushStack.size());
+
+    // the corners are not rounded
+    if (height < 0) {
+        height = -height;
+        y -= height;
+    }
+    if (width < 0) {
+        width = -width;
+        x -= width;
+    }
+    RasterPoint topLeft = this->ToPixel(x, y);
+    RasterPoint bottomRight = this->ToPixel(x + width, y + height);
+
+    std::vector<RasterContour> contours(1);
+    if (m_brushStack.top().GetOpacity() > 0.0) {
+        contours[0].push_back(topLeft);
+        contours[0].push_back(RasterPoint(bottomRight.x, topLeft.y));
+        contours[0].push_back(bottomRight);
+        contours[0].push_back(RasterPoint(topLeft.x, bottomRight.y));
+        this->FillContours(contours, m_brushStack.top().GetColour());
+    }
+    double halfWidth = m_penStack.top().GetWidth() * m_userScaleX / DEFINITON_FACTOR / 2.0;
+    if ((m_penStack.top().GetOpacity() > 0.0) && (halfWidth > 0.0)) {
+        // a frame between the outer and the inner rectangle, with mitered corners
+        contours.assign(1, RasterContour());
+        contours[0].push_back(RasterPoint(topLeft.x - halfWidth, topLeft.y - halfWidth));
+        contours[0].push_back(RasterPoint(bottomRight.x + halfWidth, topLeft.y - halfWidth));
+        contours[0].push_back(RasterPoint(bottomRight.x + halfWidth, bottomRight.y + halfWidth));
+        contours[0].push_back(RasterPoint(topLeft.x - halfWidth, bottomRight.y + halfWidth));
+        if ((bottomRight.x - topLeft.x > 2.0 * halfWidth) && (bottomRight.y - topLeft.y > 2.0 * halfWidth)) {
+            contours.push_back(RasterContour());
+            contours[1].push_back(RasterPoint(topLeft.x + halfWidth, topLeft.y + halfWidth));
+            contours[1].push_back(RasterPoint(topLeft.x + halfWidth, bottomRight.y - halfWidth));
+            contours[1].push_back(RasterPoint(bottomRight.x - halfWidth, bottomRight.y - halfWidth));
+            contours[1].push_back(RasterPoint(bottomRight.x - halfWidth, topLeft.y + halfWidth));
+        }
+        this->FillContours(contours, m_penStack.top().GetColour());
+    }
+}
+
+void RasterDeviceContext::StartText(int x, int y, char alignment)
+{
+    // nothing to do, text is not drawn
+}
+
+void RasterDeviceContext::EndText()
+{
+}
+
+void RasterDeviceContext::MoveTextTo(int x, int y)
+{
+}
+
+void RasterDeviceContext::DrawRotatedText(const std::string &text, int x, int y, double angle)
+{
+}
+
+void RasterDeviceContext::DrawText(const std::string &text, const std::wstring &wtext)
+{
+}
+
+void RasterDeviceContext::DrawMusicText(const std::wstring &text, int x, int y)
+{
+    assert(m_fontStack.top());
+
+    int w, h, gx, gy;
+    int pointSize = m_fontStack.top()->GetPointSize();
+
+    // draw chars one by one
+    for (unsigned int i = 0; i < text.length(); i++) {
+        wchar_t c = text[i];
+        Glyph *glyph = Resources::GetGlyph(c);
+        if (!glyph) {
+            continue;
+        }
+
+        // the outline in the viewBox is scaled to the point size like the <symbol> in the SVG
+        const RasterOutline &outline = GetOutline(glyph);
+        double scale = pointSize / outline.m_size;
+        std::vector<RasterContour> contours(outline.m_contours.size());
+        for (size_t j = 0; j < outline.m_contours.size(); j++) {
+            RasterContour::const_iterator pointIt;
+            contours[j].reserve(outline.m_contours[j].size());
+            for (pointIt = outline.m_contours[j].begin(); pointIt != outline.m_contours[j].end(); ++pointIt) {
+                contours[j].push_back(this->ToPixel(x + pointIt->x * scale, y + pointIt->y * scale));
+            }
+        }
+        this->FillContours(contours, m_brushStack.top().GetColour());
+
+        // Get the bounds of the char
+        if (glyph->GetHorizAdvX() > 0)
+            x += glyph->GetHorizAdvX() * pointSize / glyph->GetUnitsPerEm();
+        else {
+            glyph->GetBoundingBox(&gx, &gy, &w, &h);
+            x += w * pointSize / glyph->GetUnitsPerEm();
+        }
+    }
+}
+
+void RasterDeviceContext::DrawSpline(int n, Point points[])
+{
+}
+
+} // namespace vrv
@@ -11,6 +11,7 @@
 
 #include <assert.h>
 #include <math.h>
+#include <string.h>
 
 //----------------------------------------------------------------------------
 
@@ -23,6 +24,10 @@
 
 //----------------------------------------------------------------------------
 
+#include "pugixml.hpp"
+
+//----------------------------------------------------------------------------
+
 namespace vrv {
 
 #define space " "
@@ -36,11 +41,92 @@ static inline double DegToRad(double deg)
 // static inline double RadToDeg(double deg) { return (deg * 180.0) / M_PI; } // unused
 }
 
+static inline void AppendInt(std::string &output, int value)
+{
+    char buffer[16];
+    char *end = buffer + sizeof(buffer);
+    char *begin = end;
+    unsigned int absValue = (value < 0) ? 0 - (unsigned int)value : (unsigned int)value;
+    do {
+        *(--begin) = (char)('0' + absValue % 10);
+        absValue /= 10;
+    } while (absValue);
+    if (value < 0) *(--begin) = '-';
+    output.append(begin, end - begin);
+}
+
+static void AppendEscaped(std::string &output, const std::string &value, bool attribute)
+{
+    // Same escaping as pugixml for attributes and pcdata
+    for (std::string::const_iterator it = value.begin(); it != value.end(); ++it) {
+        unsigned char c = (unsigned char)(*it);
+        switch (c) {
+            case '&': output += "&amp;"; break;
+            case '<': output += "&lt;"; break;
+            case '>': output += "&gt;"; break;
+            case '"':
+                if (attribute)
+                    output += "&quot;";
+                else
+                    output += '"';
+                break;
+            default:
+                if ((c < 32) && (c != '\t') && (attribute || ((c != '\n') && (c != '\r')))) {
+                    output += "&#";
+                    output += (char)('0' + c / 10);
+                    output += (char)('0' + c % 10);
+                    output += ';';
+                }
+                else {
+                    output += (char)c;
+                }
+        }
+    }
+}
+
+static inline void ShiftOffset(size_t &offset, size_t pos, int delta)
+{
+    if (offset == std::string::npos) return;
+    // an insertion moves what is at the position, a deletion only what is after
+    if (((delta > 0) && (offset >= pos)) || ((delta < 0) && (offset > pos))) offset += delta;
+}
+
+//----------------------------------------------------------------------------
+// SvgElement
+//----------------------------------------------------------------------------
+
+SvgElement::SvgElement(const char *name, int depth, size_t tagEnd)
+{
+    m_name = name;
+    m_depth = depth;
+    m_tagEnd = tagEnd;
+    m_firstG = std::string::npos;
+    m_end = (tagEnd == std::string::npos) ? 0 : tagEnd + 1;
+    m_hasChildren = false;
+    m_hasEndTag = false;
+    m_graphic = -1;
+    m_isCopy = false;
+    m_edit = 0;
+}
+
 //----------------------------------------------------------------------------
 // SvgDeviceContext
 //----------------------------------------------------------------------------
 
 SvgDeviceContext::SvgDeviceContext(int width, int height) : DeviceContext()
+{
+    m_compact = false;
+    m_removeIds = false;
+    m_glyphSprite = false;
+
+    this->Reset(width, height);
+}
+
+SvgDeviceContext::~SvgDeviceContext()
+{
+}
+
+void SvgDeviceContext::Reset(int width, int height)
 {
     m_width = width;
     m_height = height;
@@ -50,97 +136,345 @@ SvgDeviceContext::SvgDeviceContext(int width, int height) : DeviceContext()
     m_originX = 0;
     m_originY = 0;
 
+    m_penStack = std::stack<Pen>();
+    m_brushStack = std::stack<Brush>();
+    m_fontStack = std::stack<FontInfo *>();
     SetBrush(AxBLACK, AxSOLID);
     SetPen(AxBLACK, 1, AxSOLID);
 
     m_smufl_glyphs.clear();
+    m_smuflGlyphSizes.clear();
 
-    m_committed = false;
     m_vrvTextFont = false;
 
-    // create the initial SVG element
-    // width and height need to be set later; these are taken care of in "commit"
-    m_svgNode = m_svgDoc.append_child("svg");
-    m_svgNode.append_attribute("version") = "1.1";
-    m_svgNode.append_attribute("xmlns") = "http://www.w3.org/2000/svg";
-    m_svgNode.append_attribute("xmlns:xlink") = "http://www.w3.org/1999/xlink";
-    m_svgNode.append_attribute("overflow") = "visible";
+    // the buffers keep their capacity for the next SVG
+    m_body.clear();
+    m_graphics.clear();
+    m_graphicIds.clear();
+    m_edits.clear();
+
+    // start the stack with the root <svg> - its start tag is written only with the <defs> in WriteHead
+    m_elementStack.clear();
+    m_elementStack.push_back(SvgElement("svg", 0, std::string::npos));
+}
 
-    // start the stack
-    m_svgNodeStack.push_back(m_svgNode);
-    m_currentNode = m_svgNode;
+bool SvgDeviceContext::WriteHead(std::string &head, bool xml_declaration)
+{
+    if (xml_declaration) {
+        head += "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"no\"?>";
+        if (!m_compact) head += "\n";
+    }
+
+    // take care of width/height once userScale is updated
+    head += "<svg width=\"";
+    AppendInt(head, (int)((double)m_width * m_userScaleX));
+    head += "px\" height=\"";
+    AppendInt(head, (int)((double)m_height * m_userScaleY));
+    head += "px\" version=\"1.1\" xmlns=\"http://www.w3.org/2000/svg\" xmlns:xlink=\"http://www.w3.org/1999/xlink\" "
+            "overflow=\"visible\"";
+
+    if (m_smufl_glyphs.empty() && !m_vrvTextFont && m_body.empty()) {
+        head += (m_compact) ? " />" : " />\n";
+        return false;
+    }
+    head += ">";
 
-    m_outdata.clear();
+    // header - the glyphs are not defined in the page when they are referenced in a sprite
+    if (m_glyphSprite) {
+        // nothing to define
+    }
+    else if (m_compact && (m_smuflGlyphSizes.size() > 0)) {
+        this->WriteCompactDefs(head);
+    }
+    else if (m_smufl_glyphs.size() > 0) {
+        size_t defsStart = head.size();
+        head += "\n\t<defs>";
+        bool hasDefs = false;
+
+        // for each needed glyph
+        std::vector<std::string>::const_iterator it;
+        for (it = m_smufl_glyphs.begin(); it != m_smufl_glyphs.end(); ++it) {
+            // load and format the XML file that contains it (only once per device context)
+            std::string &glyphDef = m_glyphDefs[*it];
+            if (glyphDef.empty()) {
+                pugi::xml_document sourceDoc;
+                std::ifstream source((*it).c_str());
+                sourceDoc.load(source);
+                for (pugi::xml_node child = sourceDoc.first_child(); child; child = child.next_sibling()) {
+                    std::ostringstream childStream;
+                    child.print(childStream, "\t", pugi::format_default, pugi::encoding_auto, 2);
+                    std::string childStr = childStream.str();
+                    glyphDef += "\n";
+                    glyphDef.append(childStr, 0, childStr.size() - 1);
+                }
+            }
+            if (!glyphDef.empty()) hasDefs = true;
+            head += glyphDef;
+        }
+        if (hasDefs) {
+            head += "\n\t</defs>";
+        }
+        else {
+            head.replace(defsStart, std::string::npos, "\n\t<defs />");
+        }
+    }
+
+    // add the woff VerovioText font if needed
+    if (m_vrvTextFont) {
+        std::string &woffDef = (m_compact) ? m_compactWoffDef : m_woffDef;
+        if (woffDef.empty()) {
+            pugi::xml_document woffDoc;
+            std::string woff = Resources::GetPath() + "/woff.xml";
+            woffDoc.load_file(woff.c_str());
+            if (woffDoc.first_child()) {
+                std::ostringstream woffStream;
+                if (m_compact) {
+                    woffDoc.first_child().print(woffStream, "", pugi::format_raw);
+                    woffDef = woffStream.str();
+                }
+                else {
+                    woffDoc.first_child().print(woffStream, "\t", pugi::format_default, pugi::encoding_auto, 1);
+                    std::string woffStr = woffStream.str();
+                    woffDef = "\n";
+                    woffDef.append(woffStr, 0, woffStr.size() - 1);
+                }
+            }
+        }
+        head += woffDef;
+    }
+
+    return true;
 }
 
-SvgDeviceContext::~SvgDeviceContext()
+void SvgDeviceContext::AddGlyphs(const std::wstring &text, int pointSize)
 {
+    for (unsigned int i = 0; i < text.length(); i++) {
+        Glyph *glyph = Resources::GetGlyph(text[i]);
+        if (glyph) this->AddGlyph(glyph, pointSize);
+    }
 }
 
-bool SvgDeviceContext::CopyFileToStream(const std::string &filename, std::ostream &dest)
+void SvgDeviceContext::AddGlyph(Glyph *glyph, int pointSize)
 {
-    std::ifstream source(filename.c_str(), std::ios::binary);
-    dest << source.rdbuf();
-    source.close();
-    return true;
+    // Add the glyph to the array for the <defs>
+    std::string path = glyph->GetPath();
+    if (std::find(m_smufl_glyphs.begin(), m_smufl_glyphs.end(), path) == m_smufl_glyphs.end()) {
+        m_smufl_glyphs.push_back(path);
+    }
+    if (m_compact) {
+        // the glyph is defined for each size
+        std::pair<Glyph *, int> glyphSize(glyph, pointSize);
+        if (std::find(m_smuflGlyphSizes.begin(), m_smuflGlyphSizes.end(), glyphSize) == m_smuflGlyphSizes.end()) {
+            m_smuflGlyphSizes.push_back(glyphSize);
+        }
+    }
 }
 
-void SvgDeviceContext::Commit(bool xml_declaration)
+void SvgDeviceContext::WriteCompactDefs(std::string &head)
 {
+    head += "<defs>";
+
+    // for each needed glyph and size
+    std::vector<std::pair<Glyph *, int> >::const_iterator it;
+    for (it = m_smuflGlyphSizes.begin(); it != m_smuflGlyphSizes.end(); ++it) {
+        Glyph *glyph = it->first;
+        // load the content of the <symbol> without formatting (only once per device context)
+        std::pair<int, std::string> &glyphDef = m_compactGlyphDefs[glyph->GetPath()];
+        if (glyphDef.first == 0) {
+            pugi::xml_document sourceDoc;
+            std::ifstream source(glyph->GetPath().c_str());
+            sourceDoc.load(source);
+            pugi::xml_node symbol = sourceDoc.first_child();
+            // the viewBox of the glyphs is square and starts at 0 0
+            double x, y, width, height;
+            if ((sscanf(symbol.attribute("viewBox").value(), "%lf %lf %lf %lf", &x, &y, &width, &height) != 4)
+                || (width <= 0)) {
+                LogWarning("Glyph '%s' does not have a valid viewBox", glyph->GetPath().c_str());
+                width = 1000;
+            }
+            glyphDef.first = (int)width;
+            std::ostringstream symbolStream;
+            for (pugi::xml_node child = symbol.first_child(); child; child = child.next_sibling()) {
+                child.print(symbolStream, "", pugi::format_raw);
+            }
+            glyphDef.second = symbolStream.str();
+        }
 
-    if (m_committed) {
-        return;
+        // a <g> scaled to the size replaces the <symbol> and its viewBox mapping in each <use>
+        head += "<g id=\"";
+        head += glyph->GetCodeStr();
+        head += '-';
+        AppendInt(head, it->second);
+        head += "\" transform=\"scale(";
+        head += StringFormat("%.10g", (double)it->second / glyphDef.first);
+        head += ")\">";
+        head += glyphDef.second;
+        head += "</g>";
     }
 
-    // take care of width/height once userScale is updated
-    m_svgNode.prepend_attribute("height") = StringFormat("%dpx", (int)((double)m_height * m_userScaleY)).c_str();
-    m_svgNode.prepend_attribute("width") = StringFormat("%dpx", (int)((double)m_width * m_userScaleX)).c_str();
+    head += "</defs>";
+}
 
-    // add the woff VerovioText font if needed
-    if (m_vrvTextFont) {
-        std::string woff = Resources::GetPath() + "/woff.xml";
-        pugi::xml_document woffDoc;
-        woffDoc.load_file(woff.c_str());
-        m_svgNode.prepend_copy(woffDoc.first_child());
+void SvgDeviceContext::StartTag(const char *name)
+{
+    m_tag.clear();
+    if (!m_compact) {
+        m_tag += '\n';
+        m_tag.append(m_elementStack.back().m_depth + 1, '\t');
     }
+    m_tag += '<';
+    m_tag += name;
+}
 
-    // header
-    if (m_smufl_glyphs.size() > 0) {
+void SvgDeviceContext::AddAttribute(const char *name, const std::string &value)
+{
+    m_tag += ' ';
+    m_tag += name;
+    m_tag += "=\"";
+    AppendEscaped(m_tag, value, true);
+    m_tag += '"';
+}
 
-        pugi::xml_node defs = m_svgNode.prepend_child("defs");
-        pugi::xml_document sourceDoc;
+void SvgDeviceContext::AddAttribute(const char *name, int value)
+{
+    m_tag += ' ';
+    m_tag += name;
+    m_tag += "=\"";
+    AppendInt(m_tag, value);
+    m_tag += '"';
+}
 
-        // for each needed glyph
-        std::vector<std::string>::const_iterator it;
-        for (it = m_smufl_glyphs.begin(); it != m_smufl_glyphs.end(); ++it) {
-            // load the XML file that contains it as a pugi::xml_document
-            std::ifstream source((*it).c_str());
-            sourceDoc.load(source);
+void SvgDeviceContext::AddStrokeWidth(int width)
+{
+    // the presentation attribute is shorter than the style one in the compact output
+    if (m_compact) {
+        this->AddAttribute("stroke-width", width);
+    }
+    else {
+        m_tag += " style=\"stroke-width: ";
+        AppendInt(m_tag, width);
+        m_tag += ";\"";
+    }
+}
 
-            // copy all the nodes inside into the master document
-            for (pugi::xml_node child = sourceDoc.first_child(); child; child = child.next_sibling()) {
-                defs.append_copy(child);
-            }
+size_t SvgDeviceContext::WriteChild(bool beforeG, bool isG)
+{
+    SvgElement &parent = m_elementStack.back();
+    parent.m_hasChildren = true;
+    size_t pos = (beforeG && (parent.m_firstG != std::string::npos)) ? parent.m_firstG : parent.m_end;
+    bool isFirstG = (isG && (parent.m_firstG == std::string::npos));
+
+    this->Insert(pos, m_tag);
+
+    // set after the insertion for the offset not to be moved by it
+    if (isFirstG) m_elementStack.back().m_firstG = pos;
+    return pos;
+}
+
+void SvgDeviceContext::WriteEmptyElement(bool beforeG)
+{
+    m_tag += " />";
+    this->WriteChild(beforeG, false);
+}
+
+void SvgDeviceContext::WriteStartElement(const char *name, bool beforeG, const std::string &gId)
+{
+    m_tag += '>';
+    bool isG = (strcmp(name, "g") == 0);
+    size_t pos = this->WriteChild(beforeG, isG);
+
+    SvgElement element(name, m_elementStack.back().m_depth + 1, pos + m_tag.size() - 1);
+    element.m_id = gId;
+    m_elementStack.push_back(element);
+}
+
+void SvgDeviceContext::WriteEndElement()
+{
+    // never pop the root <svg>
+    assert(m_elementStack.size() > 1);
+    if (m_elementStack.size() < 2) return;
+
+    SvgElement element = m_elementStack.back();
+    m_elementStack.pop_back();
+
+    // the copy has the current offsets and children
+    if (element.m_isCopy) {
+        element.m_isCopy = false;
+        m_elementStack.back() = element;
+        return;
+    }
+
+    if (!element.m_hasChildren) {
+        this->Insert(element.m_tagEnd, " /");
+    }
+    else if (!element.m_hasEndTag) {
+        m_tag.clear();
+        if (!m_compact) {
+            m_tag += '\n';
+            m_tag.append(element.m_depth, '\t');
         }
+        m_tag += "</";
+        m_tag += element.m_name;
+        m_tag += '>';
+        this->Insert(element.m_end, m_tag);
+        element.m_hasEndTag = true;
     }
 
-    unsigned int output_flags = pugi::format_default | pugi::format_no_declaration;
-    if (xml_declaration) {
-        // edit the xml declaration
-        output_flags = pugi::format_default;
-        pugi::xml_node decl = m_svgDoc.prepend_child(pugi::node_declaration);
-        decl.append_attribute("version") = "1.0";
-        decl.append_attribute("encoding") = "UTF-8";
-        decl.append_attribute("standalone") = "no";
+    // keep the <g> with an id for resuming them - only the first one with a given id can be found
+    if (element.m_id.empty()) return;
+    element.m_edit = m_edits.size();
+    if (element.m_graphic != -1) {
+        m_graphics.at(element.m_graphic) = element;
+    }
+    else if (m_graphicIds.find(element.m_id) == m_graphicIds.end()) {
+        m_graphicIds[element.m_id] = (int)m_graphics.size();
+        m_graphics.push_back(element);
+    }
+}
+
+void SvgDeviceContext::Insert(size_t pos, const std::string &data)
+{
+    if (pos == m_body.size()) {
+        m_body.append(data);
+    }
+    else {
+        m_body.insert(pos, data);
+        // the resumable graphics are updated only when resumed
+        m_edits.push_back(std::make_pair(pos, (int)data.size()));
+    }
+
+    std::vector<SvgElement>::iterator it;
+    for (it = m_elementStack.begin(); it != m_elementStack.end(); ++it) {
+        ShiftOffset(it->m_tagEnd, pos, (int)data.size());
+        ShiftOffset(it->m_firstG, pos, (int)data.size());
+        ShiftOffset(it->m_end, pos, (int)data.size());
     }
+}
 
-    // save the glyph data to m_outdata
-    m_svgDoc.save(m_outdata, "\t", output_flags);
+void SvgDeviceContext::Erase(size_t pos, size_t length)
+{
+    m_body.erase(pos, length);
+    m_edits.push_back(std::make_pair(pos, -(int)length));
+
+    std::vector<SvgElement>::iterator it;
+    for (it = m_elementStack.begin(); it != m_elementStack.end(); ++it) {
+        ShiftOffset(it->m_tagEnd, pos, -(int)length);
+        ShiftOffset(it->m_firstG, pos, -(int)length);
+        ShiftOffset(it->m_end, pos, -(int)length);
+    }
+}
 
-    m_committed = true;
+void SvgDeviceContext::ApplyEdits(SvgElement &element)
+{
+    for (size_t i = element.m_edit; i < m_edits.size(); ++i) {
+        ShiftOffset(element.m_tagEnd, m_edits.at(i).first, m_edits.at(i).second);
+        ShiftOffset(element.m_firstG, m_edits.at(i).first, m_edits.at(i).second);
+        ShiftOffset(element.m_end, m_edits.at(i).first, m_edits.at(i).second);
+    }
+    element.m_edit = m_edits.size();
 }
 
-void SvgDeviceContext::StartGraphic(Object *object, std::string gClass, std::string gId)
+void SvgDeviceContext::StartGraphic(Object *object, const std::string &gClass, const std::string &gId)
 {
     std::string baseClass = object->GetClassName();
     std::transform(baseClass.begin(), baseClass.begin() + 1, baseClass.begin(), ::tolower);
@@ -148,17 +482,17 @@ void SvgDeviceContext::StartGraphic(Object *object, std::string gClass, std::str
         baseClass.append(" " + gClass);
     }
 
-    m_currentNode = m_currentNode.append_child("g");
-    m_svgNodeStack.push_back(m_currentNode);
-    m_currentNode.append_attribute("class") = baseClass.c_str();
-    m_currentNode.append_attribute("id") = gId.c_str();
+    this->StartTag("g");
+    this->AddAttribute("class", baseClass);
+    if (!m_removeIds) this->AddAttribute("id", gId);
+    this->WriteStartElement("g", false, gId);
     // m_currentNode.append_attribute("style") = StringFormat("stroke: #%s; stroke-opacity: %f; fill: #%s; fill-opacity:
     // %f;",
     // GetColour(currentPen.GetColour()).c_str(), currentPen.GetOpacity(), GetColour(currentBrush.GetColour()).c_str(),
     // currentBrush.GetOpacity()).c_str();
 }
 
-void SvgDeviceContext::StartTextGraphic(Object *object, std::string gClass, std::string gId)
+void SvgDeviceContext::StartTextGraphic(Object *object, const std::string &gClass, const std::string &gId)
 {
     std::string baseClass = object->GetClassName();
     std::transform(baseClass.begin(), baseClass.begin() + 1, baseClass.begin(), ::tolower);
@@ -166,40 +500,48 @@ void SvgDeviceContext::StartTextGraphic(Object *object, std::string gClass, std:
         baseClass.append(" " + gClass);
     }
 
-    m_currentNode = AppendChild("tspan");
-    m_svgNodeStack.push_back(m_currentNode);
-    m_currentNode.append_attribute("class") = baseClass.c_str();
-    m_currentNode.append_attribute("id") = gId.c_str();
+    this->StartTag("tspan");
+    this->AddAttribute("class", baseClass);
+    if (!m_removeIds) this->AddAttribute("id", gId);
+    this->WriteStartElement("tspan", true);
 }
 
-void SvgDeviceContext::ResumeGraphic(Object *object, std::string gId)
+void SvgDeviceContext::ResumeGraphic(Object *object, const std::string &gId)
 {
-    std::string xpath = "//g[@id=\"" + gId + "\"]";
-    pugi::xpath_node selection = m_currentNode.select_single_node(xpath.c_str());
-    if (selection) {
-        m_currentNode = selection.node();
+    std::map<std::string, int>::iterator it = m_graphicIds.find(gId);
+    // not found - keep writing in the current element
+    if (it == m_graphicIds.end()) {
+        m_elementStack.push_back(m_elementStack.back());
+        m_elementStack.back().m_isCopy = true;
+        return;
+    }
+
+    SvgElement element = m_graphics.at(it->second);
+    this->ApplyEdits(element);
+    element.m_graphic = it->second;
+    // written as <g ... /> - the " /" is added back if nothing is added to it
+    if (!element.m_hasChildren) {
+        this->Erase(element.m_tagEnd, 2);
+        element.m_end = element.m_tagEnd + 1;
     }
-    m_svgNodeStack.push_back(m_currentNode);
+    m_elementStack.push_back(element);
 }
 
 void SvgDeviceContext::EndGraphic(Object *object, View *view)
 {
     DrawSvgBoundingBox(object, view);
-    m_svgNodeStack.pop_back();
-    m_currentNode = m_svgNodeStack.back();
+    this->WriteEndElement();
 }
 
 void SvgDeviceContext::EndResumedGraphic(Object *object, View *view)
 {
     DrawSvgBoundingBox(object, view);
-    m_svgNodeStack.pop_back();
-    m_currentNode = m_svgNodeStack.back();
+    this->WriteEndElement();
 }
 
 void SvgDeviceContext::EndTextGraphic(Object *object, View *view)
 {
-    m_svgNodeStack.pop_back();
-    m_currentNode = m_svgNodeStack.back();
+    this->WriteEndElement();
 }
 
 void SvgDeviceContext::StartPage()
@@ -208,30 +550,35 @@ void SvgDeviceContext::StartPage()
     m_vrvTextFont = false;
 
     // a graphic for definition scaling
-    m_currentNode = m_currentNode.append_child("svg");
-    m_svgNodeStack.push_back(m_currentNode);
-    m_currentNode.append_attribute("id") = "definition-scale";
-    m_currentNode.append_attribute("viewBox")
-        = StringFormat("0 0 %d %d", m_width * DEFINITON_FACTOR, m_height * DEFINITON_FACTOR).c_str();
+    this->StartTag("svg");
+    this->AddAttribute("id", "definition-scale");
+    m_tag += " viewBox=\"0 0 ";
+    AppendInt(m_tag, m_width * DEFINITON_FACTOR);
+    m_tag += ' ';
+    AppendInt(m_tag, m_height * DEFINITON_FACTOR);
+    m_tag += '"';
+    this->WriteStartElement("svg", false);
 
     // a graphic for the origin
-    m_currentNode = m_currentNode.append_child("g");
-    m_svgNodeStack.push_back(m_currentNode);
-    m_currentNode.append_attribute("class") = "page-margin";
-    m_currentNode.append_attribute("transform")
-        = StringFormat("translate(%d, %d)", (int)((double)m_originX), (int)((double)m_originY)).c_str();
-    m_currentNode.append_attribute("style") = "stroke: #000; stroke-opacity: 1.0; fill: #000; fill-opacity: 1.0";
+    this->StartTag("g");
+    this->AddAttribute("class", "page-margin");
+    m_tag += " transform=\"translate(";
+    AppendInt(m_tag, m_originX);
+    m_tag += ", ";
+    AppendInt(m_tag, m_originY);
+    m_tag += ")\"";
+    this->AddAttribute("style", "stroke: #000; stroke-opacity: 1.0; fill: #000; fill-opacity: 1.0");
+    this->WriteStartElement("g", false);
 }
 
 void SvgDeviceContext::EndPage()
 {
     // end page-margin
-    m_svgNodeStack.pop_back();
+    this->WriteEndElement();
     // end definition-scale
-    m_svgNodeStack.pop_back();
+    this->WriteEndElement();
     // end page-scale
-    // m_svgNodeStack.pop_back();
-    m_currentNode = m_svgNodeStack.back();
+    // this->WriteEndElement();
 }
 
 void SvgDeviceContext::SetBackground(int colour, int style)
@@ -275,34 +622,31 @@ Point SvgDeviceContext::GetLogicalOrigin()
     return Point(m_originX, m_originY);
 }
 
-pugi::xml_node SvgDeviceContext::AppendChild(std::string name)
-{
-    pugi::xml_node g = m_currentNode.child("g");
-    if (g)
-        return m_currentNode.insert_child_before(name.c_str(), g);
-    else
-        return m_currentNode.append_child(name.c_str());
-}
-
 // Drawing mething
 void SvgDeviceContext::DrawComplexBezierPath(Point bezier1[4], Point bezier2[4])
 {
-    pugi::xml_node pathChild = AppendChild("path");
-    pathChild.append_attribute("d")
-        = StringFormat("M%d,%d C%d,%d %d,%d %d,%d C%d,%d %d,%d %d,%d", bezier1[0].x, bezier1[0].y, // M command
-              bezier1[1].x, bezier1[1].y, bezier1[2].x, bezier1[2].y, bezier1[3].x, bezier1[3].y, // First bezier
-              bezier2[2].x, bezier2[2].y, bezier2[1].x, bezier2[1].y, bezier2[0].x, bezier2[0].y // Second Bezier
-              )
-              .c_str();
+    this->StartTag("path");
+    // M command, first bezier and second Bezier
+    m_tag += " d=\"M";
+    AppendInt(m_tag, bezier1[0].x);
+    m_tag += ',';
+    AppendInt(m_tag, bezier1[0].y);
+    for (int i = 1; i < 7; ++i) {
+        Point point = (i < 4) ? bezier1[i] : bezier2[6 - i];
+        m_tag += ((i == 1) || (i == 4)) ? " C" : " ";
+        AppendInt(m_tag, point.x);
+        m_tag += ',';
+        AppendInt(m_tag, point.y);
+    }
+    m_tag += '"';
     // pathChild.append_attribute("style") = StringFormat("fill:#000; fill-opacity:1.0; stroke:#000000;
     // stroke-linecap:round; stroke-linejoin:round;
     // stroke-opacity:1.0; stroke-width: %d", m_penStack.top().GetWidth()).c_str();
     // without colour
-    pathChild.append_attribute("style")
-        = StringFormat(
-              "fill-opacity:1.0; stroke-linecap:round; stroke-linejoin:round; stroke-opacity:1.0; stroke-width: %d",
-              m_penStack.top().GetWidth())
-              .c_str();
+    m_tag += " style=\"fill-opacity:1.0; stroke-linecap:round; stroke-linejoin:round; stroke-opacity:1.0; stroke-width: ";
+    AppendInt(m_tag, m_penStack.top().GetWidth());
+    m_tag += '"';
+    this->WriteEmptyElement(true);
 }
 
 void SvgDeviceContext::DrawCircle(int x, int y, int radius)
@@ -321,21 +665,20 @@ void SvgDeviceContext::DrawEllipse(int x, int y, int width, int height)
     int rh = height / 2;
     int rw = width / 2;
 
-    pugi::xml_node ellipseChild = AppendChild("ellipse");
-    ellipseChild.append_attribute("cx") = x + rw;
-    ellipseChild.append_attribute("cy") = y + rh;
-    ellipseChild.append_attribute("rx") = rw;
-    ellipseChild.append_attribute("ry") = rh;
+    this->StartTag("ellipse");
+    this->AddAttribute("cx", x + rw);
+    this->AddAttribute("cy", y + rh);
+    this->AddAttribute("rx", rw);
+    this->AddAttribute("ry", rh);
 
     // ellipseChild.append_attribute("style") = StringFormat("stroke: #%s; stroke-opacity: %f; stroke-width: %d; fill:
     // #%s; fill-opacity: %f;",
     // GetColour(currentPen.GetColour()).c_str(), currentPen.GetOpacity(), currentPen.GetWidth(),
     //    GetColour(currentBrush.GetColour()).c_str(), currentBrush.GetOpacity()).c_str();
     // without colour
-    ellipseChild.append_attribute("style")
-        = StringFormat("stroke-opacity: %f; stroke-width: %d; fill-opacity: %f;", currentPen.GetOpacity(),
-              currentPen.GetWidth(), currentBrush.GetOpacity())
-              .c_str();
+    this->AddAttribute("style", StringFormat("stroke-opacity: %f; stroke-width: %d; fill-opacity: %f;",
+                                    currentPen.GetOpacity(), currentPen.GetWidth(), currentBrush.GetOpacity()));
+    this->WriteEmptyElement(true);
 }
 
 void SvgDeviceContext::DrawEllipticArc(int x, int y, int width, int height, double start, double end)
@@ -396,44 +739,56 @@ void SvgDeviceContext::DrawEllipticArc(int x, int y, int width, int height, doub
     else
         fSweep = 0;
 
-    pugi::xml_node pathChild = AppendChild("path");
-    pathChild.append_attribute("d") = StringFormat("M%d %d A%d %d 0.0 %d %d %d %d", int(xs), int(ys), abs(int(rx)),
-                                          abs(int(ry)), fArc, fSweep, int(xe), int(ye))
-                                          .c_str();
+    this->StartTag("path");
+    this->AddAttribute("d", StringFormat("M%d %d A%d %d 0.0 %d %d %d %d", int(xs), int(ys), abs(int(rx)),
+                                abs(int(ry)), fArc, fSweep, int(xe), int(ye)));
     // pathChild.append_attribute("style") = StringFormat("stroke: #%s; stroke-opacity: %f; stroke-width: %d; fill: #%s;
     // fill-opacity: %f;",
     // GetColour(currentPen.GetColour()).c_str(), currentPen.GetOpacity(), currentPen.GetWidth(),
     //                                                        GetColour(currentBrush.GetColour()).c_str(),
     //                                                        currentBrush.GetOpacity()).c_str();
     // without colour
-    pathChild.append_attribute("style") = StringFormat("stroke-opacity: %f; stroke-width: %d; fill-opacity: %f;",
-                                              currentPen.GetOpacity(), currentPen.GetWidth(), currentBrush.GetOpacity())
-                                              .c_str();
+    this->AddAttribute("style", StringFormat("stroke-opacity: %f; stroke-width: %d; fill-opacity: %f;",
+                                    currentPen.GetOpacity(), currentPen.GetWidth(), currentBrush.GetOpacity()));
+    this->WriteEmptyElement(true);
 }
 
 void SvgDeviceContext::DrawLine(int x1, int y1, int x2, int y2)
 {
-    pugi::xml_node pathChild = AppendChild("path");
-    pathChild.append_attribute("d") = StringFormat("M%d %d L%d %d", x1, y1, x2, y2).c_str();
-    pathChild.append_attribute("style") = StringFormat("stroke-width: %d;", m_penStack.top().GetWidth()).c_str();
+    this->StartTag("path");
+    m_tag += " d=\"M";
+    AppendInt(m_tag, x1);
+    m_tag += ' ';
+    AppendInt(m_tag, y1);
+    m_tag += " L";
+    AppendInt(m_tag, x2);
+    m_tag += ' ';
+    AppendInt(m_tag, y2);
+    m_tag += '"';
+    this->AddStrokeWidth(m_penStack.top().GetWidth());
+    this->WriteEmptyElement(true);
 }
 
 void SvgDeviceContext::DrawPolygon(int n, Point points[], int xoffset, int yoffset, int fill_style)
 {
     assert(m_penStack.size());
 
-    pugi::xml_node polygonChild = AppendChild("polygon");
+    this->StartTag("polygon");
     // if (fillStyle == wxODDEVEN_RULE)
     //    polygonChild.append_attribute("style") = "fill-rule:evenodd;";
     // else
-    polygonChild.append_attribute("style") = "fill-rule:nonzero;";
-    polygonChild.append_attribute("stroke-width") = StringFormat("%d", m_penStack.top().GetWidth()).c_str();
+    this->AddAttribute("style", "fill-rule:nonzero;");
+    this->AddAttribute("stroke-width", m_penStack.top().GetWidth());
 
-    std::string pointsString;
+    m_tag += " points=\"";
     for (int i = 0; i < n; i++) {
-        pointsString += StringFormat("%d,%d ", points[i].x + xoffset, points[i].y + yoffset);
+        AppendInt(m_tag, points[i].x + xoffset);
+        m_tag += ',';
+        AppendInt(m_tag, points[i].y + yoffset);
+        m_tag += ' ';
     }
-    polygonChild.append_attribute("points") = pointsString.c_str();
+    m_tag += '"';
+    this->WriteEmptyElement(true);
 }
 
 void SvgDeviceContext::DrawRectangle(int x, int y, int width, int height)
@@ -443,8 +798,6 @@ void SvgDeviceContext::DrawRectangle(int x, int y, int width, int height)
 
 void SvgDeviceContext::DrawRoundedRectangle(int x, int y, int width, int height, double radius)
 {
-    std::string s;
-
     // negative heights or widths are not allowed in SVG
     if (height < 0) {
         height = -height;
@@ -455,19 +808,19 @@ void SvgDeviceContext::DrawRoundedRectangle(int x, int y, int width, int height,
         x -= width;
     }
 
-    pugi::xml_node rectChild = AppendChild("rect");
-    rectChild.append_attribute("x") = x;
-    rectChild.append_attribute("y") = y;
-    rectChild.append_attribute("width") = width;
-    rectChild.append_attribute("height") = height;
-    rectChild.append_attribute("rx") = radius;
-    rectChild.append_attribute("style") = StringFormat("stroke-width: %d;", m_penStack.top().GetWidth()).c_str();
+    this->StartTag("rect");
+    this->AddAttribute("x", x);
+    this->AddAttribute("y", y);
+    this->AddAttribute("width", width);
+    this->AddAttribute("height", height);
+    this->AddAttribute("rx", StringFormat("%.17g", radius));
+    this->AddStrokeWidth(m_penStack.top().GetWidth());
     // rectChild.append_attribute("fill-opacity") = "0.0"; // for empty rectangles with bounding boxes
+    this->WriteEmptyElement(true);
 }
 
 void SvgDeviceContext::StartText(int x, int y, char alignment)
 {
-    std::string s;
     std::string anchor;
 
     if (alignment == RIGHT) {
@@ -477,53 +830,55 @@ void SvgDeviceContext::StartText(int x, int y, char alignment)
         anchor = "middle";
     }
 
-    m_currentNode = AppendChild("text");
-    m_svgNodeStack.push_back(m_currentNode);
-    m_currentNode.append_attribute("x") = x;
-    m_currentNode.append_attribute("y") = y;
-    m_currentNode.append_attribute("dx") = 0;
-    m_currentNode.append_attribute("dy") = 0;
+    this->StartTag("text");
+    this->AddAttribute("x", x);
+    this->AddAttribute("y", y);
+    this->AddAttribute("dx", 0);
+    this->AddAttribute("dy", 0);
     if (!anchor.empty()) {
-        m_currentNode.append_attribute("text-anchor") = anchor.c_str();
+        this->AddAttribute("text-anchor", anchor);
     }
     // font-size seems to be required in <text> in FireFox and also we set it to 0px so space
     // is not added between tspan elements
-    m_currentNode.append_attribute("font-size") = "0px";
+    this->AddAttribute("font-size", "0px");
     //
     if (!m_fontStack.top()->GetFaceName().empty()) {
-        m_currentNode.append_attribute("font-family") = m_fontStack.top()->GetFaceName().c_str();
+        this->AddAttribute("font-family", m_fontStack.top()->GetFaceName());
     }
     if (m_fontStack.top()->GetStyle() != FONTSTYLE_NONE) {
         if (m_fontStack.top()->GetStyle() == FONTSTYLE_italic) {
-            m_currentNode.append_attribute("font-style") = "italic";
+            this->AddAttribute("font-style", "italic");
         }
         else if (m_fontStack.top()->GetStyle() == FONTSTYLE_normal) {
-            m_currentNode.append_attribute("font-style") = "normal";
+            this->AddAttribute("font-style", "normal");
         }
         else if (m_fontStack.top()->GetStyle() == FONTSTYLE_oblique) {
-            m_currentNode.append_attribute("font-style") = "oblique";
+            this->AddAttribute("font-style", "oblique");
         }
     }
     if (m_fontStack.top()->GetWeight() != FONTWEIGHT_NONE) {
         if (m_fontStack.top()->GetWeight() == FONTWEIGHT_bold) {
-            m_currentNode.append_attribute("font-weight") = "bold";
+            this->AddAttribute("font-weight", "bold");
         }
     }
+    this->WriteStartElement("text", true);
 }
 
 void SvgDeviceContext::MoveTextTo(int x, int y)
 {
-    m_currentNode.append_attribute("x") = x;
-    m_currentNode.append_attribute("y") = y;
+    // the attributes are added to the start tag of the current element
+    m_tag.clear();
+    this->AddAttribute("x", x);
+    this->AddAttribute("y", y);
+    this->Insert(m_elementStack.back().m_tagEnd, m_tag);
 }
 
 void SvgDeviceContext::EndText()
 {
-    m_svgNodeStack.pop_back();
-    m_currentNode = m_svgNodeStack.back();
+    this->WriteEndElement();
 }
 
-void SvgDeviceContext::DrawText(const std::string &text, const std::wstring wtext)
+void SvgDeviceContext::DrawText(const std::string &text, const std::wstring &wtext)
 {
     assert(m_fontStack.top());
 
@@ -534,37 +889,43 @@ void SvgDeviceContext::DrawText(const std::string &text, const std::wstring wtex
         svgText.replace(0, 1, "\xC2\xA0");
     }
 
-    pugi::xml_node textChild = AppendChild("tspan");
+    this->StartTag("tspan");
     if (!m_fontStack.top()->GetFaceName().empty()) {
-        textChild.append_attribute("font-family") = m_fontStack.top()->GetFaceName().c_str();
+        this->AddAttribute("font-family", m_fontStack.top()->GetFaceName());
         // Special case where we want to specifiy if the VerovioText font (woff) needs to be included in the output
         if (m_fontStack.top()->GetFaceName() == "VerovioText") this->VrvTextFont();
     }
     if (m_fontStack.top()->GetPointSize() != 0) {
-        textChild.append_attribute("font-size") = StringFormat("%dpx", m_fontStack.top()->GetPointSize()).c_str();
+        m_tag += " font-size=\"";
+        AppendInt(m_tag, m_fontStack.top()->GetPointSize());
+        m_tag += "px\"";
     }
     if (m_fontStack.top()->GetStyle() != FONTSTYLE_NONE) {
         if (m_fontStack.top()->GetStyle() == FONTSTYLE_italic) {
-            textChild.append_attribute("font-style") = "italic";
+            this->AddAttribute("font-style", "italic");
         }
         else if (m_fontStack.top()->GetStyle() == FONTSTYLE_normal) {
-            textChild.append_attribute("font-style") = "normal";
+            this->AddAttribute("font-style", "normal");
         }
         else if (m_fontStack.top()->GetStyle() == FONTSTYLE_oblique) {
-            textChild.append_attribute("font-style") = "oblique";
+            this->AddAttribute("font-style", "oblique");
         }
     }
     if (m_fontStack.top()->GetWeight() != FONTWEIGHT_NONE) {
         if (m_fontStack.top()->GetWeight() == FONTWEIGHT_bold) {
-            textChild.append_attribute("font-weight") = "bold";
+            this->AddAttribute("font-weight", "bold");
         }
         else if (m_fontStack.top()->GetWeight() == FONTWEIGHT_normal) {
-            textChild.append_attribute("font-weight") = "normal";
+            this->AddAttribute("font-weight", "normal");
         }
     }
-    textChild.append_attribute("class") = "text";
-    textChild.append_attribute("xml:space") = "preserve";
-    textChild.append_child(pugi::node_pcdata).set_value(svgText.c_str());
+    this->AddAttribute("class", "text");
+    this->AddAttribute("xml:space", "preserve");
+    // the text is written with the element
+    m_tag += '>';
+    AppendEscaped(m_tag, svgText, false);
+    m_tag += "</tspan>";
+    this->WriteChild(true, false);
 }
 
 void SvgDeviceContext::DrawRotatedText(const std::string &text, int x, int y, double angle)
@@ -592,21 +953,32 @@ void SvgDeviceContext::DrawMusicText(const std::wstring &text, int x, int y)
             continue;
         }
 
-        std::string path = glyph->GetPath();
-
-        // Add the glyph to the array for the <defs>
-        std::vector<std::string>::const_iterator it = std::find(m_smufl_glyphs.begin(), m_smufl_glyphs.end(), path);
-        if (it == m_smufl_glyphs.end()) {
-            m_smufl_glyphs.push_back(path);
-        }
+        this->AddGlyph(glyph, m_fontStack.top()->GetPointSize());
 
         // Write the char in the SVG
-        pugi::xml_node useChild = AppendChild("use");
-        useChild.append_attribute("xlink:href") = StringFormat("#%s", glyph->GetCodeStr().c_str()).c_str();
-        useChild.append_attribute("x") = x;
-        useChild.append_attribute("y") = y;
-        useChild.append_attribute("height") = StringFormat("%dpx", m_fontStack.top()->GetPointSize()).c_str();
-        useChild.append_attribute("width") = StringFormat("%dpx", m_fontStack.top()->GetPointSize()).c_str();
+        this->StartTag("use");
+        if (m_compact) {
+            m_tag += " xlink:href=\"";
+            m_tag += m_glyphHref;
+            m_tag += '#';
+            m_tag += glyph->GetCodeStr();
+            m_tag += '-';
+            AppendInt(m_tag, m_fontStack.top()->GetPointSize());
+            m_tag += '"';
+            this->AddAttribute("x", x);
+            this->AddAttribute("y", y);
+        }
+        else {
+            this->AddAttribute("xlink:href", m_glyphHref + "#" + glyph->GetCodeStr());
+            this->AddAttribute("x", x);
+            this->AddAttribute("y", y);
+            m_tag += " height=\"";
+            AppendInt(m_tag, m_fontStack.top()->GetPointSize());
+            m_tag += "px\" width=\"";
+            AppendInt(m_tag, m_fontStack.top()->GetPointSize());
+            m_tag += "px\"";
+        }
+        this->WriteEmptyElement(true);
 
         // Get the bounds of the char
         if (glyph->GetHorizAdvX() > 0)
@@ -651,9 +1023,24 @@ std::string SvgDeviceContext::GetColour(int colour)
 
 std::string SvgDeviceContext::GetStringSVG(bool xml_declaration)
 {
-    if (!m_committed) Commit(xml_declaration);
+    std::string svg;
+    if (this->WriteHead(svg, xml_declaration)) {
+        svg.reserve(svg.size() + m_body.size() + 8);
+        svg += m_body;
+        svg += (m_compact) ? "</svg>" : "\n</svg>\n";
+    }
+    return svg;
+}
 
-    return m_outdata.str();
+void SvgDeviceContext::WriteSVG(std::ostream &output, bool xml_declaration)
+{
+    std::string head;
+    bool hasContent = this->WriteHead(head, xml_declaration);
+    output << head;
+    if (hasContent) {
+        output.write(m_body.c_str(), m_body.size());
+        output << ((m_compact) ? "</svg>" : "\n</svg>\n");
+    }
 }
 
 void SvgDeviceContext::DrawSvgBoundingBox(Object *object, View *view)
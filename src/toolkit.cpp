@@ -10,10 +10,20 @@
 //----------------------------------------------------------------------------
 
 #include <assert.h>
+#include <set>
+#include <sstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 //----------------------------------------------------------------------------
 
 #include "attcomparison.h"
+#include "editorial.h"
 #include "iodarms.h"
 #include "iomei.h"
 #include "iomusxml.h"
@@ -22,9 +32,12 @@
 #include "measure.h"
 #include "note.h"
 #include "page.h"
+#include "pdfdevicecontext.h"
+#include "rasterdevicecontext.h"
 #include "slur.h"
 #include "style.h"
 #include "svgdevicecontext.h"
+#include "unzip.h"
 #include "vrv.h"
 
 //----------------------------------------------------------------------------
@@ -57,7 +70,14 @@ Toolkit::Toolkit(bool initFont)
 
     m_noLayout = false;
     m_ignoreLayout = false;
+    m_lazyLayout = false;
+    m_measureRangeByIndex = false;
+    m_importThreads = 1;
     m_adjustPageHeight = false;
+    m_svgCompact = false;
+    m_svgRemoveIds = false;
+    m_svgGlyphSprite = false;
+    m_pngGrayscale = false;
     m_noJustification = false;
     m_evenNoteSpacing = false;
     m_showBoundingBoxes = false;
@@ -65,6 +85,14 @@ Toolkit::Toolkit(bool initFont)
 
     m_cString = NULL;
 
+    m_displayListPage = -1;
+    m_displayListPageCount = 0;
+
+#ifndef USE_EMSCRIPTEN
+    m_loadDone = true;
+    m_loadResult = false;
+#endif
+
     if (initFont) {
         Resources::InitFonts();
     }
@@ -72,6 +100,12 @@ Toolkit::Toolkit(bool initFont)
 
 Toolkit::~Toolkit()
 {
+#ifndef USE_EMSCRIPTEN
+    if (m_loadThread.joinable()) {
+        this->CancelLoad();
+        m_loadThread.join();
+    }
+#endif
     if (m_cString) {
         free(m_cString);
     }
@@ -200,11 +234,36 @@ bool Toolkit::SetFont(std::string const &font)
 
 bool Toolkit::LoadFile(const std::string &filename)
 {
-    if (IsUTF16(filename)) {
-        return LoadUTF16File(filename);
+#ifndef _WIN32
+    // Map the file privately for the input to be able to parse it in place without copying it
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
     }
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0) {
+        close(fd);
+        return false;
+    }
+    size_t length = (size_t)fileStat.st_size;
+    char *data = NULL;
+    if (length > 0) {
+        void *mapped = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(fd);
+            return false;
+        }
+        data = static_cast<char *>(mapped);
+    }
+    close(fd);
 
-    std::ifstream in(filename.c_str());
+    bool success = this->LoadFileBuffer(data, length, true);
+    if (data) {
+        munmap(data, length);
+    }
+    return success;
+#else
+    std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
     if (!in.is_open()) {
         return false;
     }
@@ -218,20 +277,13 @@ bool Toolkit::LoadFile(const std::string &filename)
     std::string content(fileSize, 0);
     in.read(&content[0], fileSize);
 
-    return LoadString(content);
+    return this->LoadFileBuffer(&content[0], content.size(), false);
+#endif
 }
 
-bool Toolkit::IsUTF16(const std::string &filename)
+bool Toolkit::IsUTF16(const char *data, size_t length)
 {
-    std::ifstream fin(filename.c_str(), std::ios::in | std::ios::binary);
-    if (!fin.is_open()) {
-        return false;
-    }
-
-    char data[2];
-    memset(data, 0, 2);
-    fin.read(data, 2);
-    fin.close();
+    if (length < 2) return false;
 
     if (memcmp(data, UTF_16_LE_BOM, 2) == 0) return true;
     if (memcmp(data, UTF_16_BE_BOM, 2) == 0) return true;
@@ -239,39 +291,75 @@ bool Toolkit::IsUTF16(const std::string &filename)
     return false;
 }
 
-bool Toolkit::LoadUTF16File(const std::string &filename)
+bool Toolkit::LoadFileBuffer(char *data, size_t length, bool fileMapping)
 {
-    /// Loading a UTF-16 file with basic conversion ot UTF-8
-    /// This is called after checking if the file has a UTF-16 BOM
+    // Compressed data is inflated into memory and loaded from there
+    std::string content;
+    if (Unzip::IsGzip(data, length) || Unzip::IsZip(data, length)) {
+        if (!this->Decompress(data, length, content)) {
+            return false;
+        }
+        data = &content[0];
+        length = content.size();
+        fileMapping = false;
+    }
 
+    if (!IsUTF16(data, length)) {
+        return this->LoadBuffer(data, length, fileMapping);
+    }
+
+    /// Loading a UTF-16 file with conversion to UTF-8
+    /// The BOM gives the byte order and is not converted
     LogWarning("The file seems to be UTF-16 - trying to convert to UTF-8");
 
-    std::ifstream fin(filename.c_str(), std::ios::in | std::ios::binary);
-    if (!fin.is_open()) {
-        return false;
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data) + 2;
+    size_t count = (length - 2) / 2;
+    std::vector<unsigned short> utf16(count);
+    if (memcmp(data, UTF_16_BE_BOM, 2) == 0) {
+        for (size_t i = 0; i < count; i++) {
+            utf16[i] = (unsigned short)((bytes[2 * i] << 8) | bytes[2 * i + 1]);
+        }
+    }
+    else {
+        for (size_t i = 0; i < count; i++) {
+            utf16[i] = (unsigned short)(bytes[2 * i] | (bytes[2 * i + 1] << 8));
+        }
     }
 
-    fin.seekg(0, std::ios::end);
-    std::streamsize wfileSize = (std::streamsize)fin.tellg();
-    fin.clear();
-    fin.seekg(0, std::wios::beg);
+    std::string utf8;
+    utf8.reserve(count);
+    utf8::utf16to8(utf16.begin(), utf16.end(), back_inserter(utf8));
+    std::vector<unsigned short>().swap(utf16);
 
-    std::vector<unsigned short> utf16line;
-    utf16line.reserve(wfileSize / 2 + 1);
+    return this->LoadBuffer(&utf8[0], utf8.size());
+}
 
-    unsigned short buffer;
-    while (fin.read((char *)&buffer, sizeof(unsigned short))) {
-        utf16line.push_back(buffer);
+bool Toolkit::Decompress(const char *data, size_t length, std::string &content)
+{
+    if (Unzip::IsGzip(data, length)) {
+        return Unzip::Gunzip(data, length, content);
     }
-    // LogDebug("%d %d", wfileSize, utf8line.size());
-
-    std::string utf8line;
-    utf8::utf16to8(utf16line.begin(), utf16line.end(), back_inserter(utf8line));
 
-    return LoadString(utf8line);
+    std::string container;
+    if (!Unzip::ReadZipEntry(data, length, "META-INF/container.xml", container)) {
+        LogError("The compressed file has no META-INF/container.xml");
+        return false;
+    }
+    pugi::xml_document xmlDoc;
+    xmlDoc.load_buffer_inplace(&container[0], container.size());
+    std::string path = xmlDoc.child("container").child("rootfiles").child("rootfile").attribute("full-path").value();
+    if (path.empty()) {
+        LogError("The root file of the compressed file cannot be found");
+        return false;
+    }
+    if (!Unzip::ReadZipEntry(data, length, path, content)) {
+        LogError("The root file '%s' cannot be read", path.c_str());
+        return false;
+    }
+    return true;
 }
 
-bool Toolkit::LoadString(const std::string &data)
+FileInputStream *Toolkit::CreateInput()
 {
     FileInputStream *input = NULL;
     if (m_format == PAE) {
@@ -288,15 +376,18 @@ bool Toolkit::LoadString(const std::string &data)
     }
     else {
         LogError("Unknown format");
-        return false;
+        return NULL;
     }
 
     // something went wrong
     if (!input) {
         LogError("Unknown error");
-        return false;
+        return NULL;
     }
 
+    // the document is going to be replaced
+    this->ResetDisplayList();
+
     // ignore layout?
     if (m_ignoreLayout || m_noLayout) {
         input->IgnoreLayoutInformation();
@@ -307,6 +398,41 @@ bool Toolkit::LoadString(const std::string &data)
         input->SetAppXPathQuery(m_appXPathQuery);
     }
 
+    // selective import?
+    if (m_mdiv.length() > 0) {
+        input->SetMdivSelection(m_mdiv);
+    }
+    if (m_measureRange.length() > 0) {
+        input->SetMeasureRange(m_measureRange, m_measureRangeByIndex);
+    }
+    if (m_staves.length() > 0) {
+        input->SetStaffSelection(m_staves);
+    }
+
+    // building the objects with several threads?
+    if (m_importThreads != 1) {
+        input->SetThreadCount(m_importThreads);
+    }
+
+    return input;
+}
+
+bool Toolkit::LoadString(const std::string &data)
+{
+    if (Unzip::IsGzip(data.c_str(), data.size()) || Unzip::IsZip(data.c_str(), data.size())) {
+        std::string content;
+        if (!this->Decompress(data.c_str(), data.size(), content)) {
+            return false;
+        }
+        return this->LoadFileBuffer(&content[0], content.size(), false);
+    }
+
+    m_doc.ResetProgress();
+    FileInputStream *input = this->CreateInput();
+    if (!input) {
+        return false;
+    }
+
     // load the file
     if (!input->ImportString(data)) {
         LogError("Error importing data");
@@ -314,6 +440,96 @@ bool Toolkit::LoadString(const std::string &data)
         return false;
     }
 
+    return this->LoadInput(input, false);
+}
+
+bool Toolkit::LoadBuffer(char *data, size_t length)
+{
+    return this->LoadBuffer(data, length, false);
+}
+
+bool Toolkit::LoadBuffer(char *data, size_t length, bool fileMapping)
+{
+    // An empty file is mapped to no buffer at all
+    if (length == 0) {
+        return this->LoadString("");
+    }
+
+    m_doc.ResetProgress();
+    FileInputStream *input = this->CreateInput();
+    if (!input) {
+        return false;
+    }
+
+    if (fileMapping) {
+        input->SetBufferFileMapping();
+    }
+
+    // load the buffer - it can be parsed in place
+    if (!input->ImportBuffer(data, length)) {
+        LogError("Error importing data");
+        delete input;
+        return false;
+    }
+
+    return this->LoadInput(input, false);
+}
+
+#ifndef USE_EMSCRIPTEN
+void Toolkit::LoadStringAsync(const std::string &data)
+{
+    // Only one load at a time
+    this->WaitLoad();
+
+    // Reset before starting the thread for a cancellation not to be missed
+    m_doc.ResetProgress();
+    m_loadDone = false;
+    m_loadThread = std::thread([this, data]() {
+        m_loadResult = false;
+        FileInputStream *input = this->CreateInput();
+        if (input && !input->ImportString(data)) {
+            LogError("Error importing data");
+            delete input;
+        }
+        else if (input) {
+            m_loadResult = this->LoadInput(input, true);
+        }
+        std::lock_guard<std::mutex> lock(m_loadMutex);
+        m_doc.ClearCancelRequest();
+        m_loadDone = true;
+    });
+}
+
+void Toolkit::CancelLoad()
+{
+    std::lock_guard<std::mutex> lock(m_loadMutex);
+    if (!m_loadDone) {
+        m_doc.RequestCancel();
+    }
+}
+
+bool Toolkit::WaitLoad()
+{
+    if (m_loadThread.joinable()) {
+        m_loadThread.join();
+    }
+    return m_loadResult;
+}
+#endif
+
+bool Toolkit::LoadInput(FileInputStream *input, bool progressive)
+{
+    bool success = this->LayOutInput(input, progressive);
+    delete input;
+    return success;
+}
+
+bool Toolkit::LayOutInput(FileInputStream *input, bool progressive)
+{
+    assert(input);
+
+    this->ResetDisplayList();
+
     m_doc.SetPageHeight(this->GetPageHeight());
     m_doc.SetPageWidth(this->GetPageWidth());
     m_doc.SetPageRightMar(this->GetBorder());
@@ -325,7 +541,9 @@ bool Toolkit::LoadString(const std::string &data)
     m_doc.SetSpacingSystem(this->GetSpacingSystem());
     m_doc.SetEvenSpacing(this->GetEvenNoteSpacing());
 
-    m_doc.PrepareDrawing();
+    if (!m_doc.IsCancelRequested()) {
+        m_doc.PrepareDrawing();
+    }
 
     if (input->HasMeasureWithinEditoMarkup() && !m_noLayout) {
         LogWarning(
@@ -337,18 +555,33 @@ bool Toolkit::LoadString(const std::string &data)
     // DARMS have no layout information. MEI files _can_ have it, but it
     // might have been ignored because of the --ignore-layout option.
     // Regardless, we won't do layout if the --no-layout option was set.
-    if (!input->HasLayoutInformation() && !m_noLayout) {
+    if (!input->HasLayoutInformation() && !m_noLayout && !m_doc.IsCancelRequested()) {
         // LogElapsedTimeStart();
-        m_doc.CastOff();
+        if (progressive && !m_lazyLayout) {
+            // Cast off page by page with a lazy cast off, which produces the same layout
+            m_doc.CastOff(true);
+            while (m_doc.IsCastOffPending() && !m_doc.IsCancelRequested()) {
+                m_doc.CastOffUntilPage(m_doc.GetChildCount() - 1);
+            }
+        }
+        else {
+            m_doc.CastOff(m_lazyLayout);
+        }
         // LogElapsedTimeEnd("layout");
     }
 
+    if (m_doc.IsCancelRequested()) {
+        LogWarning("Loading cancelled");
+        // The document can be partially laid out
+        m_doc.Reset(Raw);
+        return false;
+    }
+
     // disable justification if there's no layout or no justification
     if (m_noLayout || m_noJustification) {
         m_doc.SetJustificationX(false);
     }
 
-    delete input;
     m_view.SetDoc(&m_doc);
 
     return true;
@@ -359,6 +592,8 @@ std::string Toolkit::GetMEI(int pageNo, bool scoreBased)
     // Page number is one-based - correct it to 0-based first
     pageNo--;
 
+    m_doc.CastOffUntilPage(-1);
+
     MeiOutput meioutput(&m_doc, "");
     meioutput.SetScoreBasedMEI(scoreBased);
     return meioutput.GetOutput(pageNo);
@@ -366,6 +601,8 @@ std::string Toolkit::GetMEI(int pageNo, bool scoreBased)
 
 bool Toolkit::SaveFile(const std::string &filename)
 {
+    m_doc.CastOffUntilPage(-1);
+
     MeiOutput meioutput(&m_doc, filename.c_str());
     meioutput.SetScoreBasedMEI(m_scoreBasedMei);
     if (!meioutput.ExportFile()) {
@@ -409,6 +646,14 @@ bool Toolkit::ParseOptions(const std::string &json_options)
 
     if (json.has<jsonxx::String>("appXPathQuery")) SetAppXPathQuery(json.get<jsonxx::String>("appXPathQuery"));
 
+    if (json.has<jsonxx::String>("mdiv")) SetMdiv(json.get<jsonxx::String>("mdiv"));
+
+    if (json.has<jsonxx::String>("measureRange")) SetMeasureRange(json.get<jsonxx::String>("measureRange"));
+
+    if (json.has<jsonxx::String>("staves")) SetStaves(json.get<jsonxx::String>("staves"));
+
+    if (json.has<jsonxx::Number>("importThreads")) SetImportThreads(json.get<jsonxx::Number>("importThreads"));
+
     // Parse the various flags
     // Note: it seems that there is a bug with jsonxx and emscripten
     // Boolean value false won't be parsed properly. We have to use Number instead
@@ -417,8 +662,23 @@ bool Toolkit::ParseOptions(const std::string &json_options)
 
     if (json.has<jsonxx::Number>("ignoreLayout")) SetIgnoreLayout(json.get<jsonxx::Number>("ignoreLayout"));
 
+    if (json.has<jsonxx::Number>("lazyLayout")) SetLazyLayout(json.get<jsonxx::Number>("lazyLayout"));
+
+    if (json.has<jsonxx::Number>("measureRangeByIndex"))
+        SetMeasureRangeByIndex(json.get<jsonxx::Number>("measureRangeByIndex"));
+
     if (json.has<jsonxx::Number>("adjustPageHeight")) SetAdjustPageHeight(json.get<jsonxx::Number>("adjustPageHeight"));
 
+    if (json.has<jsonxx::Number>("svgCompact")) SetSvgCompact(json.get<jsonxx::Number>("svgCompact"));
+
+    if (json.has<jsonxx::Number>("svgRemoveIds")) SetSvgRemoveIds(json.get<jsonxx::Number>("svgRemoveIds"));
+
+    if (json.has<jsonxx::Number>("svgGlyphSprite")) SetSvgGlyphSprite(json.get<jsonxx::Number>("svgGlyphSprite"));
+
+    if (json.has<jsonxx::String>("svgGlyphHref")) SetSvgGlyphHref(json.get<jsonxx::String>("svgGlyphHref"));
+
+    if (json.has<jsonxx::Number>("pngGrayscale")) SetPngGrayscale(json.get<jsonxx::Number>("pngGrayscale"));
+
     if (json.has<jsonxx::Number>("noJustification")) SetNoJustification(json.get<jsonxx::Number>("noJustification"));
 
     if (json.has<jsonxx::Number>("showBoundingBoxes"))
@@ -537,6 +797,8 @@ void Toolkit::ResetLogBuffer()
 
 void Toolkit::RedoLayout()
 {
+    this->ResetDisplayList();
+
     m_doc.SetPageHeight(this->GetPageHeight());
     m_doc.SetPageWidth(this->GetPageWidth());
     m_doc.SetPageRightMar(this->GetBorder());
@@ -546,48 +808,273 @@ void Toolkit::RedoLayout()
     m_doc.SetSpacingSystem(this->GetSpacingSystem());
 
     m_doc.UnCastOff();
-    m_doc.CastOff();
+    m_doc.CastOff(m_lazyLayout);
+}
+
+bool Toolkit::SelectAppReadings(const std::string &xmlIds)
+{
+    bool success = true;
+    std::set<Page *> pages;
+    std::istringstream iss(xmlIds);
+    std::string xmlId;
+    while (iss >> xmlId) {
+        // Look for hidden elements too
+        Object *lemOrRdg = NULL;
+        ArrayPtrVoid params;
+        params.push_back(&xmlId);
+        params.push_back(&lemOrRdg);
+        Functor findByUuid(&Object::FindByUuid);
+        findByUuid.m_visibleOnly = false;
+        m_doc.Process(&findByUuid, &params);
+        App *app = (lemOrRdg) ? dynamic_cast<App *>(lemOrRdg->GetFirstParent(APP, 1)) : NULL;
+        if (!app || !app->SelectLemOrRdg(dynamic_cast<EditorialElement *>(lemOrRdg))) {
+            LogWarning("Element '%s' is not a <lem> or a <rdg>", xmlId.c_str());
+            success = false;
+            continue;
+        }
+        Page *page = dynamic_cast<Page *>(app->GetFirstParent(PAGE));
+        if (page) pages.insert(page);
+    }
+
+    if (pages.empty()) {
+        return success;
+    }
+
+    this->ResetDisplayList();
+
+    // The elements made visible need to be prepared - the other pages keep their layout
+    m_doc.PrepareDrawing();
+    std::set<Page *>::iterator iter;
+    for (iter = pages.begin(); iter != pages.end(); ++iter) {
+        (*iter)->ResetLayout();
+        (*iter)->ModifyLayout();
+    }
+
+    return success;
 }
 
 std::string Toolkit::RenderToSvg(int pageNo, bool xml_declaration)
 {
+    SvgDeviceContext svg(m_pageWidth, m_pageHeight);
+    return this->RenderToSvg(&svg, pageNo, xml_declaration);
+}
+
+std::string Toolkit::RenderToSvg(SvgDeviceContext *svg, int pageNo, bool xml_declaration)
+{
+    assert(svg);
+
+    this->RenderToSvgDeviceContext(svg, pageNo);
+
+    return svg->GetStringSVG(xml_declaration);
+}
+
+void Toolkit::RenderToSvgDeviceContext(SvgDeviceContext *svg, int pageNo)
+{
+    assert(svg);
+
     // Page number is one-based - correct it to 0-based first
     pageNo--;
 
+    int width, height;
+    this->SetDrawingPage(pageNo, width, height);
+
+    // Reset the SVG object, h & w come from the system
+    // We will need to set the size of the page after having drawn it depending on the options
+    svg->Reset(width, height);
+
+    // set scale and border from user options
+    svg->SetUserScale((double)m_scale / 100, (double)m_scale / 100);
+
+    // compact output?
+    svg->SetCompact(m_svgCompact);
+    svg->SetRemoveIds(m_svgRemoveIds);
+    svg->SetGlyphSprite(m_svgGlyphSprite, m_svgGlyphHref);
+
+    // debug BB?
+    svg->SetDrawBoundingBoxes(m_showBoundingBoxes);
+
+    // render the page
+    this->DrawPage(svg, pageNo);
+}
+
+void Toolkit::SetDrawingPage(int pageNo, int &width, int &height)
+{
+    // With lazy layout, make sure the page has been cast off
+    m_doc.CastOffUntilPage(pageNo);
+
     // Get the current system for the SVG clipping size
     m_view.SetPage(pageNo);
 
     // Adjusting page width and height according to the options
-    int width = m_pageWidth;
+    width = m_pageWidth;
     if (m_noLayout) {
         width = m_doc.GetAdjustedDrawingPageWidth();
     }
 
-    int height = m_pageHeight;
+    height = m_pageHeight;
     if (m_adjustPageHeight || m_noLayout) {
         height = m_doc.GetAdjustedDrawingPageHeight();
     }
+}
 
-    // Create the SVG object, h & w come from the system
-    // We will need to set the size of the page after having drawn it depending on the options
-    SvgDeviceContext svg(width, height);
+void Toolkit::RecordPage(int pageNo)
+{
+    // the page is drawn only once and replayed as long as the document does not change
+    if ((pageNo != m_displayListPage) || (m_doc.GetChildCount() != m_displayListPageCount)) {
+        m_displayList.Reset();
+        m_view.DrawCurrentPage(&m_displayList, false);
+        m_displayListPage = pageNo;
+        m_displayListPageCount = m_doc.GetChildCount();
+    }
+}
 
-    // set scale and border from user options
-    svg.SetUserScale((double)m_scale / 100, (double)m_scale / 100);
+void Toolkit::DrawPage(DeviceContext *dc, int pageNo)
+{
+    assert(dc);
 
-    // debug BB?
-    svg.SetDrawBoundingBoxes(m_showBoundingBoxes);
+    this->RecordPage(pageNo);
+    m_displayList.Replay(dc);
+}
 
-    // render the page
-    m_view.DrawCurrentPage(&svg, false);
+const std::vector<char> &Toolkit::RenderToCommands(int pageNo)
+{
+    // Page number is one-based - correct it to 0-based first
+    pageNo--;
+
+    int width, height;
+    this->SetDrawingPage(pageNo, width, height);
+    this->RecordPage(pageNo);
 
-    std::string out_str = svg.GetStringSVG(xml_declaration);
-    return out_str;
+    // the size of the page in front of the commands
+    m_commands.resize(2 * sizeof(int));
+    memcpy(&m_commands[0], &width, sizeof(int));
+    memcpy(&m_commands[sizeof(int)], &height, sizeof(int));
+    m_displayList.Export(m_commands);
+
+    return m_commands;
+}
+
+std::string Toolkit::RenderToPng(int pageNo)
+{
+    RasterDeviceContext raster(m_pageWidth, m_pageHeight);
+    this->RenderToRasterDeviceContext(&raster, pageNo);
+
+    return raster.GetPNG();
+}
+
+bool Toolkit::RenderToPngFile(const std::string &filename, int pageNo)
+{
+    std::string png = this->RenderToPng(pageNo);
+
+    std::ofstream outfile;
+    outfile.open(filename.c_str(), std::ios::out | std::ios::binary);
+
+    if (!outfile.is_open()) {
+        // add message?
+        return false;
+    }
+
+    outfile.write(png.data(), png.size());
+    outfile.close();
+    return true;
+}
+
+std::string Toolkit::RenderToPdf(int pageNo)
+{
+    std::ostringstream output;
+    this->RenderToPdfStream(output, pageNo);
+
+    return output.str();
+}
+
+bool Toolkit::RenderToPdfFile(const std::string &filename, int pageNo)
+{
+    std::ofstream outfile;
+    outfile.open(filename.c_str(), std::ios::out | std::ios::binary);
+
+    if (!outfile.is_open()) {
+        // add message?
+        return false;
+    }
+
+    this->RenderToPdfStream(outfile, pageNo);
+    outfile.close();
+    return true;
+}
+
+void Toolkit::RenderToPdfStream(std::ostream &output, int pageNo)
+{
+    PdfDeviceContext pdf(output);
+
+    int from = (pageNo > 0) ? pageNo : 1;
+    int to = (pageNo > 0) ? pageNo : this->GetPageCount();
+    for (int i = from; i <= to; i++) {
+        int width, height;
+        // Page number is one-based - correct it to 0-based
+        this->SetDrawingPage(i - 1, width, height);
+
+        // each page is written to the output once drawn
+        pdf.Reset(width, height);
+        pdf.SetUserScale((double)m_scale / 100, (double)m_scale / 100);
+        this->DrawPage(&pdf, i - 1);
+    }
+
+    // the glyphs are written once for all the pages
+    pdf.Finish();
+}
+
+void Toolkit::RenderToRasterDeviceContext(RasterDeviceContext *raster, int pageNo)
+{
+    assert(raster);
+
+    // Page number is one-based - correct it to 0-based first
+    pageNo--;
+
+    int width, height;
+    this->SetDrawingPage(pageNo, width, height);
+
+    raster->Reset(width, height);
+    raster->SetGrayscale(m_pngGrayscale);
+
+    // the scale gives the size of the image in pixels
+    raster->SetUserScale((double)m_scale / 100, (double)m_scale / 100);
+
+    this->DrawPage(raster, pageNo);
+}
+
+std::vector<std::string> Toolkit::RenderPaeBatchToSvg(std::istream &input, int maxCount)
+{
+    std::vector<std::string> svgs;
+
+    // One importer and one device context for all the incipits
+    PaeInput paeInput(&m_doc, "");
+    SvgDeviceContext svg(m_pageWidth, m_pageHeight);
+
+    while ((maxCount <= 0) || ((int)svgs.size() < maxCount)) {
+        m_doc.ResetProgress();
+        if (!paeInput.ImportNextRecord(input)) {
+            break;
+        }
+        if (!this->LayOutInput(&paeInput, false)) {
+            svgs.push_back("");
+            continue;
+        }
+        svgs.push_back(this->RenderToSvg(&svg, 1, false));
+    }
+
+    return svgs;
+}
+
+std::vector<std::string> Toolkit::RenderPaeBatchToSvg(const std::string &data)
+{
+    std::istringstream input(data);
+    return this->RenderPaeBatchToSvg(input);
 }
 
 bool Toolkit::RenderToSvgFile(const std::string &filename, int pageNo)
 {
-    std::string output = RenderToSvg(pageNo, true);
+    SvgDeviceContext svg(m_pageWidth, m_pageHeight);
+    this->RenderToSvgDeviceContext(&svg, pageNo);
 
     std::ofstream outfile;
     outfile.open(filename.c_str());
@@ -597,11 +1084,34 @@ bool Toolkit::RenderToSvgFile(const std::string &filename, int pageNo)
         return false;
     }
 
-    outfile << output;
+    // write the SVG without copying it into a string
+    svg.WriteSVG(outfile, true);
     outfile.close();
     return true;
 }
 
+std::string Toolkit::RenderGlyphSprite()
+{
+    // The sprite has no size and only <defs>
+    SvgDeviceContext sprite(0, 0);
+    sprite.SetCompact(m_svgCompact);
+
+    // Collect the glyphs from the display list of each page, so the sprite does not depend on the pages rendered
+    std::vector<std::pair<std::wstring, int> > texts;
+    int width, height;
+    for (int pageNo = 0; pageNo < this->GetPageCount(); pageNo++) {
+        this->SetDrawingPage(pageNo, width, height);
+        this->RecordPage(pageNo);
+        texts.clear();
+        m_displayList.GetMusicTexts(texts);
+        std::vector<std::pair<std::wstring, int> >::iterator it;
+        for (it = texts.begin(); it != texts.end(); ++it) {
+            sprite.AddGlyphs(it->first, it->second);
+        }
+    }
+    return sprite.GetStringSVG(true);
+}
+
 std::string Toolkit::RenderToMidi()
 {
     MidiFile outputfile;
@@ -628,6 +1138,8 @@ std::string Toolkit::GetElementsAtTime(int millisec)
     ArrayOfObjects notes;
     // Here we would need to check that the midi export is done
     if (m_doc.GetMidiExportDone()) {
+        // The page numbers are needed
+        m_doc.CastOffUntilPage(-1);
         m_doc.FindAllChildByAttComparison(&notes, &matchTime);
 
         // Get the pageNo from the first note (if any)
@@ -665,11 +1177,13 @@ bool Toolkit::RenderToMidiFile(const std::string &filename)
 
 int Toolkit::GetPageCount()
 {
+    m_doc.CastOffUntilPage(-1);
     return m_doc.GetPageCount();
 }
 
 int Toolkit::GetPageWithElement(const std::string &xmlId)
 {
+    m_doc.CastOffUntilPage(-1);
     Object *element = m_doc.FindChildByUuid(xmlId);
     if (!element) {
         return 0;
@@ -700,13 +1214,13 @@ void Toolkit::SetCString(const std::string &data)
         m_cString = NULL;
     }
 
-    m_cString = (char *)malloc(strlen(data.c_str()) + 1);
+    m_cString = (char *)malloc(data.size() + 1);
 
     // something went wrong
     if (!m_cString) {
         return;
     }
-    strcpy(m_cString, data.c_str());
+    memcpy(m_cString, data.c_str(), data.size() + 1);
 }
 
 const char *Toolkit::GetCString()
@@ -733,6 +1247,8 @@ bool Toolkit::Drag(std::string elementId, int x, int y)
             = (data_PITCHNAME)m_view.CalculatePitchCode(layer, m_view.ToLogicalY(y), note->GetDrawingX(), &oct);
         note->SetPname(pname);
         note->SetOct(oct);
+        m_doc.GetDrawingPage()->ModifyLayout();
+        this->ResetDisplayList();
         return true;
     }
     return false;
@@ -767,6 +1283,8 @@ bool Toolkit::Insert(std::string elementType, std::string startid, std::string e
         slur->SetEndid(endid);
         measure->AddFloatingElement(slur);
         m_doc.PrepareDrawing();
+        m_doc.GetDrawingPage()->ModifyLayout();
+        this->ResetDisplayList();
         return true;
     }
     return false;
@@ -776,12 +1294,22 @@ bool Toolkit::Set(std::string elementId, std::string attrType, std::string attrV
 {
     if (!m_doc.GetDrawingPage()) return false;
     Object *element = m_doc.GetDrawingPage()->FindChildByUuid(elementId);
-    if (Att::SetCmn(element, attrType, attrValue)) return true;
-    if (Att::SetCritapp(element, attrType, attrValue)) return true;
-    if (Att::SetMensural(element, attrType, attrValue)) return true;
-    if (Att::SetPagebased(element, attrType, attrValue)) return true;
-    if (Att::SetShared(element, attrType, attrValue)) return true;
-    return false;
+    bool success = false;
+    if (Att::SetCmn(element, attrType, attrValue))
+        success = true;
+    else if (Att::SetCritapp(element, attrType, attrValue))
+        success = true;
+    else if (Att::SetMensural(element, attrType, attrValue))
+        success = true;
+    else if (Att::SetPagebased(element, attrType, attrValue))
+        success = true;
+    else if (Att::SetShared(element, attrType, attrValue))
+        success = true;
+    if (success) {
+        m_doc.GetDrawingPage()->ModifyLayout();
+        this->ResetDisplayList();
+    }
+    return success;
 }
 
 #ifdef USE_EMSCRIPTEN
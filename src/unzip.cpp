@@ -0,0 +1,553 @@
+/////////////////////////////////////////////////////////////////////////////
+// Name:        unzip.cpp
+// Author:      agent
+// Created:     19/10/2026
+// Copyright (c) Authors and others. All rights reserved.
+/////////////////////////////////////////////////////////////////////////////
+
+#include "unzip.h"
+
+//----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <string.h>
+
+//----------------------------------------------------------------------------
+
+#include "vrv.h"
+
+namespace vrv {
+
+namespace {
+
+    /** The number of bits looked up at once when decoding a Huffman code */
+    const int FAST_BITS = 9;
+
+    /** The maximum compression ratio of deflate, for not trusting sizes from the headers blindly */
+    const size_t MAX_RATIO = 1032;
+
+    /** Base values and extra bits of the length and distance codes */
+    const unsigned short LENGTH_BASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59,
+        67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    const unsigned char LENGTH_EXTRA[29]
+        = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    const unsigned short DIST_BASE[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513,
+        769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+    const unsigned char DIST_EXTRA[30]
+        = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+    /** The order in which the lengths of the code length code are given */
+    const unsigned char CODE_LENGTH_ORDER[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+    unsigned int ReadUInt16(const unsigned char *p) { return p[0] | (p[1] << 8); }
+
+    unsigned int ReadUInt32(const unsigned char *p)
+    {
+        return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+    }
+
+    //----------------------------------------------------------------------------
+    // Huffman
+    //----------------------------------------------------------------------------
+
+    /**
+     * A canonical Huffman code.
+     * The codes of up to FAST_BITS are decoded with a lookup table, the longer ones bit by bit.
+     */
+    struct Huffman {
+        bool Build(const unsigned char *lengths, int n);
+
+        /** The number of codes of each length */
+        short count[16];
+        /** The symbols ordered by code */
+        short symbol[288];
+        /** The symbol | (length << 12) indexed by the next FAST_BITS bits - 0 for longer codes */
+        unsigned short fast[1 << FAST_BITS];
+    };
+
+    bool Huffman::Build(const unsigned char *lengths, int n)
+    {
+        memset(count, 0, sizeof(count));
+        memset(fast, 0, sizeof(fast));
+        int i, len;
+        for (i = 0; i < n; i++) count[lengths[i]]++;
+        count[0] = 0;
+
+        // an over-subscribed code is not valid (an incomplete one is)
+        int left = 1;
+        for (len = 1; len < 16; len++) {
+            left = (left << 1) - count[len];
+            if (left < 0) return false;
+        }
+
+        short offset[16];
+        int next[16];
+        offset[1] = 0;
+        next[1] = 0;
+        for (len = 1; len < 15; len++) {
+            offset[len + 1] = offset[len] + count[len];
+            next[len + 1] = (next[len] + count[len]) << 1;
+        }
+
+        for (i = 0; i < n; i++) {
+            len = lengths[i];
+            if (len == 0) continue;
+            symbol[offset[len]++] = i;
+            int code = next[len]++;
+            if (len > FAST_BITS) continue;
+            // the codes are packed starting with their most significant bit
+            int reversed = 0;
+            for (int b = 0; b < len; b++) {
+                reversed = (reversed << 1) | (code & 1);
+                code >>= 1;
+            }
+            for (int j = reversed; j < (1 << FAST_BITS); j += (1 << len)) {
+                fast[j] = i | (len << 12);
+            }
+        }
+        return true;
+    }
+
+    //----------------------------------------------------------------------------
+    // Inflater
+    //----------------------------------------------------------------------------
+
+    /**
+     * The state of the decompression of raw deflate data (RFC 1951).
+     * The output is written directly into the string, which is grown as needed and resized at the end.
+     */
+    class Inflater {
+    public:
+        Inflater(const unsigned char *data, size_t length, std::string &output);
+
+        bool Inflate();
+
+        /** The number of bytes read, not counting the bits still buffered */
+        size_t GetConsumed() const { return m_pos - m_bitCount / 8; }
+
+    private:
+        void Refill();
+        unsigned int GetBits(int n);
+        int Decode(const Huffman &huffman);
+        void Grow(size_t n);
+
+        bool InflateStored();
+        bool InflateFixed();
+        bool InflateDynamic();
+        bool InflateCodes();
+
+        const unsigned char *m_data;
+        size_t m_length;
+        size_t m_pos;
+        unsigned long long m_bitBuffer;
+        int m_bitCount;
+        bool m_error;
+
+        std::string &m_output;
+        size_t m_outputStart;
+        size_t m_outputPos;
+
+        Huffman m_literals;
+        Huffman m_distances;
+    };
+
+    Inflater::Inflater(const unsigned char *data, size_t length, std::string &output) : m_output(output)
+    {
+        m_data = data;
+        m_length = length;
+        m_pos = 0;
+        m_bitBuffer = 0;
+        m_bitCount = 0;
+        m_error = false;
+        m_outputStart = output.size();
+        m_outputPos = m_outputStart;
+    }
+
+    void Inflater::Refill()
+    {
+        while ((m_bitCount <= 56) && (m_pos < m_length)) {
+            m_bitBuffer |= (unsigned long long)m_data[m_pos++] << m_bitCount;
+            m_bitCount += 8;
+        }
+    }
+
+    unsigned int Inflater::GetBits(int n)
+    {
+        if (m_bitCount < n) {
+            Refill();
+            if (m_bitCount < n) {
+                m_error = true;
+                return 0;
+            }
+        }
+        unsigned int value = (unsigned int)(m_bitBuffer & ((1ULL << n) - 1));
+        m_bitBuffer >>= n;
+        m_bitCount -= n;
+        return value;
+    }
+
+    int Inflater::Decode(const Huffman &huffman)
+    {
+        if (m_bitCount < FAST_BITS) Refill();
+        unsigned short entry = huffman.fast[m_bitBuffer & ((1 << FAST_BITS) - 1)];
+        if (entry && ((entry >> 12) <= m_bitCount)) {
+            m_bitBuffer >>= (entry >> 12);
+            m_bitCount -= (entry >> 12);
+            return entry & 0xFFF;
+        }
+
+        // a longer code, decoded bit by bit
+        int code = 0;
+        int first = 0;
+        int index = 0;
+        for (int len = 1; len < 16; len++) {
+            code |= GetBits(1);
+            if (m_error) return -1;
+            int count = huffman.count[len];
+            if (code - count < first) return huffman.symbol[index + (code - first)];
+            index += count;
+            first = (first + count) << 1;
+            code <<= 1;
+        }
+        m_error = true;
+        return -1;
+    }
+
+    void Inflater::Grow(size_t n)
+    {
+        if (m_outputPos + n <= m_output.size()) return;
+        // the reserved capacity is the expected size of the output
+        size_t size = std::max(m_outputPos + n, m_output.size() * 2);
+        size = std::max(size, m_output.capacity());
+        m_output.resize(size);
+    }
+
+    bool Inflater::Inflate()
+    {
+        unsigned int last;
+        do {
+            last = GetBits(1);
+            unsigned int type = GetBits(2);
+            if (m_error) return false;
+            bool success = false;
+            if (type == 0) {
+                success = InflateStored();
+            }
+            else if (type == 1) {
+                success = InflateFixed();
+            }
+            else if (type == 2) {
+                success = InflateDynamic();
+            }
+            if (!success) return false;
+        } while (!last);
+        m_output.resize(m_outputPos);
+        return true;
+    }
+
+    bool Inflater::InflateStored()
+    {
+        // the block starts on a byte boundary
+        GetBits(m_bitCount % 8);
+        unsigned int len = GetBits(16);
+        unsigned int nlen = GetBits(16);
+        if (m_error || (len != (~nlen & 0xFFFF))) return false;
+
+        Grow(len);
+        // first the bytes already in the bit buffer
+        while ((len > 0) && (m_bitCount >= 8)) {
+            m_output[m_outputPos++] = (char)GetBits(8);
+            len--;
+        }
+        if (len > m_length - m_pos) return false;
+        memcpy(&m_output[m_outputPos], m_data + m_pos, len);
+        m_outputPos += len;
+        m_pos += len;
+        return true;
+    }
+
+    bool Inflater::InflateFixed()
+    {
+        unsigned char lengths[288 + 30];
+        int i = 0;
+        for (; i < 144; i++) lengths[i] = 8;
+        for (; i < 256; i++) lengths[i] = 9;
+        for (; i < 280; i++) lengths[i] = 7;
+        for (; i < 288; i++) lengths[i] = 8;
+        for (; i < 288 + 30; i++) lengths[i] = 5;
+        m_literals.Build(lengths, 288);
+        m_distances.Build(lengths + 288, 30);
+        return InflateCodes();
+    }
+
+    bool Inflater::InflateDynamic()
+    {
+        int nlen = GetBits(5) + 257;
+        int ndist = GetBits(5) + 1;
+        int ncode = GetBits(4) + 4;
+        if (m_error || (nlen > 286) || (ndist > 30)) return false;
+
+        unsigned char lengths[286 + 30];
+        memset(lengths, 0, sizeof(lengths));
+        int index;
+        for (index = 0; index < ncode; index++) {
+            lengths[CODE_LENGTH_ORDER[index]] = GetBits(3);
+        }
+        // the code length code is used for reading the lengths of the literal and distance codes
+        Huffman lengthCode;
+        if (m_error || !lengthCode.Build(lengths, 19)) return false;
+
+        memset(lengths, 0, sizeof(lengths));
+        index = 0;
+        while (index < nlen + ndist) {
+            int symbol = Decode(lengthCode);
+            if (symbol < 0) return false;
+            if (symbol < 16) {
+                lengths[index++] = symbol;
+                continue;
+            }
+            unsigned char len = 0;
+            int repeat;
+            if (symbol == 16) {
+                if (index == 0) return false;
+                len = lengths[index - 1];
+                repeat = 3 + GetBits(2);
+            }
+            else if (symbol == 17) {
+                repeat = 3 + GetBits(3);
+            }
+            else {
+                repeat = 11 + GetBits(7);
+            }
+            if (m_error || (index + repeat > nlen + ndist)) return false;
+            while (repeat--) lengths[index++] = len;
+        }
+
+        // the end-of-block code is required
+        if (lengths[256] == 0) return false;
+        if (!m_literals.Build(lengths, nlen) || !m_distances.Build(lengths + nlen, ndist)) return false;
+        return InflateCodes();
+    }
+
+    bool Inflater::InflateCodes()
+    {
+        for (;;) {
+            int symbol = Decode(m_literals);
+            if (symbol < 0) return false;
+            if (symbol < 256) {
+                Grow(1);
+                m_output[m_outputPos++] = (char)symbol;
+                continue;
+            }
+            if (symbol == 256) return true;
+
+            symbol -= 257;
+            if (symbol >= 29) return false;
+            size_t len = LENGTH_BASE[symbol] + GetBits(LENGTH_EXTRA[symbol]);
+            symbol = Decode(m_distances);
+            if ((symbol < 0) || (symbol >= 30)) return false;
+            size_t dist = DIST_BASE[symbol] + GetBits(DIST_EXTRA[symbol]);
+            if (m_error || (dist > m_outputPos - m_outputStart)) return false;
+
+            Grow(len);
+            char *output = &m_output[0];
+            size_t from = m_outputPos - dist;
+            if (dist >= len) {
+                memcpy(output + m_outputPos, output + from, len);
+            }
+            // the copy overlaps the bytes being written
+            else {
+                for (size_t i = 0; i < len; i++) output[m_outputPos + i] = output[from + i];
+            }
+            m_outputPos += len;
+        }
+    }
+
+    //----------------------------------------------------------------------------
+    // Crc32Table
+    //----------------------------------------------------------------------------
+
+    struct Crc32Table {
+        Crc32Table()
+        {
+            for (unsigned int i = 0; i < 256; i++) {
+                unsigned int crc = i;
+                for (int k = 0; k < 8; k++) crc = (crc & 1) ? (0xEDB88320 ^ (crc >> 1)) : (crc >> 1);
+                values[i] = crc;
+            }
+        }
+        unsigned int values[256];
+    };
+
+} // namespace
+
+//----------------------------------------------------------------------------
+// Unzip
+//----------------------------------------------------------------------------
+
+bool Unzip::IsGzip(const char *data, size_t length)
+{
+    return ((length >= 2) && (memcmp(data, "\x1F\x8B", 2) == 0));
+}
+
+bool Unzip::IsZip(const char *data, size_t length)
+{
+    return ((length >= 4) && (memcmp(data, "PK\x03\x04", 4) == 0));
+}
+
+bool Unzip::Gunzip(const char *data, size_t length, std::string &output)
+{
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+    output.clear();
+    // the uncompressed size (modulo 2^32) of the last member is given at the end
+    if (length >= 18) {
+        size_t size = ReadUInt32(bytes + length - 4);
+        if (size / MAX_RATIO <= length) output.reserve(size);
+    }
+
+    size_t pos = 0;
+    do {
+        const unsigned char *header = bytes + pos;
+        if ((length - pos < 18) || (header[2] != 8)) {
+            LogError("Invalid or unsupported gzip header");
+            return false;
+        }
+        int flags = header[3];
+        size_t start = pos + 10;
+        // extra field, file name, comment, and header CRC
+        if ((flags & 4) && (start + 2 <= length)) {
+            start += 2 + ReadUInt16(bytes + start);
+        }
+        if (flags & 8) {
+            while ((start < length) && bytes[start]) start++;
+            start++;
+        }
+        if (flags & 16) {
+            while ((start < length) && bytes[start]) start++;
+            start++;
+        }
+        if (flags & 2) {
+            start += 2;
+        }
+        if (start >= length) {
+            LogError("The gzip data is truncated");
+            return false;
+        }
+
+        size_t outputStart = output.size();
+        size_t consumed = 0;
+        if (!Inflate(bytes + start, length - start, output, consumed)) {
+            LogError("The gzip data could not be decompressed");
+            return false;
+        }
+        pos = start + consumed;
+        if (length - pos < 8) {
+            LogError("The gzip data is truncated");
+            return false;
+        }
+        size_t size = output.size() - outputStart;
+        if ((Crc32(output.data() + outputStart, size) != ReadUInt32(bytes + pos))
+            || ((unsigned int)size != ReadUInt32(bytes + pos + 4))) {
+            LogError("The gzip data is corrupted");
+            return false;
+        }
+        pos += 8;
+        // anything else than another member at the end is ignored
+    } while (IsGzip(data + pos, length - pos));
+
+    return true;
+}
+
+bool Unzip::ReadZipEntry(const char *data, size_t length, const std::string &name, std::string &output)
+{
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+    output.clear();
+    if (length < 22) return false;
+
+    // look for the end of central directory record backwards since it can be followed by a comment
+    size_t end = length - 22;
+    size_t limit = (end > 0xFFFF) ? end - 0xFFFF : 0;
+    while (ReadUInt32(bytes + end) != 0x06054B50) {
+        if (end == limit) {
+            LogError("The zip central directory cannot be found");
+            return false;
+        }
+        end--;
+    }
+
+    size_t entries = ReadUInt16(bytes + end + 10);
+    size_t pos = ReadUInt32(bytes + end + 16);
+    for (size_t i = 0; i < entries; i++) {
+        if ((pos + 46 > length) || (ReadUInt32(bytes + pos) != 0x02014B50)) {
+            LogError("The zip central directory is not valid");
+            return false;
+        }
+        const unsigned char *entry = bytes + pos;
+        size_t nameLength = ReadUInt16(entry + 28);
+        pos += 46 + nameLength + ReadUInt16(entry + 30) + ReadUInt16(entry + 32);
+        if (pos > length) {
+            LogError("The zip central directory is not valid");
+            return false;
+        }
+        if ((nameLength != name.size()) || (memcmp(entry + 46, name.data(), nameLength) != 0)) continue;
+
+        int method = ReadUInt16(entry + 10);
+        unsigned int crc = ReadUInt32(entry + 16);
+        size_t compressedSize = ReadUInt32(entry + 20);
+        size_t size = ReadUInt32(entry + 24);
+        size_t local = ReadUInt32(entry + 42);
+        if ((local + 30 > length) || (ReadUInt32(bytes + local) != 0x04034B50)) {
+            LogError("The zip entry '%s' is not valid", name.c_str());
+            return false;
+        }
+        size_t start = local + 30 + ReadUInt16(bytes + local + 26) + ReadUInt16(bytes + local + 28);
+        if ((start > length) || (compressedSize > length - start)) {
+            LogError("The zip entry '%s' is truncated", name.c_str());
+            return false;
+        }
+
+        if (method == 0) {
+            output.assign(data + start, compressedSize);
+        }
+        else if (method == 8) {
+            if (size / MAX_RATIO <= compressedSize) output.reserve(size);
+            size_t consumed = 0;
+            if (!Inflate(bytes + start, compressedSize, output, consumed)) {
+                LogError("The zip entry '%s' could not be decompressed", name.c_str());
+                return false;
+            }
+        }
+        else {
+            LogError("Unsupported compression method %d for the zip entry '%s'", method, name.c_str());
+            return false;
+        }
+        if ((output.size() != size) || (Crc32(output.data(), output.size()) != crc)) {
+            LogError("The zip entry '%s' is corrupted", name.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+bool Unzip::Inflate(const unsigned char *data, size_t length, std::string &output, size_t &consumed)
+{
+    Inflater inflater(data, length, output);
+    bool success = inflater.Inflate();
+    consumed = inflater.GetConsumed();
+    return success;
+}
+
+unsigned int Unzip::Crc32(const char *data, size_t length)
+{
+    static const Crc32Table table;
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+    unsigned int crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < length; i++) {
+        crc = table.values[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFF;
+}
+
+} // namespace vrv
@@ -13,6 +13,10 @@
 #include <math.h>
 #include <sstream>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 //----------------------------------------------------------------------------
 
 #include "doc.h"
@@ -20,8 +24,6 @@
 
 namespace vrv {
 
-int View::s_deCasteljau[4][4];
-
 //----------------------------------------------------------------------------
 // View
 //----------------------------------------------------------------------------
@@ -202,20 +204,63 @@ Point View::CalcPositionAfterRotation(Point point, float rot_alpha, Point center
 
 int View::CalcBezierAtPosition(Point bezier[], int x)
 {
-    int i, j;
-    double t = 0.0;
-    // avoid division by 0
-    if (bezier[3].x != bezier[0].x) t = (double)(x - bezier[0].x) / (double)(bezier[3].x - bezier[0].x);
-    t = std::min(1.0, std::max(0.0, t));
-    int n = 4;
-
-    for (i = 0; i < n; i++) View::s_deCasteljau[0][i] = bezier[i].y;
-    for (j = 1; j < n; j++) {
-        for (int i = 0; i < 4 - j; i++) {
-            View::s_deCasteljau[j][i] = View::s_deCasteljau[j - 1][i] * (1 - t) + View::s_deCasteljau[j - 1][i + 1] * t;
-        }
+    int y;
+    View::CalcBezierAtPositions(bezier, &x, &y, 1);
+    return y;
+}
+
+void View::CalcBezierAtPositions(Point bezier[], const int *xs, int *ys, int count)
+{
+    // The De Casteljau values are truncated to int at each level (as with an int buffer)
+    double b0 = bezier[0].y;
+    double b1 = bezier[1].y;
+    double b2 = bezier[2].y;
+    double b3 = bezier[3].y;
+    double x0 = bezier[0].x;
+    // avoid division by 0 - t will remain 0.0 for all positions
+    double dist = bezier[3].x - bezier[0].x;
+
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d one = _mm_set1_pd(1.0);
+    const __m128d vx0 = _mm_set1_pd(x0);
+    const __m128d vDist = _mm_set1_pd((dist != 0.0) ? dist : 1.0);
+    const __m128d vMask = (dist != 0.0) ? _mm_castsi128_pd(_mm_set1_epi32(-1)) : zero;
+    const __m128d v0 = _mm_set1_pd(b0);
+    const __m128d v1 = _mm_set1_pd(b1);
+    const __m128d v2 = _mm_set1_pd(b2);
+    const __m128d v3 = _mm_set1_pd(b3);
+    for (; i + 2 <= count; i += 2) {
+        __m128d t = _mm_cvtepi32_pd(_mm_loadl_epi64((const __m128i *)(xs + i)));
+        t = _mm_and_pd(_mm_div_pd(_mm_sub_pd(t, vx0), vDist), vMask);
+        t = _mm_min_pd(one, _mm_max_pd(zero, t));
+        __m128d u = _mm_sub_pd(one, t);
+        // first level
+        __m128d q0 = _mm_cvtepi32_pd(_mm_cvttpd_epi32(_mm_add_pd(_mm_mul_pd(v0, u), _mm_mul_pd(v1, t))));
+        __m128d q1 = _mm_cvtepi32_pd(_mm_cvttpd_epi32(_mm_add_pd(_mm_mul_pd(v1, u), _mm_mul_pd(v2, t))));
+        __m128d q2 = _mm_cvtepi32_pd(_mm_cvttpd_epi32(_mm_add_pd(_mm_mul_pd(v2, u), _mm_mul_pd(v3, t))));
+        // second level
+        __m128d r0 = _mm_cvtepi32_pd(_mm_cvttpd_epi32(_mm_add_pd(_mm_mul_pd(q0, u), _mm_mul_pd(q1, t))));
+        __m128d r1 = _mm_cvtepi32_pd(_mm_cvttpd_epi32(_mm_add_pd(_mm_mul_pd(q1, u), _mm_mul_pd(q2, t))));
+        // third level
+        __m128i y = _mm_cvttpd_epi32(_mm_add_pd(_mm_mul_pd(r0, u), _mm_mul_pd(r1, t)));
+        _mm_storel_epi64((__m128i *)(ys + i), y);
+    }
+#endif
+    // portable implementation (also used for the remaining position with SSE2)
+    for (; i < count; i++) {
+        double t = 0.0;
+        if (dist != 0.0) t = ((double)xs[i] - x0) / dist;
+        t = std::min(1.0, std::max(0.0, t));
+        double u = 1.0 - t;
+        int q0 = b0 * u + b1 * t;
+        int q1 = b1 * u + b2 * t;
+        int q2 = b2 * u + b3 * t;
+        int r0 = q0 * u + q1 * t;
+        int r1 = q1 * u + q2 * t;
+        ys[i] = r0 * u + r1 * t;
     }
-    return View::s_deCasteljau[n - 1][0];
 }
 
 } // namespace vrv
@@ -22,6 +22,7 @@
 #include "layer.h"
 #include "layerelement.h"
 #include "note.h"
+#include "page.h"
 #include "rpt.h"
 #include "smufl.h"
 #include "staff.h"
@@ -80,95 +81,103 @@ void View::DrawBeam(DeviceContext *dc, LayerElement *element, Layer *layer, Staf
     }
     const ArrayOfBeamElementCoords *beamElementCoords = beam->GetElementCoords();
 
-    // current point to the first Note in the layed out layer
-    current = dynamic_cast<LayerElement *>(beamChildren->front());
-    // Beam list should contain only DurationInterface objects
-    assert(current->GetDurationInterface());
-
-    lastDur = (current->GetDurationInterface())->GetActualDur();
+    // Re-use the values calculated for the same layout revision (e.g., when the page is rendered again)
+    // Otherwise populate the coordinates and calculate them
+    if (beam->GetCachedDrawingParams(m_currentPage->GetLayoutRevision(), &params, &elementCount)) {
+        last = elementCount - 1;
+    }
+    else {
+        // current point to the first Note in the layed out layer
+        current = dynamic_cast<LayerElement *>(beamChildren->front());
+        // Beam list should contain only DurationInterface objects
+        assert(current->GetDurationInterface());
 
-    /******************************************************************/
-    // Populate BeamElementCoord for each element in the beam
-    // This could be moved to Beam::InitCoord for optimization because there should be no
-    // need for redoing it everytime it is drawn.
+        lastDur = (current->GetDurationInterface())->GetActualDur();
 
-    data_STEMDIRECTION currentStemDir;
+        /******************************************************************/
+        // Populate BeamElementCoord for each element in the beam
+        // This could be moved to Beam::InitCoord for optimization because there should be no
+        // need for redoing it everytime it is drawn.
 
-    ListOfObjects::iterator iter = beamChildren->begin();
-    do {
-        // Beam list should contain only DurationInterface objects
-        assert(current->GetDurationInterface());
-        currentDur = (current->GetDurationInterface())->GetActualDur();
+        data_STEMDIRECTION currentStemDir;
 
-        if (current->Is() == CHORD) {
-            params.m_beamHasChord = true;
-        }
+        ListOfObjects::iterator iter = beamChildren->begin();
+        do {
+            // Beam list should contain only DurationInterface objects
+            assert(current->GetDurationInterface());
+            currentDur = (current->GetDurationInterface())->GetActualDur();
 
-        // Can it happen? With rests?
-        if (currentDur > DUR_4) {
-            (*beamElementCoords).at(elementCount)->m_element = current;
-            current->m_beamElementCoord = (*beamElementCoords).at(elementCount);
-            (*beamElementCoords).at(elementCount)->m_x = current->GetDrawingX();
-            (*beamElementCoords).at(elementCount)->m_dur = currentDur;
-
-            // Look at beam breaks
-            (*beamElementCoords).at(elementCount)->m_breaksec = 0;
-            AttBeamsecondary *beamsecondary = dynamic_cast<AttBeamsecondary *>(current);
-            if (beamsecondary && beamsecondary->HasBreaksec()) {
-                if (!params.m_changingDur) params.m_changingDur = ON;
-                (*beamElementCoords).at(elementCount)->m_breaksec = beamsecondary->GetBreaksec();
+            if (current->Is() == CHORD) {
+                params.m_beamHasChord = true;
             }
 
-            // Skip rests
-            if ((current->Is() == NOTE) || (current->Is() == CHORD)) {
-                // look at the stemDir to see if we have multiple stem Dir
-                if (!params.m_hasMultipleStemDir) {
-                    assert(dynamic_cast<AttStems *>(current));
-                    currentStemDir = (dynamic_cast<AttStems *>(current))->GetStemDir();
-                    if (currentStemDir != STEMDIRECTION_NONE) {
-                        if ((params.m_stemDir != STEMDIRECTION_NONE) && (params.m_stemDir != currentStemDir)) {
-                            params.m_hasMultipleStemDir = ON;
+            // Can it happen? With rests?
+            if (currentDur > DUR_4) {
+                (*beamElementCoords).at(elementCount)->m_element = current;
+                current->m_beamElementCoord = (*beamElementCoords).at(elementCount);
+                (*beamElementCoords).at(elementCount)->m_x = current->GetDrawingX();
+                (*beamElementCoords).at(elementCount)->m_dur = currentDur;
+
+                // Look at beam breaks
+                (*beamElementCoords).at(elementCount)->m_breaksec = 0;
+                AttBeamsecondary *beamsecondary = dynamic_cast<AttBeamsecondary *>(current);
+                if (beamsecondary && beamsecondary->HasBreaksec()) {
+                    if (!params.m_changingDur) params.m_changingDur = ON;
+                    (*beamElementCoords).at(elementCount)->m_breaksec = beamsecondary->GetBreaksec();
+                }
+
+                // Skip rests
+                if ((current->Is() == NOTE) || (current->Is() == CHORD)) {
+                    // look at the stemDir to see if we have multiple stem Dir
+                    if (!params.m_hasMultipleStemDir) {
+                        assert(dynamic_cast<AttStems *>(current));
+                        currentStemDir = (dynamic_cast<AttStems *>(current))->GetStemDir();
+                        if (currentStemDir != STEMDIRECTION_NONE) {
+                            if ((params.m_stemDir != STEMDIRECTION_NONE) && (params.m_stemDir != currentStemDir)) {
+                                params.m_hasMultipleStemDir = ON;
+                            }
                         }
+                        params.m_stemDir = currentStemDir;
                     }
-                    params.m_stemDir = currentStemDir;
                 }
-            }
-            // keep the shortest dur in the beam
-            params.m_shortestDur = std::max(currentDur, params.m_shortestDur);
-            // check if we have more than duration in the beam
-            if (!params.m_changingDur && currentDur != lastDur) params.m_changingDur = ON;
-            lastDur = currentDur;
+                // keep the shortest dur in the beam
+                params.m_shortestDur = std::max(currentDur, params.m_shortestDur);
+                // check if we have more than duration in the beam
+                if (!params.m_changingDur && currentDur != lastDur) params.m_changingDur = ON;
+                lastDur = currentDur;
             
-            elementCount++;
-        }
+                elementCount++;
+            }
 
-        iter++;
-        if (iter == beamChildren->end()) {
-            break;
-        }
-        current = dynamic_cast<LayerElement *>(*iter);
-        if (current == NULL) {
-            LogDebug("Error accessing element in Beam list");
-            return;
-        }
+            iter++;
+            if (iter == beamChildren->end()) {
+                break;
+            }
+            current = dynamic_cast<LayerElement *>(*iter);
+            if (current == NULL) {
+                LogDebug("Error accessing element in Beam list");
+                return;
+            }
 
-    } while (1);
+        } while (1);
 
-    // elementCount must be greater than 0 here
-    if (elementCount == 0) {
-        LogDebug("Beam with no notes of duration > 8 detected. Exiting DrawBeam.");
-        return;
-    }
+        // elementCount must be greater than 0 here
+        if (elementCount == 0) {
+            LogDebug("Beam with no notes of duration > 8 detected. Exiting DrawBeam.");
+            return;
+        }
 
-    last = elementCount - 1;
+        last = elementCount - 1;
 
-    // We look only at the last note for checking if cue-sized. Somehow arbitrarily
-    params.m_cueSize = (*beamElementCoords).at(last)->m_element->IsCueSize();
+        // We look only at the last note for checking if cue-sized. Somehow arbitrarily
+        params.m_cueSize = (*beamElementCoords).at(last)->m_element->IsCueSize();
 
-    /******************************************************************/
-    // Calculate the beam slope and position
+        /******************************************************************/
+        // Calculate the beam slope and position
 
-    CalcBeam(layer, staff, beamElementCoords, elementCount, &params);
+        CalcBeam(layer, staff, beamElementCoords, elementCount, &params);
+        beam->SetCachedDrawingParams(m_currentPage->GetLayoutRevision(), &params, elementCount);
+    }
 
     /******************************************************************/
     // Start the Beam graphic and draw the children
@@ -27,6 +27,7 @@
 #include "layerelement.h"
 #include "measure.h"
 #include "note.h"
+#include "page.h"
 #include "slur.h"
 #include "smufl.h"
 #include "staff.h"
@@ -51,6 +52,14 @@ void View::DrawFloatingElement(DeviceContext *dc, FloatingElement *element, Meas
     assert(measure);
     assert(element);
 
+    // Floating elements do not change the horizontal layout and their bounding boxes are only used for the vertical
+    // one, which is always calculated (and reset) afterwards - nothing to do in an horizontal only bounding box pass
+    if (dc->Is() == BBOX_DEVICE_CONTEXT) {
+        BBoxDeviceContext *bBoxDC = dynamic_cast<BBoxDeviceContext *>(dc);
+        assert(bBoxDC);
+        if (!bBoxDC->UpdateVerticalValues()) return;
+    }
+
     // For dir and dynam, we do not consider the @tstamp2 for rendering
     if (element->HasInterface(INTERFACE_TIME_SPANNING) && (element->Is() != DIR) && (element->Is() != DYNAM)) {
         // create placeholder
@@ -625,12 +634,20 @@ void View::DrawSlur(DeviceContext *dc, Slur *slur, int x1, int x2, Staff *staff,
     points[0] = Point(x1, y1);
     points[1] = Point(x2, y2);
 
-    float angle = AdjustSlur(slur, staff, layer1->GetN(), drawingCurveDir, points);
+    FloatingPositioner *positioner = slur->GetCurrentFloatingPositioner();
+    assert(positioner);
+
+    // Adjusting the slur is expensive - re-use the curve if it was already calculated for the same layout
+    float angle;
+    if (!positioner->GetCachedSlurCurve(m_currentPage->GetLayoutRevision(), drawingCurveDir, points, &angle)) {
+        Point ends[2] = { points[0], points[1] };
+        angle = AdjustSlur(slur, staff, layer1->GetN(), drawingCurveDir, points);
+        positioner->SetCachedSlurCurve(m_currentPage->GetLayoutRevision(), drawingCurveDir, ends, points, angle);
+    }
 
     int thickness = m_doc->GetDrawingUnit(staff->m_drawingStaffSize) * m_doc->GetSlurThickness() / DEFINITON_FACTOR;
 
-    assert(slur->GetCurrentFloatingPositioner());
-    slur->GetCurrentFloatingPositioner()->UpdateSlurPosition(points, angle, thickness, drawingCurveDir);
+    positioner->UpdateSlurPosition(points, angle, thickness, drawingCurveDir);
 
     if (graphic)
         dc->ResumeGraphic(graphic, graphic->GetUuid());
@@ -843,7 +860,7 @@ int View::AdjustSlurCurve(Slur *slur, ArrayOfLayerElementPointPairs *spanningPoi
     int maxHeight = 0;
 
     // 0.2 for avoiding / by 0 (below)
-    float maxHeightFactor = std::max(0.2, fabs(angle));
+    float maxHeightFactor = std::max(0.2f, fabs(angle));
     maxHeight = dist / (maxHeightFactor * (TEMP_STYLE_SLUR_CURVE_FACTOR
                                               + 5)); // 5 is the minimum - can be increased for limiting curvature
     if (posRatio) {
@@ -857,8 +874,11 @@ int View::AdjustSlurCurve(Slur *slur, ArrayOfLayerElementPointPairs *spanningPoi
         float maxRatio = 1.0;
         float posXRatio = 1.0;
         int posX;
-        for (itPoint = spanningPoints->begin(); itPoint != spanningPoints->end();) {
-            y = View::CalcBezierAtPosition(bezier, itPoint->second.x);
+        std::vector<int> curveYs;
+        View::CalcSpanningPointsOnCurve(bezier, spanningPoints, &curveYs);
+        std::vector<int>::iterator itCurveY = curveYs.begin();
+        for (itPoint = spanningPoints->begin(); itPoint != spanningPoints->end(); itCurveY++) {
+            y = (*itCurveY);
 
             // Weight the desired height according to the x position if wanted
             posXRatio = 1.0;
@@ -939,6 +959,21 @@ int View::AdjustSlurCurve(Slur *slur, ArrayOfLayerElementPointPairs *spanningPoi
         return 0;
 }
 
+void View::CalcSpanningPointsOnCurve(
+    Point bezier[], ArrayOfLayerElementPointPairs *spanningPoints, std::vector<int> *curveYs)
+{
+    // Copy the x positions in a flat array for calculating the curve position of all points in one batch
+    std::vector<int> xs;
+    xs.reserve(spanningPoints->size());
+    ArrayOfLayerElementPointPairs::iterator itPoint;
+    for (itPoint = spanningPoints->begin(); itPoint != spanningPoints->end(); itPoint++) {
+        xs.push_back(itPoint->second.x);
+    }
+    curveYs->resize(xs.size());
+    if (xs.empty()) return;
+    View::CalcBezierAtPositions(bezier, &xs[0], &curveYs->at(0), (int)xs.size());
+}
+
 void View::AdjustSlurPosition(Slur *slur, ArrayOfLayerElementPointPairs *spanningPoints, Point *p1, Point *p2,
     Point *c1, Point *c2, curvature_CURVEDIR curveDir, float *angle, bool forceBothSides)
 {
@@ -959,8 +994,11 @@ void View::AdjustSlurPosition(Slur *slur, ArrayOfLayerElementPointPairs *spannin
     ArrayOfLayerElementPointPairs::iterator itPoint;
     int y;
 
-    for (itPoint = spanningPoints->begin(); itPoint != spanningPoints->end();) {
-        y = View::CalcBezierAtPosition(bezier, itPoint->second.x);
+    std::vector<int> curveYs;
+    View::CalcSpanningPointsOnCurve(bezier, spanningPoints, &curveYs);
+    std::vector<int>::iterator itCurveY = curveYs.begin();
+    for (itPoint = spanningPoints->begin(); itPoint != spanningPoints->end(); itCurveY++) {
+        y = (*itCurveY);
 
         // Weight the desired height according to the x position on the other side
         posXRatio = 1.0;
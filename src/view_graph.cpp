@@ -170,10 +170,13 @@ void View::DrawLyricString(DeviceContext *dc, int x, int y, std::wstring s, int
 {
     assert(dc);
 
+    // The bounding box device context only uses the wide string
+    bool isBBox = (dc->Is() == BBOX_DEVICE_CONTEXT);
+
     std::wistringstream iss(s);
     std::wstring token;
     while (std::getline(iss, token, L'_')) {
-        dc->DrawText(UTF16to8(token), token);
+        dc->DrawText(isBBox ? "" : UTF16to8(token), token);
         // no _
         if (iss.eof()) break;
 
@@ -182,7 +185,7 @@ void View::DrawLyricString(DeviceContext *dc, int x, int y, std::wstring s, int
         dc->SetFont(&vrvTxt);
         std::wstring str;
         str.push_back(VRV_TEXT_E551);
-        dc->DrawText(UTF16to8(str), str);
+        dc->DrawText(isBBox ? "" : UTF16to8(str), str);
         dc->ResetFont();
     }
 }
@@ -79,6 +79,10 @@ void View::DrawText(DeviceContext *dc, Text *text, int x, int y, bool &setX, boo
     if (text->GetFirstParent(SYL)) {
         DrawLyricString(dc, x, y, text->GetText());
     }
+    else if (dc->Is() == BBOX_DEVICE_CONTEXT) {
+        // The bounding box device context only uses the wide string - no need to convert it
+        dc->DrawText("", text->GetText());
+    }
     else {
         dc->DrawText(UTF16to8(text->GetText()), text->GetText());
     }
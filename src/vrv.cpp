@@ -213,6 +213,9 @@ bool noLog = false;
 
 #ifdef EMSCRIPTEN
 std::vector<std::string> logBuffer;
+#else
+/** The buffer capturing the messages of the thread (if any) */
+thread_local std::vector<std::string> *threadLogBuffer = NULL;
 #endif
 
 void LogElapsedTimeStart()
@@ -244,9 +247,14 @@ void LogDebug(const char *fmt, ...)
 #else
     va_list args;
     va_start(args, fmt);
-    printf("[Debug] ");
-    vprintf(fmt, args);
-    printf("\n");
+    if (threadLogBuffer) {
+        threadLogBuffer->push_back("[Debug] " + StringFormatVariable(fmt, args));
+    }
+    else {
+        printf("[Debug] ");
+        vprintf(fmt, args);
+        printf("\n");
+    }
     va_end(args);
 #endif
 #endif
@@ -265,9 +273,14 @@ void LogError(const char *fmt, ...)
 #else
     va_list args;
     va_start(args, fmt);
-    printf("[Error] ");
-    vprintf(fmt, args);
-    printf("\n");
+    if (threadLogBuffer) {
+        threadLogBuffer->push_back("[Error] " + StringFormatVariable(fmt, args));
+    }
+    else {
+        printf("[Error] ");
+        vprintf(fmt, args);
+        printf("\n");
+    }
     va_end(args);
 #endif
 }
@@ -285,9 +298,14 @@ void LogMessage(const char *fmt, ...)
 #else
     va_list args;
     va_start(args, fmt);
-    printf("[Message] ");
-    vprintf(fmt, args);
-    printf("\n");
+    if (threadLogBuffer) {
+        threadLogBuffer->push_back("[Message] " + StringFormatVariable(fmt, args));
+    }
+    else {
+        printf("[Message] ");
+        vprintf(fmt, args);
+        printf("\n");
+    }
     va_end(args);
 #endif
 }
@@ -305,9 +323,14 @@ void LogWarning(const char *fmt, ...)
 #else
     va_list args;
     va_start(args, fmt);
-    printf("[Warning] ");
-    vprintf(fmt, args);
-    printf("\n");
+    if (threadLogBuffer) {
+        threadLogBuffer->push_back("[Warning] " + StringFormatVariable(fmt, args));
+    }
+    else {
+        printf("[Warning] ");
+        vprintf(fmt, args);
+        printf("\n");
+    }
     va_end(args);
 #endif
 }
@@ -317,6 +340,25 @@ void DisableLog()
     noLog = true;
 }
 
+void SetThreadLogBuffer(std::vector<std::string> *buffer)
+{
+#ifndef EMSCRIPTEN
+    threadLogBuffer = buffer;
+#endif
+}
+
+void PrintLogBuffer(const std::vector<std::string> &buffer)
+{
+    std::vector<std::string>::const_iterator iter;
+    for (iter = buffer.begin(); iter != buffer.end(); ++iter) {
+#ifdef EMSCRIPTEN
+        AppendLogBuffer(true, *iter + "\n");
+#else
+        printf("%s\n", iter->c_str());
+#endif
+    }
+}
+
 #ifdef EMSCRIPTEN
 bool LogBufferContains(std::string s)
 {
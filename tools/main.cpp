@@ -8,6 +8,7 @@
 #include <assert.h>
 #include <cstdlib>
 #include <ctime>
+#include <fstream>
 #include <getopt.h>
 #include <iostream>
 #include <sstream>
@@ -87,7 +88,7 @@ void display_usage()
 
     cerr << " -s, --scale=FACTOR         Scale percent (default is " << DEFAULT_SCALE << ")" << endl;
 
-    cerr << " -t, --type=OUTPUT_TYPE     Select output format: mei, svg, or midi (default is svg)" << endl;
+    cerr << " -t, --type=OUTPUT_TYPE     Select output format: mei, svg, png, pdf, or midi (default is svg)" << endl;
 
     cerr << " -v, --version              Display the version number" << endl;
 
@@ -116,12 +117,28 @@ void display_usage()
 
     cerr << " --page=PAGE                Select the page to engrave (default is 1)" << endl;
 
+    cerr << " --pae-batch                Render each @start...@end record of a Plain and Easie input" << endl;
+    cerr << "                            to SVG with one output file per record" << endl;
+
+    cerr << " --import-threads=N         Build the objects with N threads when loading (0 for one per core)" << endl;
+
+    cerr << " --mdiv=MDIV                Select the <mdiv> to load by its @n or its @xml:id" << endl;
+
+    cerr << " --measure-range=RANGE      Load only the measures with @n from start to end," << endl;
+    cerr << "                            for example: \"1-8\"" << endl;
+
+    cerr << " --measure-range-by-index   Use the position of the measures instead of @n for --measure-range" << endl;
+
+    cerr << " --staves=STAVES            Load only the staves with the @n given, for example: \"1,3\"" << endl;
+
     cerr << " --app-xpath-query=QUERY    Set the xPath query for selecting <app> child elements," << endl;
     cerr << "                            for example: \"./rdg[contains(@source, 'source-id')]\"" << endl;
 
     cerr << " --spacing-linear=SP        Specify the linear spacing factor (default is " << DEFAULT_SPACING_LINEAR
          << ")" << endl;
 
+    cerr << " --png-grayscale            Render the PNG in grayscale on a white background" << endl;
+
     cerr << " --spacing-non-linear=SP    Specify the non-linear spacing factor (default is "
          << DEFAULT_SPACING_NON_LINEAR << ")" << endl;
 
@@ -129,6 +146,14 @@ void display_usage()
 
     cerr << " --spacing-system=SP        Specify the spacing above each system (in MEI vu)" << endl;
 
+    cerr << " --svg-compact              Write the SVG without indentation and with the glyphs" << endl;
+    cerr << "                            defined once for each size" << endl;
+
+    cerr << " --svg-glyph-sprite         Write the glyphs of all the pages once to a separate file" << endl;
+    cerr << "                            referenced by the SVG pages" << endl;
+
+    cerr << " --svg-remove-ids           Omit the ids of the elements in the SVG" << endl;
+
     // Debugging options
     cerr << endl << "Debugging options" << endl;
 
@@ -154,13 +179,19 @@ int main(int argc, char **argv)
     int no_mei_hdr = 0;
     int adjust_page_height = 0;
     int all_pages = 0;
+    int pae_batch = 0;
     int no_layout = 0;
     int ignore_layout = 0;
     int no_justification = 0;
     int even_note_spacing = 0;
     int show_bounding_boxes = 0;
+    int svg_compact = 0;
+    int svg_remove_ids = 0;
+    int svg_glyph_sprite = 0;
+    int png_grayscale = 0;
     int page = 1;
     int show_help = 0;
+    int measure_range_by_index = 0;
     int show_version = 0;
 
     // Create the toolkit instance without loading the font because
@@ -185,11 +216,17 @@ int main(int argc, char **argv)
         { "ignore-layout", no_argument, &ignore_layout, 1 }, { "no-layout", no_argument, &no_layout, 1 },
         { "no-mei-hdr", no_argument, &no_mei_hdr, 1 }, { "no-justification", no_argument, &no_justification, 1 },
         { "outfile", required_argument, 0, 'o' }, { "page", required_argument, 0, 0 },
+        { "pae-batch", no_argument, &pae_batch, 1 }, { "png-grayscale", no_argument, &png_grayscale, 1 },
         { "page-height", required_argument, 0, 'h' }, { "page-width", required_argument, 0, 'w' },
-        { "app-xpath-query", required_argument, 0, 0 }, { "resources", required_argument, 0, 'r' },
+        { "app-xpath-query", required_argument, 0, 0 }, { "import-threads", required_argument, 0, 0 },
+        { "mdiv", required_argument, 0, 0 }, { "measure-range", required_argument, 0, 0 },
+        { "measure-range-by-index", no_argument, &measure_range_by_index, 1 },
+        { "resources", required_argument, 0, 'r' }, { "staves", required_argument, 0, 0 },
         { "scale", required_argument, 0, 's' }, { "show-bounding-boxes", no_argument, &show_bounding_boxes, 1 },
         { "spacing-linear", required_argument, 0, 0 }, { "spacing-non-linear", required_argument, 0, 0 },
         { "spacing-staff", required_argument, 0, 0 }, { "spacing-system", required_argument, 0, 0 },
+        { "svg-compact", no_argument, &svg_compact, 1 }, { "svg-remove-ids", no_argument, &svg_remove_ids, 1 },
+        { "svg-glyph-sprite", no_argument, &svg_glyph_sprite, 1 },
         { "type", required_argument, 0, 't' }, { "version", no_argument, &show_version, 1 }, { 0, 0, 0, 0 } };
 
     int option_index = 0;
@@ -207,6 +244,18 @@ int main(int argc, char **argv)
                     cout << string(optarg) << endl;
                     toolkit.SetAppXPathQuery(string(optarg));
                 }
+                else if (strcmp(long_options[option_index].name, "import-threads") == 0) {
+                    toolkit.SetImportThreads(atoi(optarg));
+                }
+                else if (strcmp(long_options[option_index].name, "mdiv") == 0) {
+                    toolkit.SetMdiv(string(optarg));
+                }
+                else if (strcmp(long_options[option_index].name, "measure-range") == 0) {
+                    toolkit.SetMeasureRange(string(optarg));
+                }
+                else if (strcmp(long_options[option_index].name, "staves") == 0) {
+                    toolkit.SetStaves(string(optarg));
+                }
                 else if (strcmp(long_options[option_index].name, "spacing-linear") == 0) {
                     if (!toolkit.SetSpacingLinear(atof(optarg))) {
                         exit(1);
@@ -293,6 +342,10 @@ int main(int argc, char **argv)
     toolkit.SetNoJustification(no_justification);
     toolkit.SetEvenNoteSpacing(even_note_spacing);
     toolkit.SetShowBoundingBoxes(show_bounding_boxes);
+    toolkit.SetSvgCompact(svg_compact);
+    toolkit.SetSvgRemoveIds(svg_remove_ids);
+    toolkit.SetPngGrayscale(png_grayscale);
+    toolkit.SetMeasureRangeByIndex(measure_range_by_index);
 
     if (optind <= argc - 1) {
         infile = string(argv[optind]);
@@ -323,8 +376,8 @@ int main(int argc, char **argv)
         exit(1);
     }
 
-    if (outformat != "svg" && outformat != "mei" && outformat != "midi") {
-        cerr << "Output format can only be 'mei', 'svg', or 'midi'." << endl;
+    if (outformat != "svg" && outformat != "png" && outformat != "pdf" && outformat != "mei" && outformat != "midi") {
+        cerr << "Output format can only be 'mei', 'svg', 'png', 'pdf', or 'midi'." << endl;
         exit(1);
     }
 
@@ -346,6 +399,48 @@ int main(int argc, char **argv)
         outfile = removeExtension(outfile);
     }
 
+    // Render the incipits of a batch one by one
+    if (pae_batch) {
+        if (outformat != "svg") {
+            cerr << "A Plain and Easie batch can only be rendered to SVG." << endl;
+            exit(1);
+        }
+        ifstream batch_file;
+        if (infile != "-") {
+            batch_file.open(infile.c_str());
+            if (!batch_file.is_open()) {
+                cerr << "The file '" << infile << "' could not be opened." << endl;
+                exit(1);
+            }
+        }
+        istream &batch_input = (infile == "-") ? cin : batch_file;
+        int count = 0;
+        // By chunks for the SVG of the whole batch not to be kept in memory
+        for (;;) {
+            std::vector<std::string> svgs = toolkit.RenderPaeBatchToSvg(batch_input, 256);
+            if (svgs.empty()) break;
+            std::vector<std::string>::iterator iter;
+            for (iter = svgs.begin(); iter != svgs.end(); iter++) {
+                count++;
+                if (std_output) {
+                    cout << *iter << endl;
+                    continue;
+                }
+                std::string cur_outfile = outfile + StringFormat("_%05d.svg", count);
+                ofstream svg_file(cur_outfile.c_str());
+                if (!svg_file.is_open()) {
+                    cerr << "Unable to write SVG to " << cur_outfile << "." << endl;
+                    exit(1);
+                }
+                svg_file << *iter;
+            }
+        }
+        if (!std_output) {
+            cerr << "Output of " << count << " incipits written to " << outfile << "_*.svg." << endl;
+        }
+        return 0;
+    }
+
     // Load the std input or load the file
     if (infile == "-") {
         stringstream data_stream;
@@ -382,6 +477,14 @@ int main(int argc, char **argv)
     }
 
     if (outformat == "svg") {
+        // the pages reference the glyph sprite written with them
+        std::string sprite_outfile = outfile + "_glyphs.svg";
+        if (svg_glyph_sprite) {
+            toolkit.SetSvgGlyphSprite(true);
+            if (!std_output) {
+                toolkit.SetSvgGlyphHref(basename(sprite_outfile));
+            }
+        }
         int p;
         for (p = from; p < to; p++) {
             std::string cur_outfile = outfile;
@@ -400,6 +503,56 @@ int main(int argc, char **argv)
                 cerr << "Output written to " << cur_outfile << "." << endl;
             }
         }
+        if (svg_glyph_sprite) {
+            if (std_output) {
+                cout << toolkit.RenderGlyphSprite();
+            }
+            else {
+                ofstream sprite_file(sprite_outfile.c_str());
+                if (!sprite_file.is_open()) {
+                    cerr << "Unable to write the glyph sprite to " << sprite_outfile << "." << endl;
+                    exit(1);
+                }
+                sprite_file << toolkit.RenderGlyphSprite();
+                sprite_file.close();
+                cerr << "Glyph sprite written to " << sprite_outfile << "." << endl;
+            }
+        }
+    }
+    else if (outformat == "png") {
+        int p;
+        for (p = from; p < to; p++) {
+            std::string cur_outfile = outfile;
+            if (all_pages) {
+                cur_outfile += StringFormat("_%03d", p);
+            }
+            cur_outfile += ".png";
+            if (std_output) {
+                cout << toolkit.RenderToPng(p);
+            }
+            else if (!toolkit.RenderToPngFile(cur_outfile, p)) {
+                cerr << "Unable to write PNG to " << cur_outfile << "." << endl;
+                exit(1);
+            }
+            else {
+                cerr << "Output written to " << cur_outfile << "." << endl;
+            }
+        }
+    }
+    else if (outformat == "pdf") {
+        // all the pages are written to a single document
+        int pdf_page = (all_pages) ? 0 : page;
+        outfile += ".pdf";
+        if (std_output) {
+            cout << toolkit.RenderToPdf(pdf_page);
+        }
+        else if (!toolkit.RenderToPdfFile(outfile, pdf_page)) {
+            cerr << "Unable to write PDF to " << outfile << "." << endl;
+            exit(1);
+        }
+        else {
+            cerr << "Output written to " << outfile << "." << endl;
+        }
     }
     else if (outformat == "midi") {
         outfile += ".mid";